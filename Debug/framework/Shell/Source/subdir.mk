@@ -7,19 +7,22 @@ C_SRCS += \
 ../framework/Shell/Source/shell.c \
 ../framework/Shell/Source/shell_autocomplete.c \
 ../framework/Shell/Source/shell_cmdhelp.c \
-../framework/Shell/Source/shell_cmdhist.c 
+../framework/Shell/Source/shell_cmdhist.c \
+../framework/Shell/Source/shell_rpc.c 
 
 OBJS += \
 ./framework/Shell/Source/shell.o \
 ./framework/Shell/Source/shell_autocomplete.o \
 ./framework/Shell/Source/shell_cmdhelp.o \
-./framework/Shell/Source/shell_cmdhist.o 
+./framework/Shell/Source/shell_cmdhist.o \
+./framework/Shell/Source/shell_rpc.o 
 
 C_DEPS += \
 ./framework/Shell/Source/shell.d \
 ./framework/Shell/Source/shell_autocomplete.d \
 ./framework/Shell/Source/shell_cmdhelp.d \
-./framework/Shell/Source/shell_cmdhist.d 
+./framework/Shell/Source/shell_cmdhist.d \
+./framework/Shell/Source/shell_rpc.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
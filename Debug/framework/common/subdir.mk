@@ -4,13 +4,19 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
-../framework/common/FwkInit.c 
+../framework/common/FwkInit.c \
+../framework/common/cobs.c \
+../framework/common/crc16.c 
 
 OBJS += \
-./framework/common/FwkInit.o 
+./framework/common/FwkInit.o \
+./framework/common/cobs.o \
+./framework/common/crc16.o 
 
 C_DEPS += \
-./framework/common/FwkInit.d 
+./framework/common/FwkInit.d \
+./framework/common/cobs.d \
+./framework/common/crc16.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
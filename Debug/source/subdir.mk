@@ -4,31 +4,58 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../source/ad_iterator.c \
 ../source/app_config.c \
 ../source/ble_shell.c \
+../source/crypto_aes.c \
+../source/hidro_dedup.c \
+../source/hidro_keycache.c \
+../source/hidro_readings.c \
+../source/hidro_record.c \
+../source/hidro_table.c \
 ../source/semihost_hardfault.c \
 ../source/shell_gap.c \
 ../source/shell_gatt.c \
 ../source/shell_gattdb.c \
-../source/shell_thrput.c 
+../source/shell_mem.c \
+../source/shell_thrput.c \
+../source/shell_tmr.c 
 
 OBJS += \
+./source/ad_iterator.o \
 ./source/app_config.o \
 ./source/ble_shell.o \
+./source/crypto_aes.o \
+./source/hidro_dedup.o \
+./source/hidro_keycache.o \
+./source/hidro_readings.o \
+./source/hidro_record.o \
+./source/hidro_table.o \
 ./source/semihost_hardfault.o \
 ./source/shell_gap.o \
 ./source/shell_gatt.o \
 ./source/shell_gattdb.o \
-./source/shell_thrput.o 
+./source/shell_mem.o \
+./source/shell_thrput.o \
+./source/shell_tmr.o 
 
 C_DEPS += \
+./source/ad_iterator.d \
 ./source/app_config.d \
 ./source/ble_shell.d \
+./source/crypto_aes.d \
+./source/hidro_dedup.d \
+./source/hidro_keycache.d \
+./source/hidro_readings.d \
+./source/hidro_record.d \
+./source/hidro_table.d \
 ./source/semihost_hardfault.d \
 ./source/shell_gap.d \
 ./source/shell_gatt.d \
 ./source/shell_gattdb.d \
-./source/shell_thrput.d 
+./source/shell_mem.d \
+./source/shell_thrput.d \
+./source/shell_tmr.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -21,6 +21,7 @@
 #include "NVM_Interface.h"
 #endif
 #include "Panic.h"
+#include "crc16.h"
 /*****************************************************************************
  *****************************************************************************
  * Private macros
@@ -34,8 +35,6 @@
 #define mProgBuffSizeInPgmWrUnits_c  4
 #endif
 
-/* Generator for CRC calculations. */
-#define POLGEN  0x1021
 /*! *********************************************************************************
 *************************************************************************************
 * Private type definitions
@@ -210,28 +209,13 @@ static uint8_t NV_VerifyCrcOverHWParameters(hardwareParameters_t* pHwParams)
 static uint16_t NV_ComputeCrcOverHWParameters(hardwareParameters_t* pHwParams)
 {
     uint16_t  computedCRC = 0;
-    uint8_t crcA;
-    uint8_t byte = 0;
     if(NULL != pHwParams)
     {
         uint8_t *ptr = (uint8_t *)(&pHwParams->reserved);
         uint16_t len = (uint8_t *)(&pHwParams->hardwareParamsCrc) -
                            (uint8_t *)(&pHwParams->reserved);
-        while(len)
-        {
-            byte = *ptr;
-            computedCRC ^= ((uint16_t)byte << 8);
-            for(crcA = 8; crcA; crcA--)
-            {
-                if(computedCRC & 0x8000) {
-                    computedCRC <<= 1;
-                    computedCRC ^= POLGEN;
-                }
-                else computedCRC <<= 1;
-            }
-            --len;
-            ++ptr;
-        }
+        /* CRC-16, polynomial 0x1021, initial value 0 */
+        computedCRC = crc16_update(CRC16_INIT_XMODEM, ptr, len);
     }
     return computedCRC;
 }
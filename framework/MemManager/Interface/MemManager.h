@@ -56,6 +56,54 @@
 #define MEM_CheckMemBufferInterval_c      15000 /* ms */
 #endif
 
+/* Largest request size resolved in constant time through the pool lookup table.
+   Larger requests search the pools. */
+#ifndef gMemPoolLookupMaxSize_c
+#define gMemPoolLookupMaxSize_c           512
+#endif
+
+/* Number of pool IDs (0 to gMemPoolLookupIds_c - 1) resolved through the pool
+   lookup table. Other pool IDs search the pools. */
+#ifndef gMemPoolLookupIds_c
+#define gMemPoolLookupIds_c               1
+#endif
+
+/* Enables reference counted buffers (MEM_BufferRetain). Adds a reference
+   counter to the header of every block. */
+#ifndef gMemBufferRefCount_d
+#define gMemBufferRefCount_d              0
+#endif
+
+/* Enables lock-free pool free lists. MEM_BufferAllocWithId() and MEM_BufferFree()
+   use compare-and-swap (LDREX/STREX) instead of disabling interrupts, so they can
+   be called from interrupts without adding to the interrupt latency.
+   MEM_STATISTICS is updated with atomics too, but MEM_TRACKING and MEM_TRACE
+   disable interrupts on every allocation and free while recording, so the
+   latency gain is lost when either of them is defined. */
+#ifndef gMemLockFreePools_d
+#define gMemLockFreePools_d               0
+#endif
+
+#ifdef MEM_STATISTICS
+/* Number of bins of the requested size histogram of each pool. Bin i counts the
+   allocations of more than i/MEM_SIZE_HISTOGRAM_BINS of the block size, up to
+   (i+1)/MEM_SIZE_HISTOGRAM_BINS. */
+#ifndef MEM_SIZE_HISTOGRAM_BINS
+#define MEM_SIZE_HISTOGRAM_BINS           8
+#endif
+#endif /*MEM_STATISTICS*/
+
+#ifdef MEM_TRACE
+/* Number of alloc/free events kept by the allocation trace. When the trace is
+   full the oldest event is overwritten and counted as lost. */
+#ifndef MEM_TRACE_SIZE
+#define MEM_TRACE_SIZE                    128
+#endif
+
+/* Pool index recorded for allocations that failed */
+#define MEM_TRACE_NO_POOL_c               0xFF
+#endif /*MEM_TRACE*/
+
 /* Default memory allocator */
 #ifndef MEM_BufferAlloc
 #define MEM_BufferAlloc(numBytes)   MEM_BufferAllocWithId(numBytes, 0, (void*)__get_LR())
@@ -81,6 +129,7 @@ typedef enum
 }memStatus_t;
 
 
+
 /*! *********************************************************************************
 *************************************************************************************
 * Public prototypes
@@ -90,12 +139,20 @@ typedef enum
 memStatus_t MEM_Init(void);
 /*Returns the number of available blocks that fit the given size.*/
 uint32_t MEM_GetAvailableBlocks(uint32_t size);
-/*Frees the givem buffer.*/
+/*Frees the givem buffer. With gMemBufferRefCount_d, drops one reference to it.*/
 memStatus_t MEM_BufferFree(void* buffer);
 /*Returns the allocated buffer of the given size.*/
 void* MEM_BufferAllocWithId(uint32_t numBytes , uint8_t  poolId, void *pCaller);
 /*Returns the size of a given buffer*/
 uint16_t MEM_BufferGetSize(void* buffer);
+#if gMemBufferRefCount_d
+/*Adds a reference to an allocated buffer*/
+memStatus_t MEM_BufferRetain(void* buffer);
+/*Returns the number of references to a buffer*/
+uint16_t MEM_BufferGetRefCount(void* buffer);
+/*Drops one reference to a buffer. Can be used as a Tx/Rx completion callback.*/
+void MEM_BufferReleaseCallback(void* buffer);
+#endif
 /*Performs a write-read-verify test accross all pools*/
 uint32_t MEM_WriteReadTest(void);
 #if (defined MULTICORE_MEM_MANAGER) && ((defined MULTICORE_HOST) || (defined MULTICORE_BLACKBOX))
@@ -133,6 +190,10 @@ typedef struct poolStat_tag
   uint16_t allocatedBlocksPeak;
   uint16_t allocationFailures;
   uint16_t freeFailures;
+  uint16_t wasteMax;                /*Largest block size - requested size*/
+  uint32_t allocations;             /*Allocations served by the pool*/
+  uint32_t wasteSum;                /*Sum of block size - requested size*/
+  uint16_t sizeHistogram[MEM_SIZE_HISTOGRAM_BINS]; /*Requested sizes, in fractions of the block size*/
 #ifdef MEM_TRACKING
   uint16_t poolFragmentWaste;
   uint16_t poolFragmentWastePeak;
@@ -168,17 +229,46 @@ typedef PACKED_STRUCT BlockTracking_tag
 }blockTracking_t;
 #endif /*MEM_TRACKING*/
 
+#ifdef MEM_TRACE
+/*Operations recorded by the allocation trace.*/
+typedef enum
+{
+  MEM_TRACE_ALLOC_c = 0,
+  MEM_TRACE_FREE_c,
+  MEM_TRACE_ALLOC_FAIL_c
+}memTraceOp_t;
+
+/*Allocation trace entry.*/
+typedef struct memTraceEntry_tag
+{
+  uint32_t timeStamp;               /*MEM_GetTimeStamp() at the time of the event*/
+  uint32_t caller;                  /*Return address of the alloc/free call*/
+  uint16_t requestedSize;           /*Size requested by allocator. 0 for free.*/
+  uint16_t blockId;                 /*Offset of the block in the heap, in words*/
+  uint8_t  poolIdx;                 /*Pool that served the event, or MEM_TRACE_NO_POOL_c*/
+  uint8_t  op;                      /*memTraceOp_t*/
+  uint8_t  padding[2];
+}memTraceEntry_t;
+#endif /*MEM_TRACE*/
+
 /*Header description for buffers.*/
 typedef struct listHeader_tag
 {
   listElement_t link;
   struct pools_tag *pParentPool;
+#if gMemBufferRefCount_d
+  uint16_t refCount;                /*Number of references to an allocated block*/
+  uint8_t  padding[2];
+#endif
 }listHeader_t;
 
 /*Buffer pools. Used by most functions*/
 typedef struct pools_tag
 {
   list_t anchor; /* MUST be first element in pools_t struct */
+#if gMemLockFreePools_d
+  uint32_t freeTop; /* Top of the free blocks stack, see MemManager.c */
+#endif
   uint16_t nextBlockSize;
   uint16_t blockSize;
   uint16_t  poolId;
@@ -204,19 +294,35 @@ typedef struct poolInfo_tag
 *************************************************************************************
 ********************************************************************************** */
 
+uint8_t MEM_GetPoolCount(void);
+const pools_t* MEM_GetPool(uint8_t poolIdx);
+
+#ifdef MEM_STATISTICS
+bool_t MEM_GetPoolStatistics(uint8_t poolIdx, poolStat_t *pStatistics);
+uint16_t MEM_GetFreeBlocksMin(void);
+void MEM_ResetStatistics(void);
+#endif
+
+#ifdef MEM_TRACE
+void MEM_TraceEnable(bool_t enable);
+uint16_t MEM_TraceRead(memTraceEntry_t *pEntries, uint16_t maxEntries);
+uint32_t MEM_TraceGetLost(void);
+void MEM_TraceReset(void);
+#endif /*MEM_TRACE*/
+
 #ifdef MEM_TRACKING
 uint8_t MEM_Track(listHeader_t *block, memTrackingStatus_t alloc, uint32_t address, uint16_t requestedSize, void *pCaller);
 uint8_t MEM_BufferCheck(uint8_t *p, uint32_t size);
 void MEM_CheckIfMemBuffersAreFreed(void);
+#endif /*MEM_TRACKING*/
 
+#if defined(MEM_TRACKING) || defined(MEM_TRACE)
 /* The timestamp function used by MEM Manager for debug purpose.
-   The timestamp must be in milliseconds! */
-#if defined(__IAR_SYSTEMS_ICC__)
-extern __weak uint32_t MEM_GetTimeStamp(void);
-#elif defined(__GNUC__)
-extern __attribute__((weak)) uint32_t MEM_GetTimeStamp(void);
-#endif
+   The timestamp must be in milliseconds! The MEM Manager provides a weak
+   definition; it is not declared weak here, so that the application can
+   override it in a file that includes this header. */
+uint32_t MEM_GetTimeStamp(void);
 
-#endif /*MEM_TRACKING*/
+#endif /*MEM_TRACKING || MEM_TRACE*/
 
 #endif /* _MEM_MANAGER_H_ */
@@ -56,6 +56,11 @@ poolInfo_t poolInfo[] =
 uint32_t memHeap[heapSize_c/sizeof(uint32_t)];
 const uint32_t heapSize = heapSize_c;
 
+#if gMemLockFreePools_d
+/* The top of a free blocks stack holds the heap offset of a block in 16 bits */
+typedef char mMemHeapSizeCheck_t[((heapSize_c / sizeof(uint32_t)) < 0xFFFF) ? 1 : -1];
+#endif
+
 #undef _block_size_
 #undef _number_of_blocks_
 #undef _eol_
@@ -74,6 +79,62 @@ pools_t memPools[poolCount];
 pools_t  memPoolsSnapShot[poolCount];
 #endif
 
+#define mMemPoolCount_c         NumberOfElements(memPools)
+#define mMemNoPool_c            0xFF
+#define mMemLookupBucket_m(size) (((size) + 3) >> 2)
+/* Histogram bin of a non zero requested size */
+#define mMemSizeBin_m(size, blockSize) ((((uint32_t)(size) * MEM_SIZE_HISTOGRAM_BINS) - 1) / (blockSize))
+
+#if gMemLockFreePools_d
+#if !defined(__GNUC__)
+#error "gMemLockFreePools_d requires the GCC __atomic builtins"
+#endif
+
+/* Each pool keeps its free blocks in a stack linked through link.next. The top
+   (pools_t.freeTop) holds the word offset of the top block header in the heap,
+   plus 1, in its lower half (0 when the stack is empty) and a tag in its upper
+   half. The tag changes with every push and pop, so a pop that was preempted
+   while other contexts popped and pushed back the same block (ABA) fails its
+   compare-and-swap and retries. A free block has link.list set to its pool
+   anchor and an allocated block has it NULL, as with the locked lists. */
+#define mMemTopBlock_m(top)       ((listHeader_t *)(memHeap + ((top) & 0xFFFF) - 1))
+#define mMemTopMake_m(top, pBlock) ((((top) + 0x10000) & 0xFFFF0000) | \
+                                   ((pBlock) ? (uint32_t)((uint32_t *)(pBlock) - memHeap) + 1 : 0))
+
+#define mMemLock_m()
+#define mMemUnlock_m()
+#if defined(MEM_TRACKING) || defined(MEM_TRACE)
+#define mMemDebugLock_m()         OSA_InterruptDisable()
+#define mMemDebugUnlock_m()       OSA_InterruptEnable()
+#else
+#define mMemDebugLock_m()
+#define mMemDebugUnlock_m()
+#endif
+#define mMemAtomicInc_m(x)        __atomic_add_fetch(&(x), 1, __ATOMIC_RELAXED)
+#define mMemAtomicDec_m(x)        __atomic_sub_fetch(&(x), 1, __ATOMIC_RELAXED)
+#define mMemAtomicAdd_m(x, value) __atomic_add_fetch(&(x), (value), __ATOMIC_RELAXED)
+#define mMemUpdateMax_m(x, value) MEM_UpdateMax16(&(x), (value))
+#define mMemUpdateMin_m(x, value) MEM_UpdateMin16(&(x), (value))
+#else
+#define mMemLock_m()              OSA_InterruptDisable()
+#define mMemUnlock_m()            OSA_InterruptEnable()
+#define mMemDebugLock_m()
+#define mMemDebugUnlock_m()
+#define mMemAtomicInc_m(x)        (++(x))
+#define mMemAtomicDec_m(x)        (--(x))
+#define mMemAtomicAdd_m(x, value) ((x) += (value))
+#define mMemUpdateMax_m(x, value) if( (value) > (x) ) { (x) = (value); }
+#define mMemUpdateMin_m(x, value) if( (value) < (x) ) { (x) = (value); }
+#endif /* gMemLockFreePools_d */
+
+/* Index of the first pool with the given ID and a block size of at least
+   4 * bucket bytes, or mMemNoPool_c. Built by MEM_Init(). */
+static uint8_t mMemPoolLookup[gMemPoolLookupIds_c][mMemLookupBucket_m(gMemPoolLookupMaxSize_c) + 1];
+
+/* Index of the next pool used when a pool is empty: the first following pool
+   with the same ID and a larger or equal block size, or mMemNoPool_c. */
+static uint8_t mMemPoolNext[mMemPoolCount_c];
+
 #undef _block_size_
 #undef _number_of_blocks_
 #undef _eol_
@@ -101,6 +162,15 @@ blockTracking_t memTrack[mTotalNoOfMsgs_d];
 
 #endif /*MEM_TRACKING*/
 
+#ifdef MEM_TRACE
+/* Allocation trace. mMemTraceTail is the oldest entry. */
+static memTraceEntry_t mMemTrace[MEM_TRACE_SIZE];
+static uint16_t mMemTraceTail;
+static uint16_t mMemTraceCount;
+static uint32_t mMemTraceLost;
+static bool_t   mMemTraceEnabled = TRUE;
+#endif /*MEM_TRACE*/
+
 /* Free messages counter. Not used by module. */
 uint16_t gFreeMessagesCount;
 #ifdef MEM_STATISTICS
@@ -109,6 +179,26 @@ uint16_t gTotalFragmentWaste = 0;
 uint16_t gMaxTotalFragmentWaste = 0;
 #endif
 
+/*! *********************************************************************************
+*************************************************************************************
+* Private functions prototypes
+*************************************************************************************
+********************************************************************************** */
+static uint8_t MEM_FindPool(uint32_t numBytes, uint8_t poolId, uint8_t startIdx);
+static void MEM_InitPoolLookup(void);
+static listHeader_t* MEM_PoolPop(pools_t *pPool);
+static void MEM_PoolPush(pools_t *pPool, listHeader_t *pBlock);
+#if gMemLockFreePools_d && defined(MEM_STATISTICS)
+static void MEM_UpdateMax16(uint16_t *pMax, uint16_t value);
+static void MEM_UpdateMin16(uint16_t *pMin, uint16_t value);
+#endif
+#if gMemBufferRefCount_d
+static listHeader_t* MEM_GetValidHeader(void *buffer);
+#endif
+#ifdef MEM_TRACE
+static void MEM_TraceRecord(memTraceOp_t op, uint16_t requestedSize, uint8_t poolIdx, listHeader_t *pHeader, uint32_t caller);
+#endif /*MEM_TRACE*/
+
 /*! *********************************************************************************
 *************************************************************************************
 * Public functions
@@ -147,6 +237,10 @@ memStatus_t MEM_Init(void)
     pPools->poolStatistics.allocatedBlocksPeak = 0;
     pPools->poolStatistics.allocationFailures = 0;
     pPools->poolStatistics.freeFailures = 0;
+    pPools->poolStatistics.wasteMax = 0;
+    pPools->poolStatistics.allocations = 0;
+    pPools->poolStatistics.wasteSum = 0;
+    FLib_MemSet(pPools->poolStatistics.sizeHistogram, 0, sizeof(pPools->poolStatistics.sizeHistogram));
 #ifdef MEM_TRACKING
     pPools->poolStatistics.poolFragmentWaste = 0;
     pPools->poolStatistics.poolFragmentWastePeak = 0;
@@ -183,6 +277,10 @@ memStatus_t MEM_Init(void)
       poolN--;
     }
 
+#if gMemLockFreePools_d
+    /* The free blocks stay linked in heap order, the first one on top */
+    pPools->freeTop = mMemTopMake_m(0, (listHeader_t *)pPools->anchor.head);
+#endif
     pPools->blockSize = pPoolInfo->blockSize;
     pPools->poolId = pPoolInfo->poolId;
     pPools->nextBlockSize = (pPoolInfo+1)->blockSize;
@@ -195,6 +293,8 @@ memStatus_t MEM_Init(void)
     pPoolInfo++;
   }
 
+  MEM_InitPoolLookup();
+
   return MEM_SUCCESS_c;
 }
 
@@ -221,7 +321,11 @@ uint32_t size
     {
         if(size <= pPools->blockSize)
         {
+#if gMemLockFreePools_d
+            pTotalCount += pPools->numBlocks - pPools->allocatedBlocks;
+#else
             pTotalCount += ListGetSize((listHandle_t)&pPools->anchor);
+#endif
         }
 
         if(pPools->nextBlockSize == 0)
@@ -265,82 +369,102 @@ uint8_t  poolId,
 void *pCaller
 )
 {
-#ifdef MEM_TRACKING
+#if defined(MEM_TRACKING) || defined(MEM_TRACE)
     /* Save the Link Register */
     volatile uint32_t savedLR = (uint32_t) __get_LR();
 #endif
-#if defined(MEM_TRACKING) || defined(MEM_DEBUG_OUT_OF_MEMORY)
+#if defined(MEM_TRACKING) || defined(MEM_TRACE) || defined(MEM_DEBUG_OUT_OF_MEMORY) || defined(MEM_STATISTICS)
     uint16_t requestedSize = numBytes;
 #endif /*MEM_TRACKING*/
 #ifdef MEM_STATISTICS
     bool_t allocFailure = FALSE;
+    uint16_t allocatedBlocks;
+    uint16_t freeMessages;
+    uint16_t waste;
 #endif
 
-    pools_t *pPools = memPools;
+    pools_t *pPools;
     listHeader_t *pBlock;
+    uint8_t poolIdx = mMemNoPool_c;
 
-    OSA_InterruptDisable();
-
-    while(numBytes)
+    /* The pool is selected before entering the critical section */
+    if( numBytes )
     {
-        if( (numBytes <= pPools->blockSize) && (poolId == pPools->poolId) )
+        if( (numBytes <= gMemPoolLookupMaxSize_c) && (poolId < gMemPoolLookupIds_c) )
+        {
+            poolIdx = mMemPoolLookup[poolId][mMemLookupBucket_m(numBytes)];
+        }
+        else
         {
-            pBlock = (listHeader_t *)ListRemoveHead((listHandle_t)&pPools->anchor);
+            poolIdx = MEM_FindPool(numBytes, poolId, 0);
+        }
+    }
 
-            if(NULL != pBlock)
-            {
-                pBlock++;
-                gFreeMessagesCount--;
-                pPools->allocatedBlocks++;
+    mMemLock_m();
 
-#ifdef MEM_STATISTICS
-                if(gFreeMessagesCount < gFreeMessagesCountMin)
-                {
-                    gFreeMessagesCountMin = gFreeMessagesCount;
-                }
+    while(poolIdx != mMemNoPool_c)
+    {
+        pPools = &memPools[poolIdx];
+        pBlock = MEM_PoolPop(pPools);
 
-                pPools->poolStatistics.allocatedBlocks++;
-                if ( pPools->poolStatistics.allocatedBlocks > pPools->poolStatistics.allocatedBlocksPeak )
-                {
-                    pPools->poolStatistics.allocatedBlocksPeak = pPools->poolStatistics.allocatedBlocks;
-                }
-                MEM_ASSERT(pPools->poolStatistics.allocatedBlocks <= pPools->poolStatistics.numBlocks);
+        if(NULL != pBlock)
+        {
+#if gMemBufferRefCount_d
+            pBlock->refCount = 1;
+#endif
+            pBlock++;
+            (void)mMemAtomicInc_m(pPools->allocatedBlocks);
+
+#ifdef MEM_STATISTICS
+            freeMessages = mMemAtomicDec_m(gFreeMessagesCount);
+            mMemUpdateMin_m(gFreeMessagesCountMin, freeMessages);
+
+            allocatedBlocks = mMemAtomicInc_m(pPools->poolStatistics.allocatedBlocks);
+            mMemUpdateMax_m(pPools->poolStatistics.allocatedBlocksPeak, allocatedBlocks);
+            MEM_ASSERT(allocatedBlocks <= pPools->poolStatistics.numBlocks);
+
+            waste = pPools->blockSize - requestedSize;
+            (void)mMemAtomicInc_m(pPools->poolStatistics.allocations);
+            (void)mMemAtomicAdd_m(pPools->poolStatistics.wasteSum, waste);
+            mMemUpdateMax_m(pPools->poolStatistics.wasteMax, waste);
+            (void)mMemAtomicInc_m(pPools->poolStatistics.sizeHistogram[mMemSizeBin_m(requestedSize, pPools->blockSize)]);
+#else
+            (void)mMemAtomicDec_m(gFreeMessagesCount);
 #endif /*MEM_STATISTICS*/
 
+            mMemDebugLock_m();
 #ifdef MEM_TRACKING
-                MEM_Track(pBlock, MEM_TRACKING_ALLOC_c, savedLR, requestedSize, pCaller);
+            MEM_Track(pBlock, MEM_TRACKING_ALLOC_c, savedLR, requestedSize, pCaller);
 #endif /*MEM_TRACKING*/
-                OSA_InterruptEnable();
-                return pBlock;
-            }
-            else
-            {
-#ifdef MEM_STATISTICS
-                if(!allocFailure)
-                {
-                    pPools->poolStatistics.allocationFailures++;
-                    allocFailure = TRUE;
-                }
-#endif /*MEM_STATISTICS*/
-                if(numBytes > pPools->nextBlockSize)
-                {
-                    break;
-                }
-                /* No more blocks of that size, try next size. */
-                numBytes = pPools->nextBlockSize;
-            }
-        }
-        /* Try next pool*/
-        if(pPools->nextBlockSize)
-        {
-            pPools++;
+#ifdef MEM_TRACE
+            MEM_TraceRecord(MEM_TRACE_ALLOC_c, requestedSize, poolIdx, pBlock-1, savedLR);
+#endif /*MEM_TRACE*/
+            mMemDebugUnlock_m();
+            mMemUnlock_m();
+            return pBlock;
         }
-        else
+
+#ifdef MEM_STATISTICS
+        if(!allocFailure)
         {
-            numBytes = 0;
+            (void)mMemAtomicInc_m(pPools->poolStatistics.allocationFailures);
+            allocFailure = TRUE;
         }
+#endif /*MEM_STATISTICS*/
+
+        /* No more blocks of that size, try next size. */
+        poolIdx = mMemPoolNext[poolIdx];
     }
 
+#ifdef MEM_TRACE
+    if (requestedSize)
+    {
+        mMemDebugLock_m();
+        MEM_TraceRecord(MEM_TRACE_ALLOC_FAIL_c, requestedSize, MEM_TRACE_NO_POOL_c, NULL, savedLR);
+        mMemDebugUnlock_m();
+    }
+#endif /*MEM_TRACE*/
+
 #ifdef MEM_DEBUG_OUT_OF_MEMORY
     if (requestedSize)
     {
@@ -348,7 +472,7 @@ void *pCaller
     }
 #endif
 
-    OSA_InterruptEnable();
+    mMemUnlock_m();
     return NULL;
 }
 
@@ -407,13 +531,18 @@ memStatus_t MEM_BufferFree
 void* buffer /* IN: Block of memory to free*/
 )
 {
-#ifdef MEM_TRACKING
+#if defined(MEM_TRACKING) || defined(MEM_TRACE)
     /* Save the Link Register */
     volatile uint32_t savedLR = (uint32_t) __get_LR();
 #endif /*MEM_TRACKING*/
     listHeader_t *pHeader;
     pools_t *pParentPool;
-    pools_t *pool;
+#if gMemLockFreePools_d
+    struct list_tag *pList = NULL;
+#if gMemBufferRefCount_d
+    uint16_t refCount;
+#endif
+#endif
 
     if( buffer == NULL )
     {
@@ -436,61 +565,89 @@ void* buffer /* IN: Block of memory to free*/
 #endif
     }
 
-    OSA_InterruptDisable();
-
     pParentPool = (pools_t *)pHeader->pParentPool;
-    pool = memPools;
 
-    for(;;)
+    if( (pParentPool < memPools) || (pParentPool >= &memPools[mMemPoolCount_c]) ||
+        ((((uint8_t*)pParentPool - (uint8_t*)memPools) % sizeof(pools_t)) != 0) )
     {
-        if (pParentPool == pool)
-        {
-            break;
-        }
-        if(pool->nextBlockSize == 0)
-        {
-            /* The parent pool was not found! This means that the memory buffer is corrupt or
-            that the MEM_BufferFree() function was called with an invalid parameter */
-#ifdef MEM_STATISTICS
-            pParentPool->poolStatistics.freeFailures++;
-#endif /*MEM_STATISTICS*/
-            OSA_InterruptEnable();
+        /* The parent pool was not found! This means that the memory buffer is corrupt or
+        that the MEM_BufferFree() function was called with an invalid parameter */
 #ifdef MEM_DEBUG_INVALID_POINTERS
-            panic( 0, (uint32_t)MEM_BufferFree, 0, 0);
+        panic( 0, (uint32_t)MEM_BufferFree, 0, 0);
 #endif
-            return MEM_FREE_ERROR_c;
+        return MEM_FREE_ERROR_c;
+    }
+
+    mMemLock_m();
+
+#if gMemBufferRefCount_d
+#if gMemLockFreePools_d
+    /* The owner dropping the last reference must see the writes of the others */
+    refCount = __atomic_load_n(&pHeader->refCount, __ATOMIC_ACQUIRE);
+
+    while( refCount > 1 )
+    {
+        if( __atomic_compare_exchange_n(&pHeader->refCount, &refCount, refCount - 1, TRUE, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE) )
+        {
+            /* The buffer is still used by other owners */
+            mMemUnlock_m();
+            return MEM_SUCCESS_c;
         }
-        pool++;
     }
+#else
+    if( pHeader->refCount > 1 )
+    {
+        /* The buffer is still used by other owners */
+        pHeader->refCount--;
+        mMemUnlock_m();
+        return MEM_SUCCESS_c;
+    }
+#endif
+#endif
 
+#if gMemLockFreePools_d
+    /* Marks the block as free. Fails if it is free already or enqueued in a list. */
+    if( !__atomic_compare_exchange_n(&pHeader->link.list, &pList, &pParentPool->anchor, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) )
+#else
     if( pHeader->link.list != NULL )
+#endif
     {
         /* The memory buffer appears to be enqueued in a linked list.
         This list may be the free memory buffers pool, or another list. */
 #ifdef MEM_STATISTICS
-        pParentPool->poolStatistics.freeFailures++;
+        (void)mMemAtomicInc_m(pParentPool->poolStatistics.freeFailures);
 #endif /*MEM_STATISTICS*/
-        OSA_InterruptEnable();
+        mMemUnlock_m();
 #ifdef MEM_DEBUG_INVALID_POINTERS
         panic( 0, (uint32_t)MEM_BufferFree, 0, 0);
 #endif
         return MEM_FREE_ERROR_c;
     }
 
-    gFreeMessagesCount++;
+#if gMemBufferRefCount_d
+    pHeader->refCount = 0;
+#endif
 
-    ListAddTail((listHandle_t)&pParentPool->anchor, (listElementHandle_t)&pHeader->link);
-    pParentPool->allocatedBlocks--;
+    /* The counters are updated before the block can be allocated again */
+    (void)mMemAtomicInc_m(gFreeMessagesCount);
+    (void)mMemAtomicDec_m(pParentPool->allocatedBlocks);
 
 #ifdef MEM_STATISTICS
     MEM_ASSERT(pParentPool->poolStatistics.allocatedBlocks > 0);
-    pParentPool->poolStatistics.allocatedBlocks--;
+    (void)mMemAtomicDec_m(pParentPool->poolStatistics.allocatedBlocks);
 #endif /*MEM_STATISTICS*/
 
+    mMemDebugLock_m();
 #ifdef MEM_TRACKING
     MEM_Track(buffer, MEM_TRACKING_FREE_c, savedLR, 0, NULL);
 #endif /*MEM_TRACKING*/
-    OSA_InterruptEnable();
+#ifdef MEM_TRACE
+    MEM_TraceRecord(MEM_TRACE_FREE_c, 0, (uint8_t)(pParentPool - memPools), pHeader, savedLR);
+#endif /*MEM_TRACE*/
+    mMemDebugUnlock_m();
+
+    MEM_PoolPush(pParentPool, pHeader);
+    mMemUnlock_m();
     return MEM_SUCCESS_c;
 }
 
@@ -517,11 +674,510 @@ void* buffer /* IN: Block of memory to free*/
     return 0;
 }
 
+#if gMemBufferRefCount_d
+/*! *********************************************************************************
+* \brief     Adds a reference to an allocated buffer, so that it can be handed to
+*            several owners without being copied. Every owner drops its reference
+*            with MEM_BufferFree(); the block returns to its pool with the last one.
+*
+* \param[in] buffer - Pointer to an allocated buffer.
+*
+* \return MEM_SUCCESS_c if the reference was added, MEM_ALLOC_ERROR_c if the
+*         buffer is invalid, free, or has too many references.
+*
+* \pre Memory manager must be previously initialized.
+*
+********************************************************************************** */
+memStatus_t MEM_BufferRetain
+(
+void* buffer
+)
+{
+    listHeader_t *pHeader = MEM_GetValidHeader(buffer);
+    memStatus_t status = MEM_ALLOC_ERROR_c;
+#if gMemLockFreePools_d
+    uint16_t refCount;
+#endif
+
+    if( pHeader == NULL )
+    {
+#ifdef MEM_DEBUG_INVALID_POINTERS
+        panic( 0, (uint32_t)MEM_BufferRetain, 0, 0);
+#endif
+        return MEM_ALLOC_ERROR_c;
+    }
+
+#if gMemLockFreePools_d
+    refCount = __atomic_load_n(&pHeader->refCount, __ATOMIC_RELAXED);
+
+    while( (refCount != 0) && (refCount != 0xFFFF) )
+    {
+        if( __atomic_compare_exchange_n(&pHeader->refCount, &refCount, refCount + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+        {
+            status = MEM_SUCCESS_c;
+            break;
+        }
+    }
+#else
+    OSA_InterruptDisable();
+
+    if( (pHeader->refCount != 0) && (pHeader->refCount != 0xFFFF) )
+    {
+        pHeader->refCount++;
+        status = MEM_SUCCESS_c;
+    }
+
+    OSA_InterruptEnable();
+#endif
+
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief     Returns the number of references to a buffer.
+*
+* \param[in] buffer - Pointer to buffer.
+*
+* \return Number of references, 0 if the buffer is free or invalid.
+*
+********************************************************************************** */
+uint16_t MEM_BufferGetRefCount
+(
+void* buffer
+)
+{
+    listHeader_t *pHeader = MEM_GetValidHeader(buffer);
+
+    return pHeader ? pHeader->refCount : 0;
+}
+
+/*! *********************************************************************************
+* \brief     Drops one reference to a buffer. The prototype matches the Serial
+*            Manager Tx callback, so a retained buffer can be transmitted
+*            asynchronously and released when the transmission ends.
+*
+* \param[in] buffer - Pointer to buffer.
+*
+********************************************************************************** */
+void MEM_BufferReleaseCallback
+(
+void* buffer
+)
+{
+    (void)MEM_BufferFree(buffer);
+}
+#endif /* gMemBufferRefCount_d */
+
+/*! *********************************************************************************
+* \brief     Returns the number of memory pools.
+*
+* \return Number of pools in memPools[].
+*
+********************************************************************************** */
+uint8_t MEM_GetPoolCount(void)
+{
+    return mMemPoolCount_c;
+}
+
+/*! *********************************************************************************
+* \brief     Returns a memory pool, for inspection.
+*
+* \param[in] poolIdx - Index of the pool, 0 to MEM_GetPoolCount() - 1.
+*
+* \return Pointer to the pool, NULL if poolIdx is out of range.
+*
+********************************************************************************** */
+const pools_t* MEM_GetPool
+(
+uint8_t poolIdx
+)
+{
+    if( poolIdx >= mMemPoolCount_c )
+    {
+        return NULL;
+    }
+
+    return &memPools[poolIdx];
+}
+
+#ifdef MEM_STATISTICS
+/*! *********************************************************************************
+* \brief     Copies the statistics of a memory pool. The copy is taken with
+*            interrupts disabled, so that its counters are consistent.
+*
+* \param[in] poolIdx - Index of the pool, 0 to MEM_GetPoolCount() - 1.
+* \param[out] pStatistics - Statistics of the pool.
+*
+* \return TRUE if the statistics were copied, FALSE if poolIdx is out of range.
+*
+********************************************************************************** */
+bool_t MEM_GetPoolStatistics
+(
+uint8_t poolIdx,
+poolStat_t *pStatistics
+)
+{
+    if( poolIdx >= mMemPoolCount_c )
+    {
+        return FALSE;
+    }
+
+    OSA_InterruptDisable();
+    FLib_MemCpy(pStatistics, &memPools[poolIdx].poolStatistics, sizeof(poolStat_t));
+    OSA_InterruptEnable();
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief     Returns the lowest number of free blocks since MEM_Init() or
+*            MEM_ResetStatistics().
+*
+********************************************************************************** */
+uint16_t MEM_GetFreeBlocksMin(void)
+{
+    return gFreeMessagesCountMin;
+}
+
+/*! *********************************************************************************
+* \brief     Restarts the pool statistics from the current state: the peaks and
+*            minimums are set to the current values, and the failure counters,
+*            waste and size histograms are cleared.
+*
+********************************************************************************** */
+void MEM_ResetStatistics(void)
+{
+    poolStat_t *pStatistics;
+    uint8_t i;
+
+    OSA_InterruptDisable();
+
+    gFreeMessagesCountMin = gFreeMessagesCount;
+
+    for( i = 0; i < mMemPoolCount_c; i++ )
+    {
+        pStatistics = &memPools[i].poolStatistics;
+        pStatistics->allocatedBlocksPeak = pStatistics->allocatedBlocks;
+        pStatistics->allocationFailures = 0;
+        pStatistics->freeFailures = 0;
+        pStatistics->wasteMax = 0;
+        pStatistics->allocations = 0;
+        pStatistics->wasteSum = 0;
+        FLib_MemSet(pStatistics->sizeHistogram, 0, sizeof(pStatistics->sizeHistogram));
+#ifdef MEM_TRACKING
+        pStatistics->poolFragmentWastePeak = pStatistics->poolFragmentWaste;
+        pStatistics->poolFragmentMinWaste = 0xFFFF;
+        pStatistics->poolFragmentMaxWaste = 0;
+#endif /*MEM_TRACKING*/
+    }
+
+#ifdef MEM_TRACKING
+    gMaxTotalFragmentWaste = gTotalFragmentWaste;
+#endif /*MEM_TRACKING*/
+
+    OSA_InterruptEnable();
+}
+#endif /*MEM_STATISTICS*/
+
+#ifdef MEM_TRACE
+/*! *********************************************************************************
+* \brief     Starts or stops recording alloc/free events in the allocation trace.
+*            Recording is enabled after reset.
+*
+* \param[in] enable - TRUE to record events.
+*
+********************************************************************************** */
+void MEM_TraceEnable
+(
+bool_t enable
+)
+{
+    mMemTraceEnabled = enable;
+}
+
+/*! *********************************************************************************
+* \brief     Removes the oldest events from the allocation trace.
+*
+* \param[out] pEntries - Buffer for the events, oldest first.
+* \param[in] maxEntries - Number of events that fit in pEntries.
+*
+* \return Number of events copied.
+*
+********************************************************************************** */
+uint16_t MEM_TraceRead
+(
+memTraceEntry_t *pEntries,
+uint16_t maxEntries
+)
+{
+    uint16_t count = 0;
+
+    OSA_InterruptDisable();
+
+    while( (count < maxEntries) && mMemTraceCount )
+    {
+        pEntries[count++] = mMemTrace[mMemTraceTail];
+        mMemTraceTail = (mMemTraceTail + 1) % MEM_TRACE_SIZE;
+        mMemTraceCount--;
+    }
+
+    OSA_InterruptEnable();
+
+    return count;
+}
+
+/*! *********************************************************************************
+* \brief     Returns the number of events overwritten before they were read.
+*
+********************************************************************************** */
+uint32_t MEM_TraceGetLost(void)
+{
+    return mMemTraceLost;
+}
+
+/*! *********************************************************************************
+* \brief     Discards all events of the allocation trace and clears the lost
+*            events counter.
+*
+********************************************************************************** */
+void MEM_TraceReset(void)
+{
+    OSA_InterruptDisable();
+    mMemTraceTail = 0;
+    mMemTraceCount = 0;
+    mMemTraceLost = 0;
+    OSA_InterruptEnable();
+}
+#endif /*MEM_TRACE*/
+
 /*! *********************************************************************************
 *************************************************************************************
 * Private functions
 *************************************************************************************
 ********************************************************************************** */
+/*! *********************************************************************************
+* \brief     Returns the index of the first pool, starting with startIdx, that has
+*            the given ID and blocks of at least numBytes.
+*
+* \param[in] numBytes - Size of the buffer.
+* \param[in] poolId - The ID of the pool.
+* \param[in] startIdx - Index of the first pool checked.
+*
+* \return Index of the pool, or mMemNoPool_c if none fits.
+*
+********************************************************************************** */
+static uint8_t MEM_FindPool(uint32_t numBytes, uint8_t poolId, uint8_t startIdx)
+{
+    uint8_t i;
+
+    for( i = startIdx; i < mMemPoolCount_c; i++ )
+    {
+        if( (numBytes <= memPools[i].blockSize) && (poolId == memPools[i].poolId) )
+        {
+            return i;
+        }
+    }
+
+    return mMemNoPool_c;
+}
+
+/*! *********************************************************************************
+* \brief     Builds the pool lookup tables. Called by MEM_Init() once the pools
+*            are initialized.
+*
+********************************************************************************** */
+static void MEM_InitPoolLookup(void)
+{
+    uint32_t bucket;
+    uint8_t id;
+    uint8_t i;
+
+    for( id = 0; id < gMemPoolLookupIds_c; id++ )
+    {
+        /* Bucket 0 is a zero size request, which is never served */
+        mMemPoolLookup[id][0] = mMemNoPool_c;
+
+        for( bucket = 1; bucket <= mMemLookupBucket_m(gMemPoolLookupMaxSize_c); bucket++ )
+        {
+            /* Any request of the bucket fits in 4 * bucket bytes */
+            mMemPoolLookup[id][bucket] = MEM_FindPool(bucket << 2, id, 0);
+        }
+    }
+
+    for( i = 0; i < mMemPoolCount_c; i++ )
+    {
+        mMemPoolNext[i] = MEM_FindPool(memPools[i].blockSize, (uint8_t)memPools[i].poolId, i + 1);
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Removes a free block from a pool. Must be called with interrupts
+*            disabled, unless gMemLockFreePools_d is enabled.
+*
+* \param[in] pPool - Pointer to the pool.
+*
+* \return Header of the block, NULL if the pool is empty.
+*
+********************************************************************************** */
+static listHeader_t* MEM_PoolPop(pools_t *pPool)
+{
+#if gMemLockFreePools_d
+    uint32_t top = __atomic_load_n(&pPool->freeTop, __ATOMIC_ACQUIRE);
+    listHeader_t *pBlock;
+    listHeader_t *pNext;
+
+    do
+    {
+        if( (top & 0xFFFF) == 0 )
+        {
+            return NULL;
+        }
+
+        pBlock = mMemTopBlock_m(top);
+        /* May be changed by the owner of the block if another context allocated
+           it meanwhile; the tag of the top has then changed and the swap fails */
+        pNext = (listHeader_t *)__atomic_load_n(&pBlock->link.next, __ATOMIC_RELAXED);
+    } while( !__atomic_compare_exchange_n(&pPool->freeTop, &top, mMemTopMake_m(top, pNext), TRUE, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) );
+
+    __atomic_store_n(&pBlock->link.list, NULL, __ATOMIC_RELAXED);
+    return pBlock;
+#else
+    return (listHeader_t *)ListRemoveHead((listHandle_t)&pPool->anchor);
+#endif
+}
+
+/*! *********************************************************************************
+* \brief     Returns a block to its pool. Must be called with interrupts disabled,
+*            unless gMemLockFreePools_d is enabled.
+*
+* \param[in] pPool - Pointer to the pool.
+* \param[in] pBlock - Header of the block.
+*
+********************************************************************************** */
+static void MEM_PoolPush(pools_t *pPool, listHeader_t *pBlock)
+{
+#if gMemLockFreePools_d
+    uint32_t top = __atomic_load_n(&pPool->freeTop, __ATOMIC_RELAXED);
+
+    do
+    {
+        __atomic_store_n(&pBlock->link.next,
+                         (top & 0xFFFF) ? &mMemTopBlock_m(top)->link : NULL,
+                         __ATOMIC_RELAXED);
+    } while( !__atomic_compare_exchange_n(&pPool->freeTop, &top, mMemTopMake_m(top, pBlock), TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED) );
+#else
+    ListAddTail((listHandle_t)&pPool->anchor, (listElementHandle_t)&pBlock->link);
+#endif
+}
+
+#if gMemLockFreePools_d && defined(MEM_STATISTICS)
+/*! *********************************************************************************
+* \brief     Atomically raises a statistics peak to value.
+*
+********************************************************************************** */
+static void MEM_UpdateMax16(uint16_t *pMax, uint16_t value)
+{
+    uint16_t current = __atomic_load_n(pMax, __ATOMIC_RELAXED);
+
+    while( (value > current) &&
+           !__atomic_compare_exchange_n(pMax, &current, value, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+    {
+    }
+}
+
+/*! *********************************************************************************
+* \brief     Atomically lowers a statistics minimum to value.
+*
+********************************************************************************** */
+static void MEM_UpdateMin16(uint16_t *pMin, uint16_t value)
+{
+    uint16_t current = __atomic_load_n(pMin, __ATOMIC_RELAXED);
+
+    while( (value < current) &&
+           !__atomic_compare_exchange_n(pMin, &current, value, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+    {
+    }
+}
+#endif /* gMemLockFreePools_d && MEM_STATISTICS */
+
+#if gMemBufferRefCount_d
+/*! *********************************************************************************
+* \brief     Returns the header of a buffer allocated from the heap.
+*
+* \param[in] buffer - Pointer to buffer.
+*
+* \return Pointer to the header, NULL if the buffer is not a block of a pool.
+*
+********************************************************************************** */
+static listHeader_t* MEM_GetValidHeader(void *buffer)
+{
+    listHeader_t *pHeader;
+    pools_t *pParentPool;
+
+    if( buffer == NULL )
+    {
+        return NULL;
+    }
+
+    pHeader = (listHeader_t *)buffer-1;
+
+    if( ((uint8_t*)pHeader < (uint8_t*)memHeap) || ((uint8_t*)pHeader >= ((uint8_t*)memHeap + sizeof(memHeap))) )
+    {
+        return NULL;
+    }
+
+    pParentPool = (pools_t *)pHeader->pParentPool;
+
+    if( (pParentPool < memPools) || (pParentPool >= &memPools[mMemPoolCount_c]) ||
+        ((((uint8_t*)pParentPool - (uint8_t*)memPools) % sizeof(pools_t)) != 0) )
+    {
+        return NULL;
+    }
+
+    return pHeader;
+}
+#endif /* gMemBufferRefCount_d */
+
+#ifdef MEM_TRACE
+/*! *********************************************************************************
+* \brief     Adds an event to the allocation trace. When the trace is full the
+*            oldest event is overwritten. Must be called with interrupts disabled.
+*
+* \param[in] op - Traced operation.
+* \param[in] requestedSize - Size requested by allocator, 0 for free.
+* \param[in] poolIdx - Index of the pool, MEM_TRACE_NO_POOL_c if the allocation failed.
+* \param[in] pHeader - Header of the block, NULL if the allocation failed.
+* \param[in] caller - Return address of the alloc/free call.
+*
+********************************************************************************** */
+static void MEM_TraceRecord(memTraceOp_t op, uint16_t requestedSize, uint8_t poolIdx, listHeader_t *pHeader, uint32_t caller)
+{
+    memTraceEntry_t *pEntry;
+
+    if( !mMemTraceEnabled )
+    {
+        return;
+    }
+
+    if( mMemTraceCount == MEM_TRACE_SIZE )
+    {
+        mMemTraceTail = (mMemTraceTail + 1) % MEM_TRACE_SIZE;
+        mMemTraceCount--;
+        mMemTraceLost++;
+    }
+
+    pEntry = &mMemTrace[(mMemTraceTail + mMemTraceCount) % MEM_TRACE_SIZE];
+    mMemTraceCount++;
+
+    pEntry->timeStamp = MEM_GetTimeStamp();
+    pEntry->caller = caller;
+    pEntry->requestedSize = requestedSize;
+    pEntry->blockId = pHeader ? (uint16_t)(((uint8_t *)pHeader - (uint8_t *)memHeap) / sizeof(uint32_t)) : 0;
+    pEntry->poolIdx = poolIdx;
+    pEntry->op = (uint8_t)op;
+}
+#endif /*MEM_TRACE*/
+
 /*! *********************************************************************************
 * \brief     This function updates the tracking array element corresponding to the given
 *            block.
@@ -764,7 +1420,7 @@ void MEM_CheckIfMemBuffersAreFreed(void)
 * \return dymmy time-stamp
 *
 ********************************************************************************** */
-#ifdef MEM_TRACKING
+#if defined(MEM_TRACKING) || defined(MEM_TRACE)
 #if defined(__IAR_SYSTEMS_ICC__)
 __weak uint32_t MEM_GetTimeStamp(void)
 #elif defined(__GNUC__)
@@ -773,7 +1429,7 @@ __attribute__((weak)) uint32_t MEM_GetTimeStamp(void)
 {
     return 0xFFFFFFFF;
 }
-#endif /* MEM_TRACKING */
+#endif /* MEM_TRACKING || MEM_TRACE */
 
 /*! *********************************************************************************
 * \brief     Performs a write-read-verify test for every byte in all memory pools.
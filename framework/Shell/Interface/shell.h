@@ -52,6 +52,42 @@ extern "C" {
                            (SHELL_HELP_CMDS)    + \
                            (SHELL_HIST_CMDS)
 
+/* RPC mode. ESC 'R' received in text mode switches the interface to frames:
+ *
+ *   COBS( type | seq | id | len (2) | data (len) | crc (2) ) 0x00
+ *
+ * len and crc are little endian, crc is the CRC-16/CCITT-FALSE of the fields
+ * before it. A request is answered by the OUTPUT frames holding the text the
+ * command writes, then by a RESPONSE frame holding the command_ret_t status,
+ * both with the seq and id of the request. The request data are the arguments,
+ * each terminated by '\0'. An ASYNC status is followed by a DONE frame when the
+ * command finishes. What is written outside of a command (GAP and GATT events)
+ * is sent in EVENT frames. The TEXT request switches back to text mode. */
+#define SHELL_RPC_ESCAPE_CHAR       ('R')
+
+/* Frame types */
+#define SHELL_RPC_REQUEST           (0x01)
+#define SHELL_RPC_RESPONSE          (0x02)
+#define SHELL_RPC_OUTPUT            (0x03)
+#define SHELL_RPC_EVENT             (0x04)
+#define SHELL_RPC_DONE              (0x05)
+#define SHELL_RPC_ERROR             (0x06)    /* a frame was rejected, data is the status */
+
+/* Reserved command IDs, the others are registered with shell_rpc_register() */
+#define SHELL_RPC_ID_TEXT           (0x00)    /* back to text mode */
+#define SHELL_RPC_ID_PING           (0x01)    /* data is sent back in the RESPONSE */
+#define SHELL_RPC_ID_COMMAND_LINE   (0x02)    /* data is a command line, as typed in text mode */
+#define SHELL_RPC_ID_BREAK          (0x03)    /* stops the ASYNC command, like CTRL + C */
+
+/* Statuses added to command_ret_t */
+#define SHELL_RPC_STATUS_UNKNOWN_ID (-2)
+#define SHELL_RPC_STATUS_BAD_ARGS   (-3)
+#define SHELL_RPC_STATUS_BAD_FRAME  (-4)
+
+/* Frame size without data */
+#define SHELL_RPC_HEADER_SIZE       (5)
+#define SHELL_RPC_CRC_SIZE          (2)
+
 /*! *********************************************************************************
 *************************************************************************************
 * Public type definitions
@@ -72,6 +108,19 @@ typedef struct
 #endif
 }cmd_tbl_t;
 
+typedef struct
+{
+    uint8_t     id;         /* RPC command ID       */
+    char        *name;      /* Command Name         */
+    char        *subcmd;    /* First argument, or NULL  */
+}shell_rpc_cmd_t;
+
+typedef struct
+{
+    char        *name;      /* Sub-command name     */
+    int8_t      (*cmd)(uint8_t argc, char * argv[]);  /* Implementation function    */
+}shell_subcmd_t;
+
 typedef enum
 {
     CMD_RET_SUCCESS  = 0,    /* 0 = Success */
@@ -107,21 +156,33 @@ uint8_t shell_unregister_function(char * name);
 
 void shell_write(char *pBuff);
 void shell_writeN(char *pBuff, uint16_t n);
+void shell_writeShared(uint8_t *pBuff, uint16_t n);
 void shell_writeDec(uint32_t nb);
 void shell_writeSignedDec(int8_t nb);
+void shell_writeColumn(uint32_t nb, uint8_t width);
 void shell_writeHex(uint8_t *pHex, uint8_t len);
 void shell_writeHexLe(uint8_t *pHex, uint8_t len);
 void shell_writeBool(bool_t boolValue);
 void shell_putc(char c);
+void shell_flush(void);
 #if SHELL_USE_PRINTF
 uint16_t shell_printf(char * format,...);
 #endif
 cmd_tbl_t * shell_find_command( char * cmd );
+void * shell_find_subcommand( char * name, const void * pTable, uint16_t num, uint16_t entrySize );
+int8_t shell_exec_subcommand( uint8_t argc, char * argv[], const shell_subcmd_t * pTable, uint16_t num );
 uint8_t make_argv(char *s, uint8_t argvsz, char * argv[]);
 char * shell_get_opt(uint8_t argc, char * argv[], char *pOption);
 #if SHELL_USE_ALT_TASK
 void shell_task(void);
 #endif
+#if SHELL_USE_RPC
+void shell_rpc_register(const shell_rpc_cmd_t * pTable, uint8_t num);
+bool_t shell_rpc_active(void);
+#else
+#define shell_rpc_register(pTable,num)
+#define shell_rpc_active() FALSE
+#endif
 
 #else /* SHELL_ENABLED */
 
@@ -134,13 +195,18 @@ void shell_task(void);
 #define shell_unregister_function(name)                0
 #define shell_write(pBuff)
 #define shell_writeN(pBuff,n)
+#define shell_writeShared(pBuff,n)
 #define shell_writeDec(nb)
 #define shell_writeSignedDec(nb)
+#define shell_writeColumn(nb,width)
 #define shell_writeHex(pHex,len)
 #define shell_writeHexLe(pHex,len)
 #define shell_writeBool(boolValue)
 #define shell_putc(c)
+#define shell_flush()
 #define shell_find_command(cmd) NULL
+#define shell_find_subcommand(name,pTable,num,entrySize) NULL
+#define shell_exec_subcommand(argc,argv,pTable,num) CMD_RET_USAGE
 #define make_argv(s,argvsz,argv) 0
 #define shell_get_opt(argc,argv,pOption) NULL
 #if SHELL_USE_PRINTF
@@ -149,6 +215,8 @@ void shell_task(void);
 #if SHELL_USE_ALT_TASK
 #define shell_task()
 #endif
+#define shell_rpc_register(pTable,num)
+#define shell_rpc_active() FALSE
 
 #endif /* SHELL_ENABLED */
 
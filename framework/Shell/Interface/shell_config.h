@@ -52,6 +52,29 @@
 #define SHELL_CB_SIZE                 (64)
 #endif
 
+/* size of the output buffer that coalesces the shell writes into one serial
+   transfer. if set to 0, every write is a serial transfer.
+   at most 255 on I2C/SPI slave interfaces */
+#ifndef SHELL_TX_BUFFER_SIZE
+#define SHELL_TX_BUFFER_SIZE          (0)
+#endif
+
+/* time after which a partially filled output buffer is sent, in milliseconds */
+#ifndef SHELL_TX_FLUSH_TIMEOUT
+#define SHELL_TX_FLUSH_TIMEOUT        (5)
+#endif
+
+/* enables the framed binary RPC mode, entered with ESC 'R' (see shell.h).
+   requires SHELL_TX_BUFFER_SIZE */
+#ifndef SHELL_USE_RPC
+#define SHELL_USE_RPC                 (0)
+#endif
+
+/* maximum number of data bytes in an RPC frame sent by the shell */
+#ifndef SHELL_RPC_MAX_DATA
+#define SHELL_RPC_MAX_DATA            (128)
+#endif
+
 /* maximum function args */
 #ifndef SHELL_MAX_ARGS
 #define SHELL_MAX_ARGS                (10)
@@ -14,12 +14,19 @@
 *************************************************************************************
 ************************************************************************************/
 #include <string.h>
+#if SHELL_USE_PRINTF
+#include <stdarg.h>
+#endif
 
 #include "shell.h"
 #include "FunctionLib.h"
 #include "SerialManager.h"
 #include "MemManager.h"
 #include "board.h"
+#if SHELL_TX_BUFFER_SIZE
+#include "TimersManager.h"
+#include "fsl_os_abstraction.h"
+#endif
 
 #if SHELL_ENABLED
 /************************************************************************************
@@ -55,6 +62,27 @@ if( mCmdIdx < mCmdLen )                                 \
     mCmdIdx = 0;             \
 }
 
+#if SHELL_USE_PRINTF
+/* shell_printf() formats into a chunk of this size on the stack, written
+   with shell_writeN() each time it is full */
+#define SHELL_PRINTF_CHUNK_SIZE (64)
+
+/* shell_printf() flags */
+#define SHELL_PRINTF_LEFT       (0x01)
+#define SHELL_PRINTF_ZERO       (0x02)
+#define SHELL_PRINTF_UPPER      (0x04)
+#define SHELL_PRINTF_SIGNED     (0x08)
+#define SHELL_PRINTF_LONG_LONG  (0x10)
+
+/* Output of shell_printf() */
+typedef struct
+{
+    char     buf[SHELL_PRINTF_CHUNK_SIZE];
+    uint8_t  len;
+    uint16_t total;
+}shellPrintfCtx_t;
+#endif
+
 /************************************************************************************
 *************************************************************************************
 * Private prototypes
@@ -63,6 +91,18 @@ if( mCmdIdx < mCmdLen )                                 \
 static void shell_main( void *params );
 static int16_t shell_ProcessChr( void );
 static void shell_erase_to_eol( void );
+static void shell_send( char *pBuff, uint16_t n );
+static bool_t shell_search_command( char *cmd, uint16_t *pIdx );
+#if SHELL_TX_BUFFER_SIZE
+static void shell_tx_flush( void );
+static void shell_tx_timeout( void *param );
+#endif
+#if SHELL_USE_PRINTF
+static void shell_printf_putc( shellPrintfCtx_t *pCtx, char c );
+static void shell_printf_pad( shellPrintfCtx_t *pCtx, char c, int16_t n );
+static void shell_printf_number( shellPrintfCtx_t *pCtx, uint64_t nb, uint8_t base,
+                                 uint8_t flags, int16_t width, int16_t precision );
+#endif
 
 /************************************************************************************
 *************************************************************************************
@@ -78,7 +118,17 @@ uint8_t  gShellSerMgrIf;
 uint8_t  mInsert = 1;
 uint8_t  mShellMaxCmdLen = 0;
 
+/* Registered commands, sorted by name. The unused entries are at the end */
 cmd_tbl_t *gpCmdTable[SHELL_CMD_TBL_SIZE];
+static uint16_t mShellCmdCount;
+
+#if SHELL_TX_BUFFER_SIZE
+/* Output buffer. Without a mutex the writes are not buffered */
+static char         mShellTxBuf[SHELL_TX_BUFFER_SIZE];
+static uint16_t     mShellTxLen;
+static osaMutexId_t mShellTxMutexId = NULL;
+static tmrTimerID_t mShellTxTimerId = gTmrInvalidTimerID_c;
+#endif
 
 int8_t (*mpfShellBreak)(uint8_t argc, char * argv[]) = NULL;
 void (*pfShellProcessCommand) (char * pCmd, uint16_t length) = NULL;
@@ -119,6 +169,13 @@ extern char * hist_next(void);
 extern char * hist_prev(void);
 #endif
 
+#if SHELL_USE_RPC
+extern void shell_rpc_enter(void);
+extern bool_t shell_rpc_main(void);
+extern void shell_rpc_send(char *pBuff, uint16_t n);
+extern void shell_rpc_cmd_finished(void);
+#endif
+
 /************************************************************************************
 *************************************************************************************
 * Public functions
@@ -153,7 +210,13 @@ void shell_init(char* prompt)
 
     mCmdLen = 0;
     mCmdIdx = 0;
+#if SHELL_TX_BUFFER_SIZE
+    mShellTxLen = 0;
+    mShellTxMutexId = OSA_MutexCreate();
+    mShellTxTimerId = TMR_AllocateTimer();
+#endif
     FLib_MemSet(gpCmdTable, 0, sizeof(gpCmdTable));
+    mShellCmdCount = 0;
     FLib_MemSet(mCmdBuf, 0, sizeof(mCmdBuf));
 #if SHELL_USE_HELP
     shell_register_function(&CommandFun_Help);
@@ -168,6 +231,7 @@ void shell_init(char* prompt)
     shell_write(__DATE__);
     shell_write("\n\rCopyright (c) 2016 NXP Semiconductors\r\n");
     shell_write(pPrompt);
+    shell_flush();
 #endif
 }
 
@@ -193,8 +257,16 @@ void shell_cmd_finished(void)
 {
     mpfShellBreak = NULL;
     SHELL_RESET();
+#if SHELL_USE_RPC
+    if( shell_rpc_active() )
+    {
+        shell_rpc_cmd_finished();
+        return;
+    }
+#endif
     SHELL_NEWLINE();
     shell_write(pPrompt);
+    shell_flush();
 }
 
 /*! *********************************************************************************
@@ -204,12 +276,21 @@ void shell_cmd_finished(void)
 void shell_refresh(void)
 {
     SHELL_RESET();
+#if SHELL_USE_RPC
+    /* No prompt in RPC mode */
+    if( shell_rpc_active() )
+    {
+        shell_flush();
+        return;
+    }
+#endif
 #if (SHELL_USE_ECHO)
     SHELL_NEWLINE();
 #if !gHybridApp_d
     shell_write(pPrompt);
 #endif
 #endif
+    shell_flush();
 }
 
 /*! *********************************************************************************
@@ -218,7 +299,9 @@ void shell_refresh(void)
 * \param[in]  pBuff pointer to a string
 * \param[in]  n number of chars to be written
 *
-* \remarks
+* \remarks With SHELL_TX_BUFFER_SIZE, the bytes are added to the output buffer,
+*          which is sent when it is full, when a new line is written, on
+*          shell_flush() or SHELL_TX_FLUSH_TIMEOUT ms after its first byte.
 *
 ********************************************************************************** */
 void shell_writeN(char *pBuff, uint16_t n)
@@ -226,27 +309,102 @@ void shell_writeN(char *pBuff, uint16_t n)
     if( !pBuff || !n )
         return;
 
-    if (SHELL_IO_TYPE == gSerialMgrIICSlave_c ||
-        SHELL_IO_TYPE == gSerialMgrSPISlave_c)
+#if SHELL_TX_BUFFER_SIZE
+    if( mShellTxMutexId )
     {
-        uint8_t *pHdr = MEM_BufferAlloc(n+5);
+        (void)OSA_MutexLock(mShellTxMutexId, osaWaitForever_c);
 
-        if (pHdr)
+        if( mShellTxLen + n > SHELL_TX_BUFFER_SIZE )
         {
-            pHdr[0] = 0x02;
-            pHdr[1] = 0x77;
-            pHdr[2] = 0x77;
-            pHdr[3] = n;
-            FLib_MemCpy(&pHdr[4], pBuff, n);
-            pHdr[4+n] = 0;
-            Serial_SyncWrite( gShellSerMgrIf, pHdr, n+5 );
-            MEM_BufferFree(pHdr);
+            shell_tx_flush();
+        }
+
+        if( n >= SHELL_TX_BUFFER_SIZE )
+        {
+            shell_send(pBuff, n);
+        }
+        else
+        {
+            if( (0 == mShellTxLen) && (gTmrInvalidTimerID_c != mShellTxTimerId) )
+            {
+                (void)TMR_StartSingleShotTimer(mShellTxTimerId, SHELL_TX_FLUSH_TIMEOUT, shell_tx_timeout, NULL);
+            }
+
+            FLib_MemCpy(&mShellTxBuf[mShellTxLen], pBuff, n);
+            mShellTxLen += n;
+
+            if( memchr(pBuff, '\n', n) )
+            {
+                shell_tx_flush();
+            }
         }
+
+        (void)OSA_MutexUnlock(mShellTxMutexId);
+        return;
     }
-    else
+#endif
+
+    shell_send(pBuff, n);
+}
+
+/*! *********************************************************************************
+* \brief  This function will send the output buffer over the serial interface
+*
+* \remarks
+*
+********************************************************************************** */
+void shell_flush(void)
+{
+#if SHELL_TX_BUFFER_SIZE
+    if( mShellTxMutexId )
     {
-        Serial_SyncWrite(gShellSerMgrIf, (uint8_t*)pBuff, n);
+        (void)OSA_MutexLock(mShellTxMutexId, osaWaitForever_c);
+        shell_tx_flush();
+        (void)OSA_MutexUnlock(mShellTxMutexId);
+    }
+#endif
+}
+
+/*! *********************************************************************************
+* \brief  This function will write N bytes of a Memory Manager buffer over the
+*         serial interface, without waiting for the transmission to end
+*
+* \param[in]  pBuff pointer to a buffer allocated from the Memory Manager
+* \param[in]  n number of bytes to be written
+*
+* \remarks The shell takes a reference to the buffer, dropped when the
+*          transmission ends. The caller still frees its own reference.
+*          Without gMemBufferRefCount_d, or on a slave interface, the buffer
+*          is written by shell_writeN().
+*
+********************************************************************************** */
+void shell_writeShared(uint8_t *pBuff, uint16_t n)
+{
+#if gMemBufferRefCount_d
+    serialStatus_t status;
+
+    if( !pBuff || !n )
+        return;
+
+    if( (SHELL_IO_TYPE != gSerialMgrIICSlave_c) &&
+        (SHELL_IO_TYPE != gSerialMgrSPISlave_c) &&
+        !shell_rpc_active() &&
+        (MEM_BufferRetain(pBuff) == MEM_SUCCESS_c) )
+    {
+        /* Keep the order of the output */
+        shell_flush();
+        status = Serial_AsyncWrite(gShellSerMgrIf, pBuff, n, MEM_BufferReleaseCallback, pBuff);
+
+        /* Not queued: the Tx callback will not drop the shell reference */
+        if( (gSerial_InvalidParameter_c == status) ||
+            (gSerial_OutOfMemory_c == status) )
+        {
+            (void)MEM_BufferFree(pBuff);
+        }
+        return;
     }
+#endif
+    shell_writeN((char*)pBuff, n);
 }
 
 /*! *********************************************************************************
@@ -272,7 +430,11 @@ void shell_write( char *pBuff )
 ********************************************************************************** */
 void shell_putc(char c)
 {
+#if SHELL_TX_BUFFER_SIZE
+    shell_writeN(&c, 1);
+#else
     Serial_SyncWrite(gShellSerMgrIf, (uint8_t*)&c, 1);
+#endif
 }
 
 /*! *********************************************************************************
@@ -288,7 +450,20 @@ void shell_writeDec
     uint32_t nb
 )
 {
+#if SHELL_TX_BUFFER_SIZE
+    char decString[10];
+    uint8_t i = sizeof(decString);
+
+    do
+    {
+        decString[--i] = '0' + (nb % 10);
+        nb = nb / 10;
+    } while (nb);
+
+    shell_writeN(&decString[i], sizeof(decString) - i);
+#else
     Serial_PrintDec(gShellSerMgrIf, nb);
+#endif
 }
 
 /*! *********************************************************************************
@@ -310,7 +485,39 @@ void shell_writeSignedDec
         shell_write("-");
         nb = ~(nb - 1);
     }
-    Serial_PrintDec(gShellSerMgrIf, nb);
+    shell_writeDec(nb);
+}
+
+/*! *********************************************************************************
+* \brief  This function will write a decimal number right aligned in a column
+*
+* \param[in]  nb     number to be written
+* \param[in]  width  width of the column. Longer numbers are written entirely.
+*
+* \remarks
+*
+********************************************************************************** */
+void shell_writeColumn
+(
+    uint32_t nb,
+    uint8_t width
+)
+{
+    uint32_t limit = 10;
+    uint8_t digits = 1;
+
+    while ((nb >= limit) && (digits < 10))
+    {
+        limit *= 10;
+        digits++;
+    }
+
+    while (digits++ < width)
+    {
+        shell_putc(' ');
+    }
+
+    shell_writeDec(nb);
 }
 
 /*! *********************************************************************************
@@ -328,7 +535,19 @@ void shell_writeHex
     uint8_t len
 )
 {
+#if SHELL_TX_BUFFER_SIZE
+    char hexString[2];
+
+    while (len--)
+    {
+        hexString[0] = HexToAscii(*pHex >> 4);
+        hexString[1] = HexToAscii(*pHex);
+        shell_writeN(hexString, 2);
+        pHex++;
+    }
+#else
     Serial_PrintHex(gShellSerMgrIf, pHex, len, gPrtHexBigEndian_c);
+#endif
 }
 
 /*! *********************************************************************************
@@ -346,7 +565,18 @@ void shell_writeHexLe
     uint8_t len
 )
 {
+#if SHELL_TX_BUFFER_SIZE
+    char hexString[2];
+
+    while (len--)
+    {
+        hexString[0] = HexToAscii(pHex[len] >> 4);
+        hexString[1] = HexToAscii(pHex[len]);
+        shell_writeN(hexString, 2);
+    }
+#else
     Serial_PrintHex(gShellSerMgrIf, pHex, len, gPrtHexNoFormat_c);
+#endif
 }
 
 /*! *********************************************************************************
@@ -378,29 +608,178 @@ void shell_writeBool
 * \param[in]  format string defining the output
 * \param[in]  ... variable number of parameters
 *
-* \remarks
+* \return     the number of characters written
+*
+* \remarks The conversions are %d, %i, %u, %x, %X, %o, %c, %s, %p and %%, with
+*          the '-' and '0' flags, a width, a precision and the hh, h, l, ll
+*          and z length modifiers. Other conversions are written as they are.
+*          No memory is allocated, so the output is never lost when the pools
+*          are exhausted.
 *
 ********************************************************************************** */
 #if SHELL_USE_PRINTF
-#include <stdio.h>
-#include <stdarg.h>
-
 uint16_t shell_printf(char * format,...)
 {
     va_list ap;
-    uint16_t n = 0;
-    char *pStr = (char*)MEM_BufferAlloc(SHELL_CB_SIZE);
+    shellPrintfCtx_t ctx;
+    uint8_t flags;
+    int16_t width;
+    int16_t precision;
+    char *pStr;
+    int16_t len;
+
+    ctx.len = 0;
+    ctx.total = 0;
 
-    if (pStr)
+    va_start(ap, format);
+
+    while (*format)
     {
-        va_start(ap, format);
-        n = vsnprintf(pStr, SHELL_CB_SIZE, format, ap);
-        //va_end(ap); /* follow MISRA... */
-        Serial_SyncWrite(gShellSerMgrIf, (uint8_t*)pStr, n);
-        MEM_BufferFree(pStr);
+        if (*format != '%')
+        {
+            shell_printf_putc(&ctx, *format++);
+            continue;
+        }
+
+        /* Flags */
+        flags = 0;
+        for (format++; (*format == '-') || (*format == '0'); format++)
+        {
+            flags |= (*format == '-') ? SHELL_PRINTF_LEFT : SHELL_PRINTF_ZERO;
+        }
+
+        /* Width */
+        width = 0;
+        if (*format == '*')
+        {
+            width = (int16_t)va_arg(ap, int);
+            if (width < 0)
+            {
+                flags |= SHELL_PRINTF_LEFT;
+                width = -width;
+            }
+            format++;
+        }
+        while ((*format >= '0') && (*format <= '9'))
+        {
+            width = width * 10 + (*format++ - '0');
+        }
+
+        /* Precision */
+        precision = -1;
+        if (*format == '.')
+        {
+            precision = 0;
+            format++;
+            if (*format == '*')
+            {
+                precision = (int16_t)va_arg(ap, int);
+                format++;
+            }
+            while ((*format >= '0') && (*format <= '9'))
+            {
+                precision = precision * 10 + (*format++ - '0');
+            }
+        }
+
+        /* Length; int and long are both 32 bit */
+        while ((*format == 'h') || (*format == 'l') || (*format == 'z'))
+        {
+            if ((format[0] == 'l') && (format[1] == 'l'))
+            {
+                flags |= SHELL_PRINTF_LONG_LONG;
+                format++;
+            }
+            format++;
+        }
+
+        switch (*format)
+        {
+        case 'd':
+        case 'i':
+            {
+                int64_t nb = (flags & SHELL_PRINTF_LONG_LONG) ? va_arg(ap, int64_t) : va_arg(ap, int);
+
+                if (nb < 0)
+                {
+                    flags |= SHELL_PRINTF_SIGNED;
+                }
+                shell_printf_number(&ctx, (nb < 0) ? (0 - (uint64_t)nb) : (uint64_t)nb, 10, flags, width, precision);
+            }
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            {
+                uint64_t nb = (flags & SHELL_PRINTF_LONG_LONG) ? va_arg(ap, uint64_t) : va_arg(ap, unsigned int);
+
+                if (*format == 'X')
+                {
+                    flags |= SHELL_PRINTF_UPPER;
+                }
+                shell_printf_number(&ctx, nb, (*format == 'u') ? 10 : ((*format == 'o') ? 8 : 16),
+                                    flags, width, precision);
+            }
+            break;
+        case 'p':
+            shell_printf_putc(&ctx, '0');
+            shell_printf_putc(&ctx, 'x');
+            shell_printf_number(&ctx, (uint32_t)(uintptr_t)va_arg(ap, void*), 16, flags, width - 2, precision);
+            break;
+        case 'c':
+            if (!(flags & SHELL_PRINTF_LEFT))
+            {
+                shell_printf_pad(&ctx, ' ', width - 1);
+            }
+            shell_printf_putc(&ctx, (char)va_arg(ap, int));
+            if (flags & SHELL_PRINTF_LEFT)
+            {
+                shell_printf_pad(&ctx, ' ', width - 1);
+            }
+            break;
+        case 's':
+            pStr = va_arg(ap, char*);
+            if (!pStr)
+            {
+                pStr = "(null)";
+            }
+            for (len = 0; pStr[len] && ((precision < 0) || (len < precision)); len++)
+            {
+            }
+            if (!(flags & SHELL_PRINTF_LEFT))
+            {
+                shell_printf_pad(&ctx, ' ', width - len);
+            }
+            for (precision = 0; precision < len; precision++)
+            {
+                shell_printf_putc(&ctx, pStr[precision]);
+            }
+            if (flags & SHELL_PRINTF_LEFT)
+            {
+                shell_printf_pad(&ctx, ' ', width - len);
+            }
+            break;
+        case '%':
+            shell_printf_putc(&ctx, '%');
+            break;
+        case '\0':
+            /* Truncated conversion */
+            format--;
+            break;
+        default:
+            shell_printf_putc(&ctx, '%');
+            shell_printf_putc(&ctx, *format);
+            break;
+        }
+        format++;
     }
 
-    return n;
+    va_end(ap);
+
+    shell_writeN(ctx.buf, ctx.len);
+
+    return ctx.total;
 }
 #endif
 
@@ -415,31 +794,28 @@ uint16_t shell_printf(char * format,...)
 uint8_t shell_register_function(cmd_tbl_t * pAddress)
 {
     uint16_t i;
-    /* check name conflict */
-    for (i = 0; i < SHELL_CMD_TBL_SIZE; i++)
+    uint16_t idx;
+
+    /* check name conflict and table full */
+    if (shell_search_command(pAddress->name, &idx) || (mShellCmdCount == SHELL_CMD_TBL_SIZE))
     {
-        if (gpCmdTable[i] && !strcmp(pAddress->name, gpCmdTable[i]->name))
-        {
-            return 1;
-        }
+        return 1;
     }
-    /* insert */
-    for (i = 0; i < SHELL_CMD_TBL_SIZE; i++)
+    /* insert, keeping the table sorted */
+    for (i = mShellCmdCount; i > idx; i--)
     {
-        if (gpCmdTable[i] == NULL)
-        {
-            gpCmdTable[i] =  pAddress;
-            // Update max command length
-            i = strlen(pAddress->name);
-            if (i > mShellMaxCmdLen)
-            {
-                mShellMaxCmdLen = i;
-            }
-
-            return 0;
-        }
+        gpCmdTable[i] = gpCmdTable[i - 1];
     }
-    return 1;
+    gpCmdTable[idx] = pAddress;
+    mShellCmdCount++;
+    // Update max command length
+    i = strlen(pAddress->name);
+    if (i > mShellMaxCmdLen)
+    {
+        mShellMaxCmdLen = i;
+    }
+
+    return 0;
 }
 
 /*! *********************************************************************************
@@ -471,16 +847,19 @@ uint8_t shell_unregister_function(char * name)
 {
     uint16_t i;
 
-    for( i=0; i<SHELL_CMD_TBL_SIZE; i++ )
+    if( !shell_search_command(name, &i) )
     {
-        if( gpCmdTable[i] && !strcmp(name, gpCmdTable[i]->name) )
-        {
-            gpCmdTable[i] = NULL;
-            return 0;
-        }
+        return 1;
+    }
+
+    mShellCmdCount--;
+    for( ; i<mShellCmdCount; i++ )
+    {
+        gpCmdTable[i] = gpCmdTable[i + 1];
     }
+    gpCmdTable[mShellCmdCount] = NULL;
 
-    return 1;
+    return 0;
 }
 
 /*! *********************************************************************************
@@ -538,22 +917,93 @@ cmd_tbl_t * shell_find_command (char * cmd)
 {
     uint16_t i;
 
-    if (!cmd)
+    if (!cmd || !shell_search_command(cmd, &i))
+    {
+        return NULL;
+    }
+
+    return gpCmdTable[i];
+}
+
+/*! *********************************************************************************
+* \brief  This function searches a table of sub-commands sorted by name
+*
+* \param [in]   name       string reprezenting the sub-command
+* \param [in]   pTable     pointer to the table. Each entry starts with a pointer
+*                          to its name, the entries are sorted by name (strcmp order)
+* \param [in]   num        the number of entries
+* \param [in]   entrySize  the size of an entry
+*
+* \return       void*      pointer to the entry, NULL if not found
+*
+********************************************************************************** */
+void * shell_find_subcommand(char * name, const void * pTable, uint16_t num, uint16_t entrySize)
+{
+    const uint8_t *pEntry;
+    uint16_t low = 0;
+    uint16_t high = num;
+    uint16_t mid;
+    int      cmp;
+
+    if (!name)
     {
         return NULL;
     }
 
-    for (i = 0; i < SHELL_CMD_TBL_SIZE; i++)
+    while (low < high)
     {
-        if ((gpCmdTable[i] != NULL) && !strcmp((char*)cmd, gpCmdTable[i]->name))
+        mid = (low + high) / 2;
+        pEntry = (const uint8_t*)pTable + mid * entrySize;
+        cmp = strcmp(name, *(char * const *)pEntry);
+
+        if (cmp == 0)
+        {
+            return (void*)pEntry;
+        }
+        else if (cmp < 0)
+        {
+            high = mid;
+        }
+        else
         {
-            return gpCmdTable[i];
+            low = mid + 1;
         }
     }
 
     return NULL;
 }
 
+/*! *********************************************************************************
+* \brief  This function runs the sub-command named by argv[1]
+*
+* \param [in]   argc    number of arguments of the command
+* \param [in]   argv    arguments of the command, argv[0] is the command name
+* \param [in]   pTable  sub-commands, sorted by name (strcmp order)
+* \param [in]   num     the number of sub-commands
+*
+* \return       int8_t  the status of the sub-command, CMD_RET_USAGE if not found
+*
+* \remarks The sub-command receives the arguments that follow its name.
+*
+********************************************************************************** */
+int8_t shell_exec_subcommand(uint8_t argc, char * argv[], const shell_subcmd_t * pTable, uint16_t num)
+{
+    const shell_subcmd_t *pCmd;
+
+    if (argc < 2)
+    {
+        return CMD_RET_USAGE;
+    }
+
+    pCmd = shell_find_subcommand(argv[1], pTable, num, sizeof(shell_subcmd_t));
+    if (!pCmd)
+    {
+        return CMD_RET_USAGE;
+    }
+
+    return pCmd->cmd(argc - 2, &argv[2]);
+}
+
 /*! *********************************************************************************
 * \brief  This function splits a command string into arguments
 *
@@ -563,11 +1013,19 @@ cmd_tbl_t * shell_find_command (char * cmd)
 *
 * \return       uint8_t     the number of arguments found
 *
+* \remarks Spaces between double quotes belong to the argument, the quotes are
+*          removed. An unterminated quote ends with the string.
+*
 ********************************************************************************** */
 uint8_t make_argv(char *s, uint8_t argvsz, char * argv[])
 {
     uint8_t argc = 0;
-    /* split into argv */
+    char *d;
+    char c;
+    bool_t quoted;
+
+    /* split into argv, in a single pass. The arguments are moved down in
+       place when quotes are removed */
     while (argc < argvsz - 1)
     {
         /* skip any white space */
@@ -577,22 +1035,33 @@ uint8_t make_argv(char *s, uint8_t argvsz, char * argv[])
         }
         if (*s == '\0') /* end of s, no more args   */
         {
-            argv[argc] = NULL;
-            return argc;
+            break;
         }
-        argv[argc++] = s;   /* begin of argument string */
+        d = s;
+        argv[argc++] = d;   /* begin of argument string */
+        quoted = FALSE;
         /* find end of string */
-        while( (*s) && ( *s != ' ' ) )
+        while( (*s) && ( quoted || ( *s != ' ' ) ) )
         {
+            if( *s == '"' )
+            {
+                quoted = !quoted;
+            }
+            else
+            {
+                *d++ = *s;
+            }
             ++s;
         }
-        if (*s == '\0')     /* end of s, no more args   */
+        c = *s;
+        *d = '\0';          /* terminate current arg     */
+        if (c == '\0')      /* end of s, no more args   */
         {
-            argv[argc] = NULL;
-            return argc;
+            break;
         }
-        *s++ = '\0';        /* terminate current arg     */
+        ++s;
     }
+    argv[argc] = NULL;
     return argc;
 }
 
@@ -628,6 +1097,15 @@ static void shell_main( void *params )
     char * argv[SHELL_MAX_ARGS+1];    /* NULL terminated  */
     cmd_tbl_t * cmdtp;
 
+#if SHELL_USE_RPC
+    // Process the received frames, up to the switch to text mode
+    if( shell_rpc_active() && shell_rpc_main() )
+    {
+        shell_flush();
+        return;
+    }
+#endif
+
     // Process the received char
     ret = shell_ProcessChr();
 
@@ -729,6 +1207,16 @@ static void shell_main( void *params )
             pfShellProcessCommand(NULL, 0);
         }
     }
+#if SHELL_USE_RPC
+    else if( shell_rpc_active() )
+    {
+        // ESC 'R' was received, the next chars are frames
+        (void)shell_rpc_main();
+    }
+#endif
+
+    /* Echo, command output and prompt */
+    shell_flush();
 }
 
 /*! *********************************************************************************
@@ -772,6 +1260,14 @@ static int16_t shell_ProcessChr( void )
 //                    esc_save[esc_len] = ichar;
                     esc_len++;
                 }
+#if SHELL_USE_RPC
+                else if (ichar == SHELL_RPC_ESCAPE_CHAR)
+                {
+                    esc_len = 0;
+                    shell_rpc_enter();
+                    return -2;
+                }
+#endif
                 else
                 {
 //                    cread_add_str(esc_save, esc_len, mInsert, &mCmdIdx, &mCmdLen, mCmdBuf, mCmdLen);
@@ -1028,4 +1524,216 @@ static void shell_erase_to_eol(void)
         mCmdLen = mCmdIdx;
     }
 }
+
+/*! *********************************************************************************
+* \brief  Writes N bytes over the serial interface and waits for the transmission
+*
+* \param[in]  pBuff pointer to a string
+* \param[in]  n number of chars to be written
+*
+********************************************************************************** */
+static void shell_send(char *pBuff, uint16_t n)
+{
+#if SHELL_USE_RPC
+    if (shell_rpc_active())
+    {
+        shell_rpc_send(pBuff, n);
+    }
+    else
+#endif
+    if (SHELL_IO_TYPE == gSerialMgrIICSlave_c ||
+        SHELL_IO_TYPE == gSerialMgrSPISlave_c)
+    {
+        uint8_t *pHdr = MEM_BufferAlloc(n+5);
+
+        if (pHdr)
+        {
+            pHdr[0] = 0x02;
+            pHdr[1] = 0x77;
+            pHdr[2] = 0x77;
+            pHdr[3] = n;
+            FLib_MemCpy(&pHdr[4], pBuff, n);
+            pHdr[4+n] = 0;
+            Serial_SyncWrite( gShellSerMgrIf, pHdr, n+5 );
+            MEM_BufferFree(pHdr);
+        }
+    }
+    else
+    {
+        Serial_SyncWrite(gShellSerMgrIf, (uint8_t*)pBuff, n);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Binary search of a command in the sorted command table
+*
+* \param[in]   cmd   string reprezenting the command
+* \param[out]  pIdx  index of the command, or where it should be inserted
+*
+* \return      TRUE if the command is registered
+*
+********************************************************************************** */
+static bool_t shell_search_command(char *cmd, uint16_t *pIdx)
+{
+    uint16_t low = 0;
+    uint16_t high = mShellCmdCount;
+    uint16_t mid;
+    int      cmp;
+
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+        cmp = strcmp(cmd, gpCmdTable[mid]->name);
+
+        if (cmp == 0)
+        {
+            *pIdx = mid;
+            return TRUE;
+        }
+        else if (cmp < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+
+    *pIdx = low;
+    return FALSE;
+}
+
+#if SHELL_TX_BUFFER_SIZE
+/*! *********************************************************************************
+* \brief  Sends the output buffer. Called with the output mutex locked
+*
+********************************************************************************** */
+static void shell_tx_flush(void)
+{
+    if (mShellTxLen)
+    {
+        shell_send(mShellTxBuf, mShellTxLen);
+        mShellTxLen = 0;
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Sends the output buffer SHELL_TX_FLUSH_TIMEOUT ms after its first byte
+*
+* \param[in]  param unused
+*
+********************************************************************************** */
+static void shell_tx_timeout(void *param)
+{
+    (void)param;
+    shell_flush();
+}
+#endif
+
+#if SHELL_USE_PRINTF
+/*! *********************************************************************************
+* \brief  Adds a character to the shell_printf() output, writing the chunk when full
+*
+* \param[in]  pCtx pointer to the shell_printf() output
+* \param[in]  c the character
+*
+********************************************************************************** */
+static void shell_printf_putc(shellPrintfCtx_t *pCtx, char c)
+{
+    if (pCtx->len == SHELL_PRINTF_CHUNK_SIZE)
+    {
+        shell_writeN(pCtx->buf, pCtx->len);
+        pCtx->len = 0;
+    }
+
+    pCtx->buf[pCtx->len++] = c;
+    pCtx->total++;
+}
+
+/*! *********************************************************************************
+* \brief  Adds n times a character to the shell_printf() output
+*
+* \param[in]  pCtx pointer to the shell_printf() output
+* \param[in]  c the character
+* \param[in]  n number of characters, nothing is added if not positive
+*
+********************************************************************************** */
+static void shell_printf_pad(shellPrintfCtx_t *pCtx, char c, int16_t n)
+{
+    while (n-- > 0)
+    {
+        shell_printf_putc(pCtx, c);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Adds a number to the shell_printf() output
+*
+* \param[in]  pCtx pointer to the shell_printf() output
+* \param[in]  nb the absolute value of the number
+* \param[in]  base 8, 10 or 16
+* \param[in]  flags SHELL_PRINTF_xxx
+* \param[in]  width minimum number of characters
+* \param[in]  precision minimum number of digits, -1 if not specified
+*
+********************************************************************************** */
+static void shell_printf_number(shellPrintfCtx_t *pCtx, uint64_t nb, uint8_t base,
+                                uint8_t flags, int16_t width, int16_t precision)
+{
+    const char *pDigits = (flags & SHELL_PRINTF_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    char digits[22];
+    int16_t len = 0;
+    int16_t zeros;
+    uint32_t nb32;
+
+    /* Digits, least significant first. The 64 bit division is a library call,
+       it is only used for the digits above 32 bits */
+    while (nb >> 32)
+    {
+        digits[len++] = pDigits[nb % base];
+        nb /= base;
+    }
+
+    /* A 0 precision prints nothing for 0 */
+    nb32 = (uint32_t)nb;
+    while (nb32 || ((len == 0) && (precision != 0)))
+    {
+        digits[len++] = pDigits[nb32 % base];
+        nb32 /= base;
+    }
+
+    zeros = (precision > len) ? (precision - len) : 0;
+    width -= len + zeros + ((flags & SHELL_PRINTF_SIGNED) ? 1 : 0);
+
+    /* The 0 flag is ignored with a precision or with the - flag */
+    if ((flags & SHELL_PRINTF_ZERO) && !(flags & SHELL_PRINTF_LEFT) && (precision < 0))
+    {
+        zeros += (width > 0) ? width : 0;
+        width = 0;
+    }
+
+    if (!(flags & SHELL_PRINTF_LEFT))
+    {
+        shell_printf_pad(pCtx, ' ', width);
+    }
+
+    if (flags & SHELL_PRINTF_SIGNED)
+    {
+        shell_printf_putc(pCtx, '-');
+    }
+
+    shell_printf_pad(pCtx, '0', zeros);
+
+    while (len)
+    {
+        shell_printf_putc(pCtx, digits[--len]);
+    }
+
+    if (flags & SHELL_PRINTF_LEFT)
+    {
+        shell_printf_pad(pCtx, ' ', width);
+    }
+}
+#endif
 #endif /* SHELL_ENABLED */
\ No newline at end of file
@@ -0,0 +1,503 @@
+/*! *********************************************************************************
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+* All rights reserved.
+*
+* \file
+*
+* This file implements the RPC mode of the shell. The frame format is described
+* in shell.h.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "shell.h"
+#include "FunctionLib.h"
+#include "fsl_os_abstraction.h"
+#include "cobs.h"
+#include "crc16.h"
+#include <string.h>
+
+#if (SHELL_ENABLED && SHELL_USE_RPC)
+
+#if !SHELL_TX_BUFFER_SIZE
+#error "SHELL_USE_RPC requires SHELL_TX_BUFFER_SIZE"
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+/* Largest request: the arguments of a command line */
+#define SHELL_RPC_MAX_REQUEST   (SHELL_RPC_HEADER_SIZE + SHELL_CB_SIZE + SHELL_RPC_CRC_SIZE)
+#define SHELL_RPC_MAX_FRAME     (SHELL_RPC_HEADER_SIZE + SHELL_RPC_MAX_DATA + SHELL_RPC_CRC_SIZE)
+
+/************************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+************************************************************************************/
+static void shell_rpc_process( uint8_t *pFrame, uint16_t length );
+static int8_t shell_rpc_dispatch( uint8_t argc, char * argv[] );
+static const shell_rpc_cmd_t * shell_rpc_find( uint8_t id );
+static void shell_rpc_send_frame( uint8_t type, uint8_t seq, uint8_t id,
+                                  int8_t status, bool_t hasStatus,
+                                  const uint8_t *pData, uint16_t length );
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+extern uint8_t gShellSerMgrIf;
+extern int8_t (*mpfShellBreak)(uint8_t argc, char * argv[]);
+
+static bool_t   mRpcActive = FALSE;
+
+/* Registered command IDs, sorted by ID */
+static const shell_rpc_cmd_t *mpRpcCmds = NULL;
+static uint8_t  mRpcCmdsCount = 0;
+
+/* Received bytes, up to the delimiter. The frame is decoded in place of
+   mRpcRxFrame, one more byte terminates the last argument */
+static uint8_t  mRpcRxBuf[COBS_ENCODED_MAX_SIZE(SHELL_RPC_MAX_REQUEST)];
+static uint16_t mRpcRxLen;
+static bool_t   mRpcRxOverflow;
+static uint8_t  mRpcRxFrame[SHELL_RPC_MAX_REQUEST + 1];
+
+/* Request being executed, its output is sent in OUTPUT frames */
+static bool_t   mRpcInCommand = FALSE;
+static uint8_t  mRpcSeq;
+static uint8_t  mRpcId;
+
+/* ASYNC request, answered by a DONE frame */
+static bool_t   mRpcAsync = FALSE;
+static uint8_t  mRpcAsyncSeq;
+static uint8_t  mRpcAsyncId;
+
+/* Frame being sent */
+static uint8_t      mRpcTxFrame[SHELL_RPC_MAX_FRAME];
+static uint8_t      mRpcTxBuf[COBS_ENCODED_MAX_SIZE(SHELL_RPC_MAX_FRAME) + 1];
+static osaMutexId_t mRpcTxMutexId = NULL;
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  This function registers the command IDs of the RPC mode
+*
+* \param[in]  pTable  pointer to the commands, sorted by ID. The reserved
+*                     SHELL_RPC_ID_xxx IDs must not be used
+* \param[in]  num     the number of entries
+*
+********************************************************************************** */
+void shell_rpc_register(const shell_rpc_cmd_t * pTable, uint8_t num)
+{
+    mpRpcCmds = pTable;
+    mRpcCmdsCount = num;
+}
+
+/*! *********************************************************************************
+* \brief  Tells if the interface is in RPC mode
+*
+* \return  TRUE in RPC mode, FALSE in text mode
+*
+********************************************************************************** */
+bool_t shell_rpc_active(void)
+{
+    return mRpcActive;
+}
+
+/*! *********************************************************************************
+* \brief  Switches to RPC mode, on ESC 'R'
+*
+********************************************************************************** */
+void shell_rpc_enter(void)
+{
+    /* The text written so far is sent as text */
+    shell_flush();
+
+    if( !mRpcTxMutexId )
+    {
+        mRpcTxMutexId = OSA_MutexCreate();
+    }
+
+    mRpcRxLen = 0;
+    mRpcRxOverflow = FALSE;
+    mRpcInCommand = FALSE;
+    mRpcActive = TRUE;
+
+    /* Delimiter: the host decoder drops the text before it */
+    mRpcTxBuf[0] = COBS_DELIMITER;
+    Serial_SyncWrite(gShellSerMgrIf, mRpcTxBuf, 1);
+}
+
+/*! *********************************************************************************
+* \brief  Processes the received bytes in RPC mode
+*
+* \return  TRUE if all the bytes were read, FALSE if the remaining bytes are text
+*
+********************************************************************************** */
+bool_t shell_rpc_main(void)
+{
+    uint16_t wlen;
+    uint8_t  byte;
+    uint32_t length;
+
+    while( mRpcActive )
+    {
+        Serial_Read( gShellSerMgrIf, &byte, 1, &wlen );
+
+        if( !wlen )
+        {
+            return TRUE;
+        }
+
+        if( byte != COBS_DELIMITER )
+        {
+            if( mRpcRxLen < sizeof(mRpcRxBuf) )
+            {
+                mRpcRxBuf[mRpcRxLen++] = byte;
+            }
+            else
+            {
+                mRpcRxOverflow = TRUE;
+            }
+            continue;
+        }
+
+        /* Consecutive delimiters are ignored, the host may use them to resynchronize */
+        if( mRpcRxLen )
+        {
+            length = 0;
+
+            if( !mRpcRxOverflow )
+            {
+                length = cobs_decode(mRpcRxBuf, mRpcRxLen, mRpcRxFrame, SHELL_RPC_MAX_REQUEST);
+            }
+
+            shell_rpc_process(mRpcRxFrame, (uint16_t)length);
+        }
+
+        mRpcRxLen = 0;
+        mRpcRxOverflow = FALSE;
+    }
+
+    return FALSE;
+}
+
+/*! *********************************************************************************
+* \brief  Sends the shell output in RPC mode
+*
+* \param[in]  pBuff pointer to the output
+* \param[in]  n number of bytes
+*
+* \remarks The output of a request is sent in OUTPUT frames, the rest in EVENT
+*          frames.
+*
+********************************************************************************** */
+void shell_rpc_send(char *pBuff, uint16_t n)
+{
+    uint16_t length;
+
+    while( n )
+    {
+        length = (n > SHELL_RPC_MAX_DATA) ? SHELL_RPC_MAX_DATA : n;
+
+        if( mRpcInCommand )
+        {
+            shell_rpc_send_frame(SHELL_RPC_OUTPUT, mRpcSeq, mRpcId, 0, FALSE, (uint8_t*)pBuff, length);
+        }
+        else
+        {
+            shell_rpc_send_frame(SHELL_RPC_EVENT, 0, 0, 0, FALSE, (uint8_t*)pBuff, length);
+        }
+
+        pBuff += length;
+        n -= length;
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Sends the DONE frame of the ASYNC request, from shell_cmd_finished()
+*
+********************************************************************************** */
+void shell_rpc_cmd_finished(void)
+{
+    /* Output of the command first */
+    shell_flush();
+
+    if( mRpcAsync )
+    {
+        mRpcAsync = FALSE;
+        shell_rpc_send_frame(SHELL_RPC_DONE, mRpcAsyncSeq, mRpcAsyncId, CMD_RET_SUCCESS, TRUE, NULL, 0);
+    }
+}
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  Checks and executes a request
+*
+* \param[in]  pFrame  the decoded frame, with room for one more byte
+* \param[in]  length  the length of the frame, 0 if it could not be decoded
+*
+********************************************************************************** */
+static void shell_rpc_process(uint8_t *pFrame, uint16_t length)
+{
+    char * argv[SHELL_MAX_ARGS+1];    /* NULL terminated  */
+    const shell_rpc_cmd_t *pCmd;
+    uint8_t  argc = 0;
+    uint8_t  seq;
+    uint8_t  id;
+    uint16_t dataLen;
+    uint16_t crc;
+    uint8_t  *pData = &pFrame[SHELL_RPC_HEADER_SIZE];
+    uint8_t  *pEnd;
+    int8_t   status;
+
+    if( length < SHELL_RPC_HEADER_SIZE + SHELL_RPC_CRC_SIZE )
+    {
+        shell_rpc_send_frame(SHELL_RPC_ERROR, 0, 0, SHELL_RPC_STATUS_BAD_FRAME, TRUE, NULL, 0);
+        return;
+    }
+
+    seq = pFrame[1];
+    id = pFrame[2];
+    dataLen = (uint16_t)pFrame[3] | ((uint16_t)pFrame[4] << 8);
+    crc = (uint16_t)pFrame[length - 2] | ((uint16_t)pFrame[length - 1] << 8);
+
+    if( (pFrame[0] != SHELL_RPC_REQUEST) ||
+        (dataLen != length - SHELL_RPC_HEADER_SIZE - SHELL_RPC_CRC_SIZE) ||
+        (crc != crc16_ccitt(pFrame, length - SHELL_RPC_CRC_SIZE)) )
+    {
+        shell_rpc_send_frame(SHELL_RPC_ERROR, seq, id, SHELL_RPC_STATUS_BAD_FRAME, TRUE, NULL, 0);
+        return;
+    }
+
+    switch( id )
+    {
+    case SHELL_RPC_ID_TEXT:
+        shell_rpc_send_frame(SHELL_RPC_RESPONSE, seq, id, CMD_RET_SUCCESS, TRUE, NULL, 0);
+        mRpcActive = FALSE;
+        shell_refresh();
+        return;
+
+    case SHELL_RPC_ID_PING:
+        shell_rpc_send_frame(SHELL_RPC_RESPONSE, seq, id, CMD_RET_SUCCESS, TRUE, pData, dataLen);
+        return;
+
+    case SHELL_RPC_ID_BREAK:
+        if( mpfShellBreak )
+        {
+            mpfShellBreak(0, 0);
+            mpfShellBreak = NULL;
+        }
+        mRpcAsync = FALSE;
+        shell_rpc_send_frame(SHELL_RPC_RESPONSE, seq, id, CMD_RET_SUCCESS, TRUE, NULL, 0);
+        return;
+
+    case SHELL_RPC_ID_COMMAND_LINE:
+        pData[dataLen] = '\0';
+        argc = make_argv((char*)pData, SHELL_MAX_ARGS+1, argv);
+        status = (argc >= SHELL_MAX_ARGS) ? SHELL_RPC_STATUS_BAD_ARGS : CMD_RET_SUCCESS;
+        break;
+
+    default:
+        pCmd = shell_rpc_find(id);
+        if( !pCmd )
+        {
+            shell_rpc_send_frame(SHELL_RPC_RESPONSE, seq, id, SHELL_RPC_STATUS_UNKNOWN_ID, TRUE, NULL, 0);
+            return;
+        }
+
+        argv[argc++] = pCmd->name;
+        if( pCmd->subcmd )
+        {
+            argv[argc++] = pCmd->subcmd;
+        }
+
+        /* Arguments, each terminated by '\0'. The last one may be unterminated */
+        status = CMD_RET_SUCCESS;
+        pData[dataLen] = '\0';
+        pEnd = &pData[dataLen];
+        while( pData < pEnd )
+        {
+            if( argc == SHELL_MAX_ARGS )
+            {
+                status = SHELL_RPC_STATUS_BAD_ARGS;
+                break;
+            }
+            argv[argc++] = (char*)pData;
+            pData += strlen((char*)pData) + 1;
+        }
+        argv[argc] = NULL;
+        break;
+    }
+
+    if( status == CMD_RET_SUCCESS )
+    {
+        mRpcInCommand = TRUE;
+        mRpcSeq = seq;
+        mRpcId = id;
+
+        status = shell_rpc_dispatch(argc, argv);
+
+        /* The output is sent before the response */
+        shell_flush();
+        mRpcInCommand = FALSE;
+
+        if( status == CMD_RET_ASYNC )
+        {
+            mRpcAsync = TRUE;
+            mRpcAsyncSeq = seq;
+            mRpcAsyncId = id;
+        }
+    }
+
+    shell_rpc_send_frame(SHELL_RPC_RESPONSE, seq, id, status, TRUE, NULL, 0);
+}
+
+/*! *********************************************************************************
+* \brief  Executes a command, as shell_main() does in text mode
+*
+* \param [in]   argc    number of arguments
+* \param [in]   argv    pointer to the argument vector
+*
+* \return       int8_t  command status (command_ret_t)
+*
+********************************************************************************** */
+static int8_t shell_rpc_dispatch(uint8_t argc, char * argv[])
+{
+    cmd_tbl_t * cmdtp = shell_find_command(argv[0]);
+    int8_t ret;
+
+    if( (cmdtp == NULL) || (cmdtp->cmd == NULL) )
+    {
+        return SHELL_RPC_STATUS_UNKNOWN_ID;
+    }
+
+    if( argc > cmdtp->maxargs )
+    {
+        return CMD_RET_USAGE;
+    }
+
+    ret = (cmdtp->cmd)(argc, argv);
+    mpfShellBreak = (ret == CMD_RET_ASYNC) ? cmdtp->cmd : NULL;
+
+    return ret;
+}
+
+/*! *********************************************************************************
+* \brief  Binary search of a registered command ID
+*
+* \param [in]   id      the command ID
+*
+* \return       pointer to the command, NULL if not registered
+*
+********************************************************************************** */
+static const shell_rpc_cmd_t * shell_rpc_find(uint8_t id)
+{
+    uint8_t low = 0;
+    uint8_t high = mRpcCmdsCount;
+    uint8_t mid;
+
+    while( low < high )
+    {
+        mid = (low + high) / 2;
+
+        if( mpRpcCmds[mid].id == id )
+        {
+            return &mpRpcCmds[mid];
+        }
+        else if( id < mpRpcCmds[mid].id )
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+
+    return NULL;
+}
+
+/*! *********************************************************************************
+* \brief  Builds, encodes and sends a frame
+*
+* \param[in]  type       SHELL_RPC_xxx frame type
+* \param[in]  seq        sequence number of the request
+* \param[in]  id         command ID of the request
+* \param[in]  status     command_ret_t status
+* \param[in]  hasStatus  TRUE if the status is the first data byte
+* \param[in]  pData      pointer to the data
+* \param[in]  length     number of data bytes, at most SHELL_RPC_MAX_DATA with the status
+*
+********************************************************************************** */
+static void shell_rpc_send_frame(uint8_t type, uint8_t seq, uint8_t id,
+                                 int8_t status, bool_t hasStatus,
+                                 const uint8_t *pData, uint16_t length)
+{
+    uint16_t size = SHELL_RPC_HEADER_SIZE;
+    uint16_t crc;
+    uint32_t encoded;
+
+    if( length > SHELL_RPC_MAX_DATA - (hasStatus ? 1 : 0) )
+    {
+        length = SHELL_RPC_MAX_DATA - (hasStatus ? 1 : 0);
+    }
+
+    if( mRpcTxMutexId )
+    {
+        (void)OSA_MutexLock(mRpcTxMutexId, osaWaitForever_c);
+    }
+
+    mRpcTxFrame[0] = type;
+    mRpcTxFrame[1] = seq;
+    mRpcTxFrame[2] = id;
+
+    if( hasStatus )
+    {
+        mRpcTxFrame[size++] = (uint8_t)status;
+    }
+    if( length )
+    {
+        FLib_MemCpy(&mRpcTxFrame[size], (void*)pData, length);
+        size += length;
+    }
+
+    mRpcTxFrame[3] = (uint8_t)(size - SHELL_RPC_HEADER_SIZE);
+    mRpcTxFrame[4] = (uint8_t)((size - SHELL_RPC_HEADER_SIZE) >> 8);
+
+    crc = crc16_ccitt(mRpcTxFrame, size);
+    mRpcTxFrame[size++] = (uint8_t)crc;
+    mRpcTxFrame[size++] = (uint8_t)(crc >> 8);
+
+    encoded = cobs_encode(mRpcTxFrame, size, mRpcTxBuf);
+    mRpcTxBuf[encoded++] = COBS_DELIMITER;
+    Serial_SyncWrite(gShellSerMgrIf, mRpcTxBuf, (uint16_t)encoded);
+
+    if( mRpcTxMutexId )
+    {
+        (void)OSA_MutexUnlock(mRpcTxMutexId);
+    }
+}
+#endif /* SHELL_ENABLED && SHELL_USE_RPC */
+
+ /*******************************************************************************
+ * EOF
+ ******************************************************************************/
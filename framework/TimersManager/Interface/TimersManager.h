@@ -76,6 +76,56 @@
 #define gTMR_EnableMinutesSecondsTimers_d   (1)
 #endif
 
+/*
+ * \brief   Keeps the active timers in a binary min-heap ordered by absolute expiry
+ *          time, instead of counting down every timer on each run of the timer
+ *          thread. The next expiry is found in constant time; starting, stopping
+ *          or expiring a timer costs O(log n). Supports up to 255 timers
+ *          (gTmrTotalTimers_c): timer IDs are 8-bit with 0xFF reserved for
+ *          gTmrInvalidTimerID_c, and the heap positions are 8-bit as well.
+ * VALID RANGE: TRUE/FALSE
+ */
+#ifndef gTMR_EnableHeapScheduler_d
+#define gTMR_EnableHeapScheduler_d    (0)
+#endif
+
+/*
+ * \brief   Enables TMR_StartTimerWithSlack(). A timer started with a slack may
+ *          expire up to slack milliseconds late, so that it shares the wakeup
+ *          of another timer instead of causing its own.
+ * VALID RANGE: TRUE/FALSE
+ */
+#ifndef gTMR_EnableTimerSlack_d
+#define gTMR_EnableTimerSlack_d    (0)
+#endif
+
+/*
+ * \brief   Records, for every timer, how late its callbacks run after the nominal
+ *          expiry time and how long they execute, and a histogram of the lateness
+ *          of all the callbacks. See TMR_GetLatencyStats().
+ * VALID RANGE: TRUE/FALSE
+ */
+#ifndef gTMR_EnableLatencyStats_d
+#define gTMR_EnableLatencyStats_d    (0)
+#endif
+
+/*
+ * \brief   Number of bins of the lateness histogram. The first bin counts the
+ *          callbacks late by less than gTMR_LatencyHistogramBaseUs_c, each
+ *          following bin doubles the limit and the last one counts the rest.
+ * VALID RANGE: 2..16
+ */
+#ifndef gTMR_LatencyHistogramBins_c
+#define gTMR_LatencyHistogramBins_c    (8)
+#endif
+
+/*
+ * \brief   Upper limit of the first bin of the lateness histogram, in microseconds
+ */
+#ifndef gTMR_LatencyHistogramBaseUs_c
+#define gTMR_LatencyHistogramBaseUs_c  (250)
+#endif
+
 /*
  * \brief   Number of timers needed by the application
  * VALID RANGE: user defined
@@ -218,6 +268,25 @@ typedef uint8_t     tmrTimerType_t;
  */
 typedef void ( *pfTmrCallBack_t ) ( void * param );
 
+#if gTMR_EnableLatencyStats_d
+/*
+ * \brief   Latency statistics of a timer, in microseconds. The lateness is the
+ *          time from the nominal expiry of the timer to the start of its
+ *          callback, slack included.
+ */
+typedef struct tmrLatencyStats_tag
+{
+    pfTmrCallBack_t callback;
+    uint32_t        expirations;
+    uint32_t        latenessMinUs;
+    uint32_t        latenessAvgUs;
+    uint32_t        latenessMaxUs;
+    uint32_t        callbackMinUs;
+    uint32_t        callbackAvgUs;
+    uint32_t        callbackMaxUs;
+} tmrLatencyStats_t;
+#endif
+
 
 /*****************************************************************************
 ******************************************************************************
@@ -360,6 +429,85 @@ tmrErrCode_t TMR_StartTimer
     void *param
 );
 
+/*! -------------------------------------------------------------------------
+ * \brief     Start a specified timer that tolerates a late expiry
+ *
+ * \param[in] timerId - the ID of the timer
+ * \param[in] timerType - the type of the timer
+ * \param[in] timeInMilliseconds - time expressed in millisecond units
+ * \param[in] slackInMilliseconds - how late the timer may expire, in
+ *                                  millisecond units
+ * \param[in] pfTmrCallBack - callback function
+ * \param[in] param - parameter to callback function
+ *
+ * \return    the error code
+ * \details   Same as TMR_StartTimer(), but the timer expires anywhere from
+ *            timeInMilliseconds to timeInMilliseconds + slackInMilliseconds,
+ *            together with the first other timer that wakes up the timer
+ *            thread in that window. Interval timers get the same slack on every
+ *            period. Without gTMR_EnableTimerSlack_d the slack is ignored.
+ *---------------------------------------------------------------------------*/
+tmrErrCode_t TMR_StartTimerWithSlack
+(
+    tmrTimerID_t timerID,
+    tmrTimerType_t timerType,
+    tmrTimeInMilliseconds_t timeInMilliseconds,
+    tmrTimeInMilliseconds_t slackInMilliseconds,
+    pfTmrCallBack_t callback,
+    void *param
+);
+
+/*! -------------------------------------------------------------------------
+ * \brief     Returns the number of timer expirations that were served by the
+ *            wakeup of another timer, before their own deadline. Each one is
+ *            a wakeup of the timer thread saved by the timer slack.
+ *
+ * \return    number of saved wakeups since TMR_Init()
+ *---------------------------------------------------------------------------*/
+#if gTMR_EnableTimerSlack_d
+uint32_t TMR_GetSavedWakeups
+(
+    void
+);
+#endif
+
+#if gTMR_EnableLatencyStats_d
+/*! -------------------------------------------------------------------------
+ * \brief     Get the latency statistics of a timer
+ *
+ * \param[in]  timerID - the ID of the timer
+ * \param[out] pStats - the statistics
+ *
+ * \return    TRUE if the timer expired at least once since it was allocated
+ *            or since TMR_ResetLatencyStats(), FALSE otherwise
+ *---------------------------------------------------------------------------*/
+bool_t TMR_GetLatencyStats
+(
+    tmrTimerID_t timerID,
+    tmrLatencyStats_t *pStats
+);
+
+/*! -------------------------------------------------------------------------
+ * \brief     Get the lateness histogram of all the timer callbacks
+ *
+ * \param[out] pHistogram - gTMR_LatencyHistogramBins_c counters. Bin i < last
+ *                          counts the callbacks late by less than
+ *                          gTMR_LatencyHistogramBaseUs_c << i microseconds.
+ *---------------------------------------------------------------------------*/
+void TMR_GetLatencyHistogram
+(
+    uint32_t *pHistogram
+);
+
+/*! -------------------------------------------------------------------------
+ * \brief     Clear the latency statistics of all the timers
+ *---------------------------------------------------------------------------*/
+void TMR_ResetLatencyStats
+(
+    void
+);
+#endif
+
 /*! -------------------------------------------------------------------------
  * \brief   Start a low power timer. When the timer goes off, call the
  *              callback function in non-interrupt context.
@@ -635,6 +783,7 @@ uint64_t TMR_GetTimestamp(void);
 #define TMR_FreeTimer(timerID)      0
 #define TMR_IsTimerActive(timerID)  0
 #define TMR_StartTimer(timerID,timerType,timeInMilliseconds, pfTimerCallBack, param) 0
+#define TMR_StartTimerWithSlack(timerID,timerType,timeInMilliseconds,slackInMilliseconds,pfTimerCallBack,param) 0
 #define TMR_StartLowPowerTimer(timerId,timerType,timeIn,pfTmrCallBack,param) 0
 #if gTMR_EnableMinutesSecondsTimers_d
 #define TMR_StartMinuteTimer(timerId,timeInMinutes,pfTmrCallBack,param) 0
@@ -662,6 +811,9 @@ uint64_t TMR_GetTimestamp(void);
 #define TMR_StopSecondTimer(timerID)  TMR_StopTimer(timerID)
 #define TMR_TimeStampInit()
 #define TMR_GetTimestamp()                          0
+#define TMR_GetLatencyStats(timerID,pStats)         FALSE
+#define TMR_GetLatencyHistogram(pHistogram)
+#define TMR_ResetLatencyStats()
 
 #endif /* gTMR_Enabled_d */
 
@@ -30,6 +30,15 @@
 *****************************************************************************/
 #define mTmrDummyEvent_c (1<<16)
 
+#if gTMR_EnableTimerSlack_d
+#define mTmrSlack_m(timerID)    (maTmrTimerTable[(timerID)].slackTicks)
+#else
+#define mTmrSlack_m(timerID)    (0)
+#endif
+
+/* The heap is ordered on the latest time each timer may expire */
+#define mTmrHeapKey_m(timerID)  (maTmrTimerTable[(timerID)].expireTicks + mTmrSlack_m(timerID))
+
 #if gTMR_PIT_Timestamp_Enabled_d
     #define mTMR_PIT_Timestamp_Enabled_d (FSL_FEATURE_PIT_HAS_CHAIN_MODE)
 #endif
@@ -110,7 +119,82 @@ static void TMR_SetTimerType
     tmrTimerType_t type
 );
 
+#if gTMR_EnableHeapScheduler_d
+/*! -------------------------------------------------------------------------
+ * \brief     Returns the current time on the 64-bit time base of the heap
+ *            scheduler. Must be called with interrupts disabled.
+ * \return    current time in ticks
+ *---------------------------------------------------------------------------*/
+static tmrTimerTicks64_t TMR_HeapNow
+(
+    void
+);
+
+/*! -------------------------------------------------------------------------
+ * \brief     Moves a timer up the heap, from a free position, to its place
+ * \param[in] index - free heap position to start from
+ * \param[in] timerID - the timer ID
+ *---------------------------------------------------------------------------*/
+static void TMR_HeapSiftUp
+(
+    uint8_t index,
+    tmrTimerID_t timerID
+);
+
+/*! -------------------------------------------------------------------------
+ * \brief     Moves a timer down the heap, from a free position, to its place
+ * \param[in] index - free heap position to start from
+ * \param[in] timerID - the timer ID
+ *---------------------------------------------------------------------------*/
+static void TMR_HeapSiftDown
+(
+    uint8_t index,
+    tmrTimerID_t timerID
+);
 
+/*! -------------------------------------------------------------------------
+ * \brief     Removes an active timer from the heap
+ * \param[in] timerID - the timer ID
+ *---------------------------------------------------------------------------*/
+static void TMR_HeapRemove
+(
+    tmrTimerID_t timerID
+);
+#endif /*gTMR_EnableHeapScheduler_d*/
+
+#if gTMR_EnableLatencyStats_d
+/*! -------------------------------------------------------------------------
+ * \brief     Clears the latency statistics of a timer
+ * \param[in] timerID - the timer ID
+ *---------------------------------------------------------------------------*/
+static void TMR_LatencyClear
+(
+    tmrTimerID_t timerID
+);
+
+/*! -------------------------------------------------------------------------
+ * \brief     Runs the callback of an expired timer and records its latency
+ * \param[in] timerID - the timer ID
+ * \param[in] pfCallBack - the callback of the timer
+ * \param[in] latenessTicks - time since the nominal expiry of the timer
+ *---------------------------------------------------------------------------*/
+static void TMR_LatencyCallBack
+(
+    tmrTimerID_t timerID,
+    pfTmrCallBack_t pfCallBack,
+    tmrTimerTicks_t latenessTicks
+);
+
+/*! -------------------------------------------------------------------------
+ * \brief     Converts ticks to microseconds
+ * \param[in] ticks - number of ticks
+ * \return    number of microseconds
+ *---------------------------------------------------------------------------*/
+static uint64_t TMR_LatencyTicksToUs
+(
+    tmrTimerTicks64_t ticks
+);
+#endif /*gTMR_EnableLatencyStats_d*/
 
 /*! -------------------------------------------------------------------------
  * \brief Function called by driver ISR on channel match in interrupt context.
@@ -222,6 +306,68 @@ static uint8_t numberOfLowPowerActiveTimers = 0;
  */
 static bool_t timerHardwareIsRunning = FALSE;
 
+#if gTMR_EnableHeapScheduler_d
+/* tmrTimerID_t is 8-bit and 0xFF is gTmrInvalidTimerID_c, so 255 timers is
+   also the most TMR_AllocateTimer() can hand out; mTmrHeapSize and heapIndex
+   are sized for it. */
+#if (gTmrTotalTimers_c) > 255
+#error "The heap scheduler supports up to 255 timers"
+#endif
+
+/*
+ * \brief Active timers, ordered as a binary min-heap on expireTicks.
+ *              maTmrHeap[0] is the next timer to expire.
+ * VALUES: timer IDs
+ */
+static tmrTimerID_t maTmrHeap[gTmrTotalTimers_c];
+
+/*
+ * \brief Number of timers in the heap
+ * VALUES: 0..gTmrTotalTimers_c
+ */
+static uint8_t mTmrHeapSize = 0;
+
+/*
+ * \brief Time in ticks at previousTimeInTicks, extended to 64 bits.
+ *              It does not advance while no timer is active.
+ * VALUES: tmrTimerTicks64_t range
+ */
+static tmrTimerTicks64_t mTmrHeapTime = 0;
+#endif /*gTMR_EnableHeapScheduler_d*/
+
+#if gTMR_EnableTimerSlack_d
+/*
+ * \brief Number of expirations served by the wakeup of another timer,
+ *              before their own deadline
+ * VALUES: 0..0xFFFFFFFF
+ */
+static uint32_t mTmrSavedWakeups = 0;
+#endif
+
+#if gTMR_EnableLatencyStats_d
+#if (gTMR_LatencyHistogramBins_c < 2) || (gTMR_LatencyHistogramBins_c > 16)
+#error "gTMR_LatencyHistogramBins_c must be 2 to 16"
+#endif
+
+/*
+ * \brief Latency statistics of the timers, indexed by timer ID
+ * VALUES: see definition
+ */
+static tmrLatencyEntry_t maTmrLatencyTable[gTmrTotalTimers_c];
+
+/*
+ * \brief Lateness histogram of all the timer callbacks
+ * VALUES: 0..0xFFFFFFFF
+ */
+static uint32_t maTmrLatencyHistogram[gTMR_LatencyHistogramBins_c];
+
+/*
+ * \brief Upper limits of the histogram bins, except the last one, in ticks
+ * VALUES: tmrTimerTicks_t range
+ */
+static tmrTimerTicks_t maTmrLatencyBinTicks[gTMR_LatencyHistogramBins_c - 1];
+#endif /*gTMR_EnableLatencyStats_d*/
+
 
 
 #if defined(FWK_SMALL_RAM_CONFIG)
@@ -353,6 +499,207 @@ static void TMR_SetTimerType
     maTmrTimerStatusTable[timerID] = (tmrStatus_t)(maTmrTimerStatusTable[timerID] & (tmrStatus_t)(~mTimerType_c)) | type;
 }
 
+#if gTMR_EnableHeapScheduler_d
+/*! -------------------------------------------------------------------------
+* \brief     Returns the current time on the 64-bit time base of the heap
+*            scheduler. Must be called with interrupts disabled.
+* \return    current time in ticks
+*---------------------------------------------------------------------------*/
+static tmrTimerTicks64_t TMR_HeapNow
+(
+    void
+)
+{
+    return mTmrHeapTime + (tmrTimerTicks_t)(StackTimer_GetCounterValue() - previousTimeInTicks);
+}
+
+/*! -------------------------------------------------------------------------
+* \brief     Moves a timer up the heap, from a free position, to its place
+* \param[in] index - free heap position to start from
+* \param[in] timerID - the timer ID
+*---------------------------------------------------------------------------*/
+static void TMR_HeapSiftUp
+(
+    uint8_t index,
+    tmrTimerID_t timerID
+)
+{
+    uint8_t parent;
+
+    while( index > 0 )
+    {
+        parent = (index - 1) >> 1;
+
+        if( mTmrHeapKey_m(maTmrHeap[parent]) <= mTmrHeapKey_m(timerID) )
+        {
+            break;
+        }
+
+        maTmrHeap[index] = maTmrHeap[parent];
+        maTmrTimerTable[maTmrHeap[index]].heapIndex = index;
+        index = parent;
+    }
+
+    maTmrHeap[index] = timerID;
+    maTmrTimerTable[timerID].heapIndex = index;
+}
+
+/*! -------------------------------------------------------------------------
+* \brief     Moves a timer down the heap, from a free position, to its place
+* \param[in] index - free heap position to start from
+* \param[in] timerID - the timer ID
+*---------------------------------------------------------------------------*/
+static void TMR_HeapSiftDown
+(
+    uint8_t index,
+    tmrTimerID_t timerID
+)
+{
+    uint32_t child;
+
+    while( (child = 2 * (uint32_t)index + 1) < mTmrHeapSize )
+    {
+        if( (child + 1 < mTmrHeapSize) &&
+            (mTmrHeapKey_m(maTmrHeap[child + 1]) < mTmrHeapKey_m(maTmrHeap[child])) )
+        {
+            child++;
+        }
+
+        if( mTmrHeapKey_m(timerID) <= mTmrHeapKey_m(maTmrHeap[child]) )
+        {
+            break;
+        }
+
+        maTmrHeap[index] = maTmrHeap[child];
+        maTmrTimerTable[maTmrHeap[index]].heapIndex = index;
+        index = child;
+    }
+
+    maTmrHeap[index] = timerID;
+    maTmrTimerTable[timerID].heapIndex = index;
+}
+
+/*! -------------------------------------------------------------------------
+* \brief     Removes an active timer from the heap
+* \param[in] timerID - the timer ID
+*---------------------------------------------------------------------------*/
+static void TMR_HeapRemove
+(
+    tmrTimerID_t timerID
+)
+{
+    uint8_t index = maTmrTimerTable[timerID].heapIndex;
+    tmrTimerID_t lastID = maTmrHeap[--mTmrHeapSize];
+
+    if( lastID != timerID )
+    {
+        /* Move the last timer to the free position, then restore the heap order */
+        if( (index > 0) &&
+            (mTmrHeapKey_m(lastID) < mTmrHeapKey_m(maTmrHeap[(index - 1) >> 1])) )
+        {
+            TMR_HeapSiftUp(index, lastID);
+        }
+        else
+        {
+            TMR_HeapSiftDown(index, lastID);
+        }
+    }
+}
+#endif /*gTMR_EnableHeapScheduler_d*/
+
+#if gTMR_EnableLatencyStats_d
+/*! -------------------------------------------------------------------------
+* \brief     Clears the latency statistics of a timer
+* \param[in] timerID - the timer ID
+*---------------------------------------------------------------------------*/
+static void TMR_LatencyClear
+(
+    tmrTimerID_t timerID
+)
+{
+    tmrLatencyEntry_t *pEntry = &maTmrLatencyTable[timerID];
+
+    pEntry->expirations = 0;
+    pEntry->latenessMin = (tmrTimerTicks_t)~0;
+    pEntry->latenessMax = 0;
+    pEntry->latenessSum = 0;
+    pEntry->callbackMin = (tmrTimerTicks_t)~0;
+    pEntry->callbackMax = 0;
+    pEntry->callbackSum = 0;
+}
+
+/*! -------------------------------------------------------------------------
+* \brief     Runs the callback of an expired timer and records its latency.
+*            Called from the timer thread with interrupts enabled.
+* \param[in] timerID - the timer ID
+* \param[in] pfCallBack - the callback of the timer
+* \param[in] latenessTicks - time since the nominal expiry of the timer
+*---------------------------------------------------------------------------*/
+static void TMR_LatencyCallBack
+(
+    tmrTimerID_t timerID,
+    pfTmrCallBack_t pfCallBack,
+    tmrTimerTicks_t latenessTicks
+)
+{
+    tmrLatencyEntry_t *pEntry = &maTmrLatencyTable[timerID];
+    tmrTimerTicks_t callbackTicks = StackTimer_GetCounterValue();
+    uint8_t bin = 0;
+
+    pfCallBack(maTmrTimerTable[timerID].param);
+
+    callbackTicks = StackTimer_GetCounterValue() - callbackTicks;
+
+    while( (bin < (gTMR_LatencyHistogramBins_c - 1)) && (latenessTicks >= maTmrLatencyBinTicks[bin]) )
+    {
+        bin++;
+    }
+
+    TmrIntDisableAll();
+
+    pEntry->expirations++;
+    pEntry->latenessSum += latenessTicks;
+    pEntry->callbackSum += callbackTicks;
+
+    if( latenessTicks < pEntry->latenessMin )
+    {
+        pEntry->latenessMin = latenessTicks;
+    }
+
+    if( latenessTicks > pEntry->latenessMax )
+    {
+        pEntry->latenessMax = latenessTicks;
+    }
+
+    if( callbackTicks < pEntry->callbackMin )
+    {
+        pEntry->callbackMin = callbackTicks;
+    }
+
+    if( callbackTicks > pEntry->callbackMax )
+    {
+        pEntry->callbackMax = callbackTicks;
+    }
+
+    maTmrLatencyHistogram[bin]++;
+
+    TmrIntRestoreAll();
+}
+
+/*! -------------------------------------------------------------------------
+* \brief     Converts ticks to microseconds
+* \param[in] ticks - number of ticks
+* \return    number of microseconds
+*---------------------------------------------------------------------------*/
+static uint64_t TMR_LatencyTicksToUs
+(
+    tmrTimerTicks64_t ticks
+)
+{
+    return ticks * 1000000 / mCounterFreqHz;
+}
+#endif /*gTMR_EnableLatencyStats_d*/
+
 #endif /*gTMR_Enabled_d*/
 
 
@@ -472,6 +819,21 @@ void TMR_NotifyClkChanged
     mMaxToCountDown_c = gStackTimerMaxCountValue_c - TmrTicksFromMilliseconds(8);
     /* The TMR_Task()event will not be issued faster than 4ms*/
     mTicksFor4ms = TmrTicksFromMilliseconds(4);
+
+#if gTMR_EnableLatencyStats_d
+    {
+        uint8_t bin;
+
+        for( bin = 0; bin < (gTMR_LatencyHistogramBins_c - 1); bin++ )
+        {
+            maTmrLatencyBinTicks[bin] = (tmrTimerTicks_t)
+                (((tmrTimerTicks64_t)gTMR_LatencyHistogramBaseUs_c << bin) * mCounterFreqHz / 1000000);
+        }
+    }
+
+    /* The statistics are kept in ticks of the previous clock */
+    TMR_ResetLatencyStats();
+#endif
 }
 
 /*! -------------------------------------------------------------------------
@@ -491,6 +853,9 @@ tmrTimerID_t TMR_AllocateTimer
         if (!TMR_IsTimerAllocated(i))
         {
             TMR_SetTimerStatus(i, mTmrStatusInactive_c);
+#if gTMR_EnableLatencyStats_d
+            TMR_LatencyClear(i);
+#endif
             id = i;
             break;
         }
@@ -582,6 +947,29 @@ uint32_t TMR_GetRemainingTime
     tmrTimerID_t tmrID
 )
 {
+#if gTMR_EnableHeapScheduler_d
+    tmrTimerTicks64_t currentTime;
+    uint32_t remainingTime = 0;
+    uint32_t freq = mCounterFreqHz;
+
+    if( (tmrID < gTmrTotalTimers_c) && TMR_IsTimerActive(tmrID) )
+    {
+        TmrIntDisableAll();
+
+        currentTime = TMR_HeapNow();
+
+        if( currentTime > maTmrTimerTable[tmrID].expireTicks )
+        {
+            remainingTime = 1;
+        }
+        else
+        {
+            remainingTime = ((maTmrTimerTable[tmrID].expireTicks - currentTime) * 1000 + freq - 1) / freq;
+        }
+
+        TmrIntRestoreAll();
+    }
+#else
     tmrTimerTicks_t currentTime;
     tmrTimerTicks_t elapsedRemainingTicks;
     uint32_t remainingTime;
@@ -616,6 +1004,7 @@ uint32_t TMR_GetRemainingTime
 
         TmrIntRestoreAll();
     }
+#endif /*gTMR_EnableHeapScheduler_d*/
 
     return remainingTime;
 }
@@ -629,6 +1018,41 @@ uint32_t TMR_GetRemainingTime
 uint32_t TMR_GetFirstExpireTime(tmrTimerType_t timerType)
 {
     uint32_t min = 0xFFFFFFFF;
+#if gTMR_EnableHeapScheduler_d
+    tmrTimerID_t firstID = gTmrInvalidTimerID_c;
+    tmrTimerID_t timerID;
+    uint32_t i;
+
+    TmrIntDisableAll();
+
+    /* Without slack the root of the heap expires first, and the other timers
+       are only looked at when it is not of the requested type */
+    for( i = 0; i < mTmrHeapSize; ++i )
+    {
+        timerID = maTmrHeap[i];
+
+        if( (timerType & TMR_GetTimerType(timerID)) &&
+            ((firstID == gTmrInvalidTimerID_c) ||
+             (maTmrTimerTable[timerID].expireTicks < maTmrTimerTable[firstID].expireTicks)) )
+        {
+            firstID = timerID;
+
+#if !gTMR_EnableTimerSlack_d
+            if( i == 0 )
+            {
+                break;
+            }
+#endif
+        }
+    }
+
+    TmrIntRestoreAll();
+
+    if( firstID != gTmrInvalidTimerID_c )
+    {
+        min = TMR_GetRemainingTime(firstID);
+    }
+#else
     uint32_t remainingTime;
     uint32_t timerID;
 
@@ -644,6 +1068,7 @@ uint32_t TMR_GetFirstExpireTime(tmrTimerType_t timerType)
             }
         }
     }
+#endif /*gTMR_EnableHeapScheduler_d*/
 
     return min;
 }
@@ -690,8 +1115,37 @@ tmrErrCode_t TMR_StartTimer
     pfTmrCallBack_t callback,
     void *param
 )
+{
+    return TMR_StartTimerWithSlack(timerID, timerType, timeInMilliseconds, 0, callback, param);
+}
+
+/*! -------------------------------------------------------------------------
+ * \brief Start a specified timer that tolerates a late expiry
+ * \param[in] timerId - the ID of the timer
+ * \param[in] timerType - the type of the timer
+ * \param[in] timeInMilliseconds - time expressed in millisecond units
+ * \param[in] slackInMilliseconds - how late the timer may expire
+ * \param[in] pfTmrCallBack - callback function
+ * \param[in] param - parameter to callback function
+ *
+ * \details The timer thread is woken up at the latest when the slack ends.
+ *        The timer expires earlier if another timer wakes up the thread
+ *        after timeInMilliseconds.
+ *---------------------------------------------------------------------------*/
+tmrErrCode_t TMR_StartTimerWithSlack
+(
+    tmrTimerID_t timerID,
+    tmrTimerType_t timerType,
+    tmrTimeInMilliseconds_t timeInMilliseconds,
+    tmrTimeInMilliseconds_t slackInMilliseconds,
+    pfTmrCallBack_t callback,
+    void *param
+)
 {
     tmrErrCode_t status;
+#if gTMR_EnableTimerSlack_d
+    tmrTimerTicks64_t slackInTicks;
+#endif
     tmrTimerTicks64_t intervalInTicks;
 
     /* Stopping an already stopped timer is harmless. */
@@ -713,6 +1167,15 @@ tmrErrCode_t TMR_StartTimer
         maTmrTimerTable[timerID].pfCallBack = callback;
         maTmrTimerTable[timerID].param = param;
 
+#if gTMR_EnableTimerSlack_d
+        /* The timer thread never sleeps longer than mMaxToCountDown_c */
+        slackInTicks = TmrTicksFromMilliseconds(slackInMilliseconds);
+        maTmrTimerTable[timerID].slackTicks = (slackInTicks < mMaxToCountDown_c) ?
+                                              (tmrTimerTicks_t)slackInTicks : mMaxToCountDown_c;
+#else
+        (void)slackInMilliseconds;
+#endif
+
         /* Enable timer, the timer thread will do the rest of the work. */
         TMR_EnableTimer(timerID);
     }
@@ -905,6 +1368,9 @@ tmrErrCode_t TMR_StopTimer
 {
     tmrStatus_t status = gTmrSuccess_c;
     tmrErrCode_t err = gTmrSuccess_c;
+#if gTMR_EnableHeapScheduler_d
+    tmrTimerTicks64_t currentTime;
+#endif
 
     /* check if timer is not allocated or if it has an invalid ID (fix@ENGR00323423) */
     if( (timerID >= gTmrTotalTimers_c) || (!TMR_IsTimerAllocated(timerID)) )
@@ -918,6 +1384,13 @@ tmrErrCode_t TMR_StopTimer
 
         if ( (status == mTmrStatusActive_c) || (status == mTmrStatusReady_c) )
         {
+#if gTMR_EnableHeapScheduler_d
+            /* Keep the time left, in case the timer is enabled again */
+            currentTime = TMR_HeapNow();
+            maTmrTimerTable[timerID].remainingTicks = (maTmrTimerTable[timerID].expireTicks > currentTime) ?
+                                                      (maTmrTimerTable[timerID].expireTicks - currentTime) : 0;
+            TMR_HeapRemove(timerID);
+#endif
             TMR_SetTimerStatus(timerID, mTmrStatusInactive_c);
             DecrementActiveTimerNumber(TMR_GetTimerType(timerID));
             /* if no sw active timers are enabled, */
@@ -953,12 +1426,22 @@ void TMR_Task
 {
     tmrTimerTicks_t     nextInterruptTime;
     tmrTimerTicks_t     currentTimeInTicks;
+#if !gTMR_EnableHeapScheduler_d
     tmrTimerTicks_t     ticksSinceLastHere;
+    tmrTimerStatus_t    status;
+#endif
     tmrTimerTicks_t     ticksdiff;
     pfTmrCallBack_t     pfCallBack;
     tmrTimerType_t      timerType;
-    tmrTimerStatus_t    status;
     uint8_t             timerID;
+#if gTMR_EnableLatencyStats_d
+    tmrTimerTicks_t     latenessTicks;
+#if gTMR_EnableHeapScheduler_d
+    tmrTimerTicks64_t   expireTicks;
+#else
+    tmrTimerTicks_t     expireTicks;
+#endif
+#endif
 
     param=param;
 
@@ -971,6 +1454,71 @@ void TMR_Task
     {
         (void)OSA_EventWait(mTimerThreadEventId, osaEventFlagsAll_c, FALSE, osaWaitForever_c, &ev);
 #endif
+#if gTMR_EnableHeapScheduler_d
+        TmrIntDisableAll();
+
+        currentTimeInTicks = StackTimer_GetCounterValue();
+        mTmrHeapTime += (tmrTimerTicks_t)(currentTimeInTicks - previousTimeInTicks);
+        previousTimeInTicks = currentTimeInTicks;
+
+        /* Expire the timers from the root of the heap. The callbacks run with
+           interrupts enabled and may start or stop timers. */
+        while( mTmrHeapSize && (maTmrTimerTable[maTmrHeap[0]].expireTicks <= mTmrHeapTime) )
+        {
+            timerID = maTmrHeap[0];
+            timerType = TMR_GetTimerType(timerID);
+#if gTMR_EnableLatencyStats_d
+            expireTicks = maTmrTimerTable[timerID].expireTicks;
+#endif
+
+#if gTMR_EnableTimerSlack_d
+            if( mTmrHeapKey_m(timerID) > mTmrHeapTime )
+            {
+                mTmrSavedWakeups++;
+            }
+#endif
+
+            /* If this is an interval timer, restart it. Otherwise, mark it as inactive. */
+            if ( (timerType & gTmrSingleShotTimer_c) ||
+                 (timerType & gTmrSetMinuteTimer_c)  ||
+                 (timerType & gTmrSetSecondTimer_c)  )
+            {
+                (void)TMR_StopTimer(timerID);
+            }
+            else
+            {
+                maTmrTimerTable[timerID].expireTicks = mTmrHeapTime + maTmrTimerTable[timerID].intervalInTicks;
+                TMR_HeapSiftDown(0, timerID);
+            }
+
+            pfCallBack = maTmrTimerTable[timerID].pfCallBack;
+#if gTMR_EnableLatencyStats_d
+            latenessTicks = (tmrTimerTicks_t)(TMR_HeapNow() - expireTicks);
+#endif
+            TmrIntRestoreAll();
+
+            if (pfCallBack)
+            {
+#if gTMR_EnableLatencyStats_d
+                TMR_LatencyCallBack(timerID, pfCallBack, latenessTicks);
+#else
+                pfCallBack(maTmrTimerTable[timerID].param);
+#endif
+            }
+
+            TmrIntDisableAll();
+        }
+
+        /* Find the shortest active timer. */
+        nextInterruptTime = mMaxToCountDown_c;
+
+        if( mTmrHeapSize && ((mTmrHeapKey_m(maTmrHeap[0]) - mTmrHeapTime) < nextInterruptTime) )
+        {
+            nextInterruptTime = (tmrTimerTicks_t)(mTmrHeapKey_m(maTmrHeap[0]) - mTmrHeapTime);
+        }
+
+        TmrIntRestoreAll();
+#else
         TmrIntDisableAll();
 
         currentTimeInTicks = StackTimer_GetCounterValue();
@@ -997,9 +1545,9 @@ void TMR_Task
                 TMR_SetTimerStatus(timerID, mTmrStatusActive_c);
                 TmrIntRestoreAll();
 
-                if (nextInterruptTime > maTmrTimerTable[timerID].remainingTicks)
+                if (nextInterruptTime > maTmrTimerTable[timerID].remainingTicks + mTmrSlack_m(timerID))
                 {
-                    nextInterruptTime = maTmrTimerTable[timerID].remainingTicks;
+                    nextInterruptTime = maTmrTimerTable[timerID].remainingTicks + mTmrSlack_m(timerID);
                 }
             }
             else if (status == mTmrStatusActive_c)
@@ -1013,13 +1561,24 @@ void TMR_Task
                     maTmrTimerTable[timerID].timestamp = StackTimer_GetCounterValue();
                     TmrIntRestoreAll();
 
-                    if (nextInterruptTime > maTmrTimerTable[timerID].remainingTicks)
+                    if (nextInterruptTime > maTmrTimerTable[timerID].remainingTicks + mTmrSlack_m(timerID))
                     {
-                        nextInterruptTime = maTmrTimerTable[timerID].remainingTicks;
+                        nextInterruptTime = maTmrTimerTable[timerID].remainingTicks + mTmrSlack_m(timerID);
                     }
                 }
                 else
                 {
+#if gTMR_EnableTimerSlack_d
+                    if (maTmrTimerTable[timerID].remainingTicks + mTmrSlack_m(timerID) > ticksSinceLastHere)
+                    {
+                        mTmrSavedWakeups++;
+                    }
+#endif
+#if gTMR_EnableLatencyStats_d
+                    /* Nominal expiry time, on the counter */
+                    expireTicks = currentTimeInTicks -
+                        (tmrTimerTicks_t)(ticksSinceLastHere - maTmrTimerTable[timerID].remainingTicks);
+#endif
                     /* If this is an interval timer, restart it. Otherwise, mark it as inactive. */
                     if ( (timerType & gTmrSingleShotTimer_c) ||
                          (timerType & gTmrSetMinuteTimer_c)  ||
@@ -1034,9 +1593,9 @@ void TMR_Task
 
                         maTmrTimerTable[timerID].remainingTicks = maTmrTimerTable[timerID].intervalInTicks;
                         maTmrTimerTable[timerID].timestamp = StackTimer_GetCounterValue();
-                        if (nextInterruptTime > maTmrTimerTable[timerID].remainingTicks)
+                        if (nextInterruptTime > maTmrTimerTable[timerID].remainingTicks + mTmrSlack_m(timerID))
                         {
-                            nextInterruptTime = maTmrTimerTable[timerID].remainingTicks;
+                            nextInterruptTime = maTmrTimerTable[timerID].remainingTicks + mTmrSlack_m(timerID);
                         }
 
                         TmrIntRestoreAll();
@@ -1048,7 +1607,12 @@ void TMR_Task
                     in case the timer gets stopped or restarted in the callback*/
                     if (pfCallBack)
                     {
+#if gTMR_EnableLatencyStats_d
+                        latenessTicks = StackTimer_GetCounterValue() - expireTicks;
+                        TMR_LatencyCallBack(timerID, pfCallBack, latenessTicks);
+#else
                         pfCallBack(maTmrTimerTable[timerID].param);
+#endif
                     }
                 }
             }
@@ -1058,6 +1622,7 @@ void TMR_Task
                 /* Ignore any timer that is not active. */
             }
         }  /* for (timerID = 0; timerID < ... */
+#endif /*gTMR_EnableHeapScheduler_d*/
 
         TmrIntDisableAll();
 
@@ -1135,7 +1700,21 @@ void TMR_EnableTimer
     if (TMR_GetTimerStatus(tmrID) == mTmrStatusInactive_c)
     {
         IncrementActiveTimerNumber(TMR_GetTimerType(tmrID));
+#if gTMR_EnableHeapScheduler_d
+        /* The counter may have been stopped while no timer was active */
+        if( !mTmrHeapSize )
+        {
+            previousTimeInTicks = StackTimer_GetCounterValue();
+        }
+
+        /* The timer counts down as of now; the timer thread only reprograms
+           the hardware timer */
+        maTmrTimerTable[tmrID].expireTicks = TMR_HeapNow() + maTmrTimerTable[tmrID].remainingTicks;
+        TMR_HeapSiftUp(mTmrHeapSize++, tmrID);
+        TMR_SetTimerStatus(tmrID, mTmrStatusActive_c);
+#else
         TMR_SetTimerStatus(tmrID, mTmrStatusReady_c);
+#endif
         (void)OSA_EventSet(mTimerThreadEventId, mTmrDummyEvent_c);
     }
 
@@ -1184,12 +1763,18 @@ void TMR_SyncLpmTimers
 {
 #if (gTMR_EnableLowPowerTimers_d)
   #ifndef CPU_QN908X
+#if !gTMR_EnableHeapScheduler_d
     uint32_t  timerID;
     tmrTimerType_t timerType;
+#endif
 
     /* Check if there are low power active timer */
     if (numberOfLowPowerActiveTimers)
     {
+#if gTMR_EnableHeapScheduler_d
+        /* Only low power timers are active while sleeping */
+        mTmrHeapTime += sleepDurationTmrTicks;
+#else
         /* For each timer, detect the timer type and count down the spent duration in sleep */
         for (timerID = 0; timerID < NumberOfElements(maTmrTimerTable); ++timerID)
         {
@@ -1214,6 +1799,7 @@ void TMR_SyncLpmTimers
             }
 
         }/* end for (timerID = 0;.... */
+#endif /*gTMR_EnableHeapScheduler_d*/
 
         StackTimer_Enable();
         previousTimeInTicks = StackTimer_GetCounterValue();
@@ -1255,6 +1841,108 @@ uint32_t TMR_GetTimerFreq
   return mCounterFreqHz ;
 }
 
+#if gTMR_EnableTimerSlack_d
+/*! -------------------------------------------------------------------------
+ * \brief Get the number of timer thread wakeups saved by the timer slack
+ *---------------------------------------------------------------------------*/
+uint32_t TMR_GetSavedWakeups
+(
+    void
+)
+{
+    return mTmrSavedWakeups;
+}
+#endif
+
+#if gTMR_EnableLatencyStats_d
+/*! -------------------------------------------------------------------------
+ * \brief     Get the latency statistics of a timer
+ * \param[in]  timerID - the ID of the timer
+ * \param[out] pStats - the statistics
+ * \return    TRUE if the timer expired at least once, FALSE otherwise
+ *---------------------------------------------------------------------------*/
+bool_t TMR_GetLatencyStats
+(
+    tmrTimerID_t timerID,
+    tmrLatencyStats_t *pStats
+)
+{
+    tmrLatencyEntry_t entry;
+
+    if( timerID >= NumberOfElements(maTmrLatencyTable) )
+    {
+        return FALSE;
+    }
+
+    TmrIntDisableAll();
+    entry = maTmrLatencyTable[timerID];
+    pStats->callback = maTmrTimerTable[timerID].pfCallBack;
+    TmrIntRestoreAll();
+
+    pStats->expirations = entry.expirations;
+
+    if( !entry.expirations )
+    {
+        return FALSE;
+    }
+
+    pStats->latenessMinUs = (uint32_t)TMR_LatencyTicksToUs(entry.latenessMin);
+    pStats->latenessAvgUs = (uint32_t)(TMR_LatencyTicksToUs(entry.latenessSum) / entry.expirations);
+    pStats->latenessMaxUs = (uint32_t)TMR_LatencyTicksToUs(entry.latenessMax);
+    pStats->callbackMinUs = (uint32_t)TMR_LatencyTicksToUs(entry.callbackMin);
+    pStats->callbackAvgUs = (uint32_t)(TMR_LatencyTicksToUs(entry.callbackSum) / entry.expirations);
+    pStats->callbackMaxUs = (uint32_t)TMR_LatencyTicksToUs(entry.callbackMax);
+
+    return TRUE;
+}
+
+/*! -------------------------------------------------------------------------
+ * \brief     Get the lateness histogram of all the timer callbacks
+ * \param[out] pHistogram - gTMR_LatencyHistogramBins_c counters
+ *---------------------------------------------------------------------------*/
+void TMR_GetLatencyHistogram
+(
+    uint32_t *pHistogram
+)
+{
+    uint8_t bin;
+
+    TmrIntDisableAll();
+
+    for( bin = 0; bin < gTMR_LatencyHistogramBins_c; bin++ )
+    {
+        pHistogram[bin] = maTmrLatencyHistogram[bin];
+    }
+
+    TmrIntRestoreAll();
+}
+
+/*! -------------------------------------------------------------------------
+ * \brief     Clear the latency statistics of all the timers
+ *---------------------------------------------------------------------------*/
+void TMR_ResetLatencyStats
+(
+    void
+)
+{
+    uint8_t i;
+
+    TmrIntDisableAll();
+
+    for( i = 0; i < NumberOfElements(maTmrLatencyTable); i++ )
+    {
+        TMR_LatencyClear(i);
+    }
+
+    for( i = 0; i < gTMR_LatencyHistogramBins_c; i++ )
+    {
+        maTmrLatencyHistogram[i] = 0;
+    }
+
+    TmrIntRestoreAll();
+}
+#endif /*gTMR_EnableLatencyStats_d*/
+
 /*! -------------------------------------------------------------------------
  * \brief Initialize the timestamp module
  *---------------------------------------------------------------------------*/
@@ -120,6 +120,11 @@ typedef uint8_t tmrStatus_t;
  *                      zero, the timer has expired.
  *          pfCallBack - Pointer to the callback function
  *          param - Parameter to the callback function
+ *          slackTicks - How late the timer may expire, in ticks.
+ *          expireTicks - Heap scheduler only. Absolute expiry time of an active
+ *                        timer, in ticks.
+ *          heapIndex - Heap scheduler only. Position of an active timer in the
+ *                      heap.
  */
 typedef struct tmrTimerTableEntry_tag {
   tmrTimerTicks64_t intervalInTicks;
@@ -127,8 +132,33 @@ typedef struct tmrTimerTableEntry_tag {
   pfTmrCallBack_t pfCallBack;
   void *param;
   tmrTimerTicks_t timestamp;
+#if gTMR_EnableTimerSlack_d
+  tmrTimerTicks_t slackTicks;
+#endif
+#if gTMR_EnableHeapScheduler_d
+  tmrTimerTicks64_t expireTicks;
+  uint8_t heapIndex;
+#endif
 } tmrTimerTableEntry_t;
 
+#if gTMR_EnableLatencyStats_d
+/*
+ * \brief   Latency statistics of one timer, in ticks.
+ * Members: expirations - Number of callbacks measured.
+ *          lateness - Time from the nominal expiry to the start of the callback.
+ *          callback - Execution time of the callback.
+ */
+typedef struct tmrLatencyEntry_tag {
+  uint32_t expirations;
+  tmrTimerTicks_t latenessMin;
+  tmrTimerTicks_t latenessMax;
+  tmrTimerTicks64_t latenessSum;
+  tmrTimerTicks_t callbackMin;
+  tmrTimerTicks_t callbackMax;
+  tmrTimerTicks64_t callbackSum;
+} tmrLatencyEntry_t;
+#endif
+
 #endif /* #ifndef __TIMER_H__ */
 
  /*****************************************************************************
@@ -0,0 +1,123 @@
+/*! *********************************************************************************
+* \file
+*
+* This is the source file for the COBS module.
+*
+* Each encoded block starts with a code byte N (1..255): N-1 non zero data bytes
+* follow and, if N < 255, an implicit zero. The implicit zero of the last block
+* is not part of the data.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/*! *********************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+********************************************************************************** */
+#include "cobs.h"
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+********************************************************************************** */
+
+/*! *********************************************************************************
+* \brief  Encodes a block of data with COBS
+*
+* \param[in]  pInput   pointer to the input data
+* \param[in]  len      number of bytes in pInput
+* \param[out] pOutput  pointer to the output, at least COBS_ENCODED_MAX_SIZE(len)
+*                      bytes. Must not overlap pInput, except for in place
+*                      encoding with pInput == pOutput + COBS_IN_PLACE_OFFSET(len):
+*                      every output byte is then written at or before the input
+*                      byte being read.
+*
+* \return the number of bytes written to pOutput, without the delimiter
+********************************************************************************** */
+uint32_t cobs_encode(const uint8_t *pInput, uint32_t len, uint8_t *pOutput)
+{
+    uint32_t idxCode = 0;   /* position of the code byte of the current block */
+    uint32_t idxOut = 1;
+    uint8_t code = 1;
+
+    while (len--)
+    {
+        if (*pInput != 0)
+        {
+            pOutput[idxOut++] = *pInput;
+            code++;
+        }
+
+        /* Close the block on an input zero or when it holds 254 data bytes */
+        if (*pInput == 0 || code == 0xFF)
+        {
+            pOutput[idxCode] = code;
+            code = 1;
+            idxCode = idxOut++;
+
+            /* A full block at the end needs no empty block after it */
+            if (*pInput != 0 && len == 0)
+            {
+                return idxCode;
+            }
+        }
+
+        pInput++;
+    }
+
+    pOutput[idxCode] = code;
+
+    return idxOut;
+}
+
+/*! *********************************************************************************
+* \brief  Decodes a COBS block
+*
+* \param[in]  pInput   pointer to the encoded data, without the delimiter
+* \param[in]  len      number of bytes in pInput
+* \param[out] pOutput  pointer to the output. May be equal to pInput.
+* \param[in]  maxLen   size of the output
+*
+* \return the number of decoded bytes, or 0 if the frame is invalid
+********************************************************************************** */
+uint32_t cobs_decode(const uint8_t *pInput, uint32_t len, uint8_t *pOutput, uint32_t maxLen)
+{
+    uint32_t idxIn = 0;
+    uint32_t idxOut = 0;
+    uint8_t code;
+    uint8_t i;
+
+    while (idxIn < len)
+    {
+        code = pInput[idxIn++];
+
+        /* Zero code or block past the end of the frame: corrupted frame */
+        if (code == 0 || (idxIn + code - 1) > len || (idxOut + code - 1) > maxLen)
+        {
+            return 0;
+        }
+
+        for (i = 1; i < code; i++)
+        {
+            if (pInput[idxIn] == 0)
+            {
+                return 0;
+            }
+            pOutput[idxOut++] = pInput[idxIn++];
+        }
+
+        /* Implicit zero, except after the last block and after full blocks */
+        if (code != 0xFF && idxIn < len)
+        {
+            if (idxOut >= maxLen)
+            {
+                return 0;
+            }
+            pOutput[idxOut++] = 0;
+        }
+    }
+
+    return idxOut;
+}
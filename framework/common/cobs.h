@@ -0,0 +1,61 @@
+/*! *********************************************************************************
+* \file
+*
+* This is the COBS (Consistent Overhead Byte Stuffing) module header file. COBS
+* removes every 0x00 byte from a block of data, adding at most 1 byte per 254
+* input bytes (plus 1 header byte). The 0x00 byte can then delimit frames on a
+* serial line: the receiver resynchronizes on the next 0x00, even if it starts
+* in the middle of a frame or if the line also carries text.
+*
+* Frame on the line:
+*   [ COBS(data) ] [ 0x00 ]
+*
+* The functions do not handle the delimiter; the caller sends it.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _COBS_H_
+#define _COBS_H_
+
+#include <stdint.h>
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public macros
+*************************************************************************************
+********************************************************************************** */
+
+/* Maximum size, in bytes, of the cobs_encode() output for len input bytes */
+#define COBS_ENCODED_MAX_SIZE(len)      ((len) + ((len) / 254u) + 1u)
+
+/* Offset of the input in the output buffer for in place encoding: the input is
+ * stored at pOutput + COBS_IN_PLACE_OFFSET(len) and encoded over itself */
+#define COBS_IN_PLACE_OFFSET(len)       (((len) / 254u) + 1u)
+
+/* Frame delimiter */
+#define COBS_DELIMITER                  0x00u
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+********************************************************************************** */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns the encoded size. pOutput must hold COBS_ENCODED_MAX_SIZE(len) bytes.
+ * pInput must not overlap pOutput, or be pOutput + COBS_IN_PLACE_OFFSET(len). */
+uint32_t cobs_encode(const uint8_t *pInput, uint32_t len, uint8_t *pOutput);
+
+/* Returns the decoded size, or 0 if the frame is invalid or does not fit in
+ * maxLen. pInput must not include the delimiter. */
+uint32_t cobs_decode(const uint8_t *pInput, uint32_t len, uint8_t *pOutput, uint32_t maxLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _COBS_H_ */
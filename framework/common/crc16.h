@@ -0,0 +1,75 @@
+/*! *********************************************************************************
+* \file
+*
+* This is the CRC-16 module header file. It computes the CRC-16 with the CCITT
+* polynomial 0x1021, MSB first, without reflection and without final XOR. The
+* initial value is chosen by the caller, which covers the variants used by the
+* firmware:
+*   - CRC16_INIT_CCITT_FALSE (0xFFFF): hydrometer payload, framed records;
+*   - CRC16_INIT_XMODEM      (0x0000): hardware parameters (Flash_Adapter).
+*
+* The API is incremental: the CRC of a message can be computed in several
+* chunks, passing the result of one call as the input of the next one.
+*
+*   crc = crc16_update(CRC16_INIT_CCITT_FALSE, header, sizeof(header));
+*   crc = crc16_update(crc, payload, payloadLen);
+*
+* CRC16_ENGINE selects the algorithm used by crc16_update():
+*   0 - bitwise, no table (smallest code);
+*   1 - one 256 entries table (512 bytes of flash);
+*   2 - slicing-by-4, four tables (2 KB of flash), 4 bytes per iteration.
+* All the engines produce the same result and are always available under their
+* own names, for comparison.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _CRC16_H_
+#define _CRC16_H_
+
+#include <stdint.h>
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public macros
+*************************************************************************************
+********************************************************************************** */
+
+/* Algorithm used by crc16_update(): 0 - bitwise, 1 - table, 2 - slicing-by-4 */
+#ifndef CRC16_ENGINE
+#define CRC16_ENGINE                2
+#endif
+
+/* Generator polynomial (x^16 + x^12 + x^5 + 1) */
+#define CRC16_POLY                  0x1021u
+
+/* Initial values of the variants used by the firmware */
+#define CRC16_INIT_CCITT_FALSE      0xFFFFu
+#define CRC16_INIT_XMODEM           0x0000u
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+********************************************************************************** */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Incremental computation, with the algorithm selected by CRC16_ENGINE */
+uint16_t crc16_update(uint16_t crc, const uint8_t *pData, uint32_t len);
+
+/* CRC-16/CCITT-FALSE (initial value 0xFFFF) of a whole message */
+uint16_t crc16_ccitt(const uint8_t *pData, uint32_t len);
+
+/* Individual engines */
+uint16_t crc16_updateBitwise(uint16_t crc, const uint8_t *pData, uint32_t len);
+uint16_t crc16_updateTable(uint16_t crc, const uint8_t *pData, uint32_t len);
+uint16_t crc16_updateSlice4(uint16_t crc, const uint8_t *pData, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CRC16_H_ */
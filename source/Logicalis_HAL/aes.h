@@ -7,7 +7,8 @@
 // #define the macros below to 1/0 to enable/disable the mode of operation.
 //
 // CBC enables AES encryption in CBC-mode of operation.
-// ECB enables the basic ECB 16-byte block algorithm. Both can be enabled simultaneously.
+// CTR enables encryption in counter-mode.
+// ECB enables the basic ECB 16-byte block algorithm. All can be enabled simultaneously.
 
 // The #ifndef-guard allows it to be configured before #include'ing or at compile time.
 #ifndef CBC
@@ -18,10 +19,86 @@
   #define ECB 1
 #endif
 
+#ifndef CTR
+  #define CTR 1
+#endif
+
+// AES_TABLES selects the cipher engine, trading flash for speed:
+//   0 - byte-oriented rounds, smallest code (Multiply() based InvMixColumns)
+//   1 - 32 bit T-tables, one encrypt and one decrypt table (about 1 KB each)
+//   2 - 32 bit T-tables, four encrypt and four decrypt tables (about 4 KB each)
+// All engines produce bit-exact results.
+#ifndef AES_TABLES
+  #define AES_TABLES 0
+#endif
+
 #define AES128
 
+#define AES_BLOCKLEN 16 // Block length in bytes, AES is 128b block only
+
+// Size in bytes of an expanded AES128 key schedule (Nb*(Nr+1) words).
+#define AES_KEYEXP_SIZE 176
+
+// Key schedule and IV of one key. The context API is reentrant: the key is
+// expanded once by AES_init_ctx() and every call below reuses the schedule,
+// so several contexts may be used concurrently.
+//
+// The byte-oriented inverse cipher runs the encryption schedule backwards, so
+// the same RoundKey serves both directions. The T-table engines keep the
+// schedules as 32 bit words and add the equivalent inverse cipher schedule.
+typedef struct
+{
+#if defined(AES_TABLES) && AES_TABLES
+  uint32_t RoundKey[AES_KEYEXP_SIZE / 4];
+  uint32_t InvRoundKey[AES_KEYEXP_SIZE / 4];
+#else
+  uint8_t RoundKey[AES_KEYEXP_SIZE];
+#endif
+#if (defined(CBC) && CBC) || (defined(CTR) && CTR)
+  uint8_t Iv[AES_BLOCKLEN];
+#endif
+} aes_ctx_t;
+
+// Encryption-only key schedule, for keys that never decrypt: the forward cipher
+// schedule alone, half of an aes_ctx_t with the T-table engines.
+typedef struct
+{
+#if defined(AES_TABLES) && AES_TABLES
+  uint32_t RoundKey[AES_KEYEXP_SIZE / 4];
+#else
+  uint8_t RoundKey[AES_KEYEXP_SIZE];
+#endif
+} aes_enc_ctx_t;
+
+// Decryption-only key schedule, for keys that never encrypt. The T-table engines
+// keep only the inverse cipher schedule, half of an aes_ctx_t; the byte-oriented
+// engine needs the same RoundKey as aes_ctx_t.
+typedef struct
+{
+#if defined(AES_TABLES) && AES_TABLES
+  uint32_t InvRoundKey[AES_KEYEXP_SIZE / 4];
+#else
+  uint8_t RoundKey[AES_KEYEXP_SIZE];
+#endif
+} aes_dec_ctx_t;
+
+void AES_init_ctx(aes_ctx_t* ctx, const uint8_t* key);
+void AES_init_enc_ctx(aes_enc_ctx_t* ctx, const uint8_t* key);
+void AES_init_dec_ctx(aes_dec_ctx_t* ctx, const uint8_t* key);
+#if (defined(CBC) && CBC) || (defined(CTR) && CTR)
+void AES_init_ctx_iv(aes_ctx_t* ctx, const uint8_t* key, const uint8_t* iv);
+void AES_ctx_set_iv(aes_ctx_t* ctx, const uint8_t* iv);
+#endif
+
 #if defined(ECB) && ECB
 
+// Multi-block ECB. length must be a multiple of AES_BLOCKLEN; input and output may overlap exactly.
+void AES_ECB_encrypt_ctx(const aes_ctx_t* ctx, const uint8_t* input, uint8_t* output, uint32_t length);
+void AES_ECB_decrypt_ctx(const aes_ctx_t* ctx, const uint8_t* input, uint8_t* output, uint32_t length);
+void AES_ECB_encrypt_enc_ctx(const aes_enc_ctx_t* ctx, const uint8_t* input, uint8_t* output, uint32_t length);
+void AES_ECB_decrypt_dec_ctx(const aes_dec_ctx_t* ctx, const uint8_t* input, uint8_t* output, uint32_t length);
+
+// Single-block helpers kept for existing callers: they expand the key on every call.
 void AES_ECB_encrypt(const uint8_t* input, const uint8_t* key, uint8_t *output, const uint32_t length);
 void AES_ECB_decrypt(const uint8_t* input, const uint8_t* key, uint8_t *output, const uint32_t length);
 
@@ -30,10 +107,27 @@ void AES_ECB_decrypt(const uint8_t* input, const uint8_t* key, uint8_t *output,
 
 #if defined(CBC) && CBC
 
+// Multi-block CBC. length must be a multiple of AES_BLOCKLEN. ctx->Iv is updated,
+// so a long message can be processed in several calls.
+void AES_CBC_encrypt_ctx(aes_ctx_t* ctx, const uint8_t* input, uint8_t* output, uint32_t length);
+void AES_CBC_decrypt_ctx(aes_ctx_t* ctx, const uint8_t* input, uint8_t* output, uint32_t length);
+
+// Legacy helpers. Passing key or iv as 0 continues with the previous one, which
+// is kept in a module context: these two are not reentrant.
 void AES_CBC_encrypt_buffer(uint8_t* output, uint8_t* input, uint32_t length, const uint8_t* key, const uint8_t* iv);
 void AES_CBC_decrypt_buffer(uint8_t* output, uint8_t* input, uint32_t length, const uint8_t* key, const uint8_t* iv);
 
 #endif // #if defined(CBC) && CBC
 
 
+#if defined(CTR) && CTR
+
+// CTR mode: the same function encrypts and decrypts. ctx->Iv is the 128 bit
+// big-endian counter and is advanced by one per block. Only the last call of a
+// message may use a length that is not a multiple of AES_BLOCKLEN.
+void AES_CTR_xcrypt_ctx(aes_ctx_t* ctx, const uint8_t* input, uint8_t* output, uint32_t length);
+
+#endif // #if defined(CTR) && CTR
+
+
 #endif //_AES_H_
@@ -63,6 +63,15 @@
 
 \b@{Histórico de Alterações:@}
 
+    - 2026.10.17 -- As funções:
+                      ringbuf_Write()
+                      ringbuf_WriteStr()
+                      ringbuf_Read()
+                    deixaram de copiar byte a byte e passaram a usar memcpy()
+                    em no máximo dois trechos contíguos do buffer. O descarte
+                    dos bytes mais antigos e o avanço de idxLock continuam
+                    iguais aos da escrita byte a byte.
+                    (v1.0.8)
     - 2018.10.04 -- A função:
                       ringbuf_Init()
                     passou a ser chamada de:
@@ -121,6 +130,7 @@
 // =============================================================================
 #include "ring_buffer.h"
 
+#include <string.h>
 
 
 //------------------------------------------------------------------------------
@@ -132,6 +142,8 @@
 static int32_t ringbuf_indexCheck(ringbuf_t *pRingBuf, int32_t index);
 static void ringbuf_IncIdxWrite(ringbuf_t *pRingBuf);
 static void ringbuf_IncIdxRead(ringbuf_t *pRingBuf);
+static void ringbuf_CopyIn(ringbuf_t *pRingBuf, int32_t index, uint8_t *pInput, int32_t bytes);
+static void ringbuf_CopyOut(ringbuf_t *pRingBuf, int32_t index, uint8_t *pOutput, int32_t bytes);
 
 //
 // Dado um índice "cru", verifica se ele estourou o tamanho do buffer.
@@ -181,6 +193,36 @@ static void ringbuf_IncIdxRead(ringbuf_t *pRingBuf)
 	}
 }
 
+//
+// Copia "bytes" bytes (no máximo o tamanho do buffer) para o array do ringbuf,
+// a partir da posição "index", em até dois trechos contíguos. Não altera os índices.
+//
+static void ringbuf_CopyIn(ringbuf_t *pRingBuf, int32_t index, uint8_t *pInput, int32_t bytes)
+{
+	int32_t firstPart = pRingBuf->size - index;
+
+	if(firstPart > bytes)
+		firstPart = bytes;
+
+	memcpy(pRingBuf->pBuf + index, pInput, firstPart);
+	memcpy(pRingBuf->pBuf, pInput + firstPart, bytes - firstPart);
+}
+
+//
+// Copia "bytes" bytes (no máximo o tamanho do buffer) do array do ringbuf,
+// a partir da posição "index", em até dois trechos contíguos. Não altera os índices.
+//
+static void ringbuf_CopyOut(ringbuf_t *pRingBuf, int32_t index, uint8_t *pOutput, int32_t bytes)
+{
+	int32_t firstPart = pRingBuf->size - index;
+
+	if(firstPart > bytes)
+		firstPart = bytes;
+
+	memcpy(pOutput, pRingBuf->pBuf + index, firstPart);
+	memcpy(pOutput + firstPart, pRingBuf->pBuf, bytes - firstPart);
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -294,16 +336,57 @@ int32_t ringbuf_Capacity(ringbuf_t *pRingBuf)
 }
 
 //
-// Escreve dados no ringbuf.
+// Escreve dados no ringbuf (no máximo RINGBUF_MAX_SIZE bytes por chamada).
+//
+// O resultado é o mesmo de chamar ringbuf_WriteByte() para cada byte: se não houver
+// espaço livre, os bytes mais antigos são descartados e idxRead passa a apontar para
+// logo após idxWrite. Se idxRead alcançar idxLock durante o descarte, idxLock passa
+// a acompanhá-lo, uma posição à frente.
 //
 void ringbuf_Write(ringbuf_t *pRingBuf, uint8_t *pInput, int32_t bytesToWrite)
 {
-	int32_t maxIterations = RINGBUF_MAX_SIZE;
+	int32_t size = pRingBuf->size;
+	int32_t bytesToCopy = bytesToWrite;
+	int32_t freeBytes;
+	int32_t discarded;
+	int32_t lockDistance;
+
+	if(bytesToWrite <= 0)
+		return;
 
-	while(bytesToWrite-- && maxIterations--)
+	if(bytesToWrite > (int32_t)RINGBUF_MAX_SIZE)
+		bytesToWrite = bytesToCopy = RINGBUF_MAX_SIZE;
+
+	// Dos bytes que dão mais de uma volta no buffer, só os últimos "size" permanecem
+	if(bytesToCopy > size)
 	{
-		*(pRingBuf->pBuf + pRingBuf->idxWrite) = *pInput++;
-		ringbuf_IncIdxWrite(pRingBuf);
+		pInput += bytesToCopy - size;
+		bytesToCopy = size;
+	}
+	ringbuf_CopyIn(pRingBuf, (pRingBuf->idxWrite + bytesToWrite - bytesToCopy) % size, pInput, bytesToCopy);
+
+	freeBytes = size - 1 - ringbuf_TotWriten(pRingBuf);
+	pRingBuf->idxWrite = (pRingBuf->idxWrite + bytesToWrite) % size;
+
+	if(bytesToWrite > freeBytes)
+	{
+		// idxRead avança "discarded" posições; verifica se passa por idxLock
+		discarded = bytesToWrite - freeBytes;
+		if(pRingBuf->idxLock != -1)
+		{
+			lockDistance = pRingBuf->idxLock - pRingBuf->idxRead;
+			if(lockDistance <= 0)
+				lockDistance += size;
+		}
+		else
+		{
+			lockDistance = discarded + 1;
+		}
+
+		pRingBuf->idxRead = ringbuf_indexCheck(pRingBuf, pRingBuf->idxWrite + 1);
+
+		if(lockDistance <= discarded)
+			pRingBuf->idxLock = ringbuf_indexCheck(pRingBuf, pRingBuf->idxRead + 1);
 	}
 }
 
@@ -315,14 +398,12 @@ void ringbuf_Write(ringbuf_t *pRingBuf, uint8_t *pInput, int32_t bytesToWrite)
  */
 void ringbuf_WriteStr(ringbuf_t *pRingBuf, char *str)
 {
-	volatile int32_t maxIterations = RINGBUF_MAX_SIZE;
+	int32_t length = 0;
 
 	// Adiciona a string
-	while(*str && maxIterations--)
-	{
-		*(pRingBuf->pBuf + pRingBuf->idxWrite) = *str++;
-		ringbuf_IncIdxWrite(pRingBuf);
-	}
+	while(str[length] && length < (int32_t)RINGBUF_MAX_SIZE)
+		length++;
+	ringbuf_Write(pRingBuf, (uint8_t *)str, length);
 
 	// Adiciona o terminador nulo
 	*(pRingBuf->pBuf + pRingBuf->idxWrite) = '\0';
@@ -346,22 +427,19 @@ void ringbuf_WriteByte(ringbuf_t *pRingBuf, uint8_t data)
 //
 int32_t ringbuf_Read(ringbuf_t *pRingBuf, uint8_t *pOutput, int32_t bytesToRead)
 {
-	int32_t totReadBytes = 0;
-	int32_t maxIterations = RINGBUF_MAX_SIZE;
+	if(bytesToRead <= 0 || ringbuf_IsEmpty(pRingBuf))
+		return 0;
 
-	if(!ringbuf_IsEmpty(pRingBuf))
-	{
-		if(bytesToRead <= ringbuf_TotReadable(pRingBuf))
-		{
-			while(bytesToRead-- && maxIterations--)
-			{
-				*pOutput++ = *(pRingBuf->pBuf + pRingBuf->idxRead);
-				ringbuf_IncIdxRead(pRingBuf);
-				totReadBytes++;
-			}
-		}
-	}
-	return totReadBytes;
+	if(bytesToRead > ringbuf_TotReadable(pRingBuf))
+		return 0;
+
+	if(bytesToRead > (int32_t)RINGBUF_MAX_SIZE)
+		bytesToRead = RINGBUF_MAX_SIZE;
+
+	ringbuf_CopyOut(pRingBuf, pRingBuf->idxRead, pOutput, bytesToRead);
+	pRingBuf->idxRead = ringbuf_indexCheck(pRingBuf, pRingBuf->idxRead + bytesToRead);
+
+	return bytesToRead;
 }
 
 //
@@ -63,6 +63,15 @@
 
 \b@{Histórico de Alterações:@}
 
+    - 2026.10.17 -- As funções:
+                      ringbuf_Write()
+                      ringbuf_WriteStr()
+                      ringbuf_Read()
+                    deixaram de copiar byte a byte e passaram a usar memcpy()
+                    em no máximo dois trechos contíguos do buffer. O descarte
+                    dos bytes mais antigos e o avanço de idxLock continuam
+                    iguais aos da escrita byte a byte.
+                    (v1.0.8)
     - 2018.10.04 -- A função:
                       ringbuf_Init()
                     passou a ser chamada de:
@@ -9,6 +9,8 @@
    PINMUX no periférico PORT.
 
 \b@{Histórico de Alterações:@}
+    - 2026.10.17 -- serial_Read() e serial_ReadAll() passaram a transferir os
+                    bytes entre os ringbufs em blocos, em vez de byte a byte (v1.0.1).
     - 2019.03.25 -- Primeira versão (v1.0.0), baseada em serial.h/.c do ISD.
 
 \author
@@ -23,7 +25,8 @@
 //#include "fsl_gpio.h"   <<< Não sei se algo assim será necessário. Fica como pró-memória. - original
 #include "serial_flexcomm.h"
 
-
+// Tamanho do bloco usado para transferir os bytes de Inbuf para Outbuf
+#define SERIAL_TRANSFER_CHUNK 32
 
 //==============================================================================
 //
@@ -63,6 +66,37 @@ static inline void serial_enableIrqRX(canal_serial_t *pSerial)
 	EnableIRQ(pSerial->flexcomm_irq);
 }
 
+//
+// Transfere até total_to_read bytes de Inbuf para Outbuf, em blocos de até
+// SERIAL_TRANSFER_CHUNK bytes. Retorna o total de bytes transferidos.
+// Deve ser chamada com a interrupção de RX desabilitada.
+//
+static uint32_t serial_transfer(canal_serial_t *pSerial, uint32_t total_to_read)
+{
+    uint8_t chunk[SERIAL_TRANSFER_CHUNK];
+    uint32_t total_really_read = 0;
+    int32_t bytes;
+
+    while( total_to_read )
+    {
+        bytes = ringbuf_TotReadable(pSerial->pInBuf);
+        if( bytes == 0 )
+            break;
+
+        if( bytes > SERIAL_TRANSFER_CHUNK )
+            bytes = SERIAL_TRANSFER_CHUNK;
+        if( (uint32_t)bytes > total_to_read )
+            bytes = total_to_read;
+
+        ringbuf_Read(pSerial->pInBuf, chunk, bytes);
+        ringbuf_Write(pSerial->pOutBuf, chunk, bytes);
+        total_to_read -= bytes;
+        total_really_read += bytes;
+    }
+
+    return total_really_read;
+}
+
 
 
 //==============================================================================
@@ -366,20 +400,13 @@ int serial_Available(canal_serial_t *pSerial)
  */
 uint32_t serial_Read(canal_serial_t *pSerial, uint32_t total_to_read)
 {
-    uint8_t byte;
-    uint32_t total_really_read = 0;
+    uint32_t total_really_read;
 
     // Desabilita interrupção de RX na UART
     serial_disableIrqRX(pSerial);
 
     // Efetua a leitura
-    while( !ringbuf_IsEmpty(pSerial->pInBuf) && total_to_read )
-    {
-        ringbuf_Read(pSerial->pInBuf, &byte, 1);
-        ringbuf_Write(pSerial->pOutBuf, &byte, 1);
-        total_to_read--;
-        total_really_read++;
-    }
+    total_really_read = serial_transfer(pSerial, total_to_read);
 
     // Reabilita interrupção de RX na UART, se necessário
     serial_enableIrqRX(pSerial);
@@ -398,7 +425,6 @@ uint32_t serial_Read(canal_serial_t *pSerial, uint32_t total_to_read)
  */
 uint32_t serial_ReadAll(canal_serial_t *pSerial)
 {
-    uint8_t byte;
     uint32_t total_really_read = 0;
 
     if( !ringbuf_IsEmpty(pSerial->pInBuf) )
@@ -407,12 +433,7 @@ uint32_t serial_ReadAll(canal_serial_t *pSerial)
         serial_disableIrqRX(pSerial);
 
         // Efetua a leitura
-        while( !ringbuf_IsEmpty(pSerial->pInBuf) )
-        {
-            ringbuf_Read(pSerial->pInBuf, &byte, 1);
-            ringbuf_Write(pSerial->pOutBuf, &byte, 1);
-            total_really_read++;
-        }
+        total_really_read = serial_transfer(pSerial, UINT32_MAX);
 
         // Reabilita interrupção de RX na UART, se necessário
         serial_enableIrqRX(pSerial);
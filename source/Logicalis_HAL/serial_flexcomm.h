@@ -9,6 +9,8 @@
    PINMUX no periférico PORT.
 
 \b@{Histórico de Alterações:@}
+    - 2026.10.17 -- serial_Read() e serial_ReadAll() passaram a transferir os
+                    bytes entre os ringbufs em blocos, em vez de byte a byte (v1.0.1).
     - 2019.03.25 -- Primeira versão (v1.0.0), baseada em serial.h/.c do ISD.
 
 \author
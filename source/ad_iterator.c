@@ -0,0 +1,147 @@
+/*! *********************************************************************************
+ * \addtogroup AD ITERATOR
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the AD structure iterator.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "ad_iterator.h"
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Starts an iteration over raw AD data.
+ *
+ * \param[out]   pIter       Pointer to the iterator.
+ * \param[in]    pData       Pointer to the AD data, e.g. gapScannedDevice_t.data.
+ * \param[in]    dataLength  Length of the AD data.
+ ********************************************************************************** */
+void AdIter_Init(adIterator_t* pIter, const uint8_t* pData, uint8_t dataLength)
+{
+    pIter->pData = pData;
+    pIter->dataLength = dataLength;
+    pIter->offset = 0;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the next AD structure.
+ *
+ * \param[in]    pIter       Pointer to the iterator.
+ * \param[out]   pElement    Pointer to the element view.
+ *
+ * \return       FALSE at the end of the data, at padding or at a malformed element.
+ ********************************************************************************** */
+bool_t AdIter_Next(adIterator_t* pIter, adElement_t* pElement)
+{
+    uint8_t remaining = pIter->dataLength - pIter->offset;
+    uint8_t fieldLength;
+
+    /* Length and type octets must be present */
+    if ((pIter->offset >= pIter->dataLength) || (remaining < 2))
+    {
+        return FALSE;
+    }
+
+    fieldLength = pIter->pData[pIter->offset];
+
+    /* Zero length marks the padding of the data; the element must fit */
+    if ((fieldLength == 0) || (fieldLength > (uint8_t)(remaining - 1)))
+    {
+        pIter->offset = pIter->dataLength;
+        return FALSE;
+    }
+
+    pElement->adType = (gapAdType_t)pIter->pData[pIter->offset + 1];
+    pElement->length = fieldLength - 1;
+    pElement->pData = &pIter->pData[pIter->offset + 2];
+
+    pIter->offset += fieldLength + 1;
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+ * \brief        Finds the first AD structure of a given type.
+ *
+ * \param[in]    pData       Pointer to the AD data.
+ * \param[in]    dataLength  Length of the AD data.
+ * \param[in]    adType      AD type to search for.
+ * \param[out]   pElement    Pointer to the element view, valid if found.
+ *
+ * \return       TRUE if found.
+ ********************************************************************************** */
+bool_t AdIter_FindType
+(
+    const uint8_t*  pData,
+    uint8_t         dataLength,
+    gapAdType_t     adType,
+    adElement_t*    pElement
+)
+{
+    uint8_t offset = 0;
+    uint8_t fieldLength;
+
+    /* Single pass over the length octets, the element is built only on a match */
+    while ((offset < dataLength) && ((uint8_t)(dataLength - offset) >= 2))
+    {
+        fieldLength = pData[offset];
+
+        if ((fieldLength == 0) || (fieldLength > (uint8_t)(dataLength - offset - 1)))
+        {
+            break;
+        }
+
+        if (pData[offset + 1] == (uint8_t)adType)
+        {
+            pElement->adType = adType;
+            pElement->length = fieldLength - 1;
+            pElement->pData = &pData[offset + 2];
+            return TRUE;
+        }
+
+        offset += fieldLength + 1;
+    }
+
+    return FALSE;
+}
+
+/*! *********************************************************************************
+ * \brief        Finds the local name, complete or shortened.
+ *
+ * \return       TRUE if found.
+ ********************************************************************************** */
+bool_t AdIter_FindName(const uint8_t* pData, uint8_t dataLength, adElement_t* pElement)
+{
+    adIterator_t iter;
+
+    AdIter_Init(&iter, pData, dataLength);
+
+    while (AdIter_Next(&iter, pElement))
+    {
+        if ((pElement->adType == gAdCompleteLocalName_c) ||
+            (pElement->adType == gAdShortenedLocalName_c))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
@@ -0,0 +1,79 @@
+/*! *********************************************************************************
+ * \defgroup AD ITERATOR
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the AD structure iterator. It walks the
+* raw advertising / scan response data of a report (gapScannedDevice_t.data) and
+* yields (type, pointer, length) views into it, without copying.
+*
+* Every element is bounds checked: iteration stops at the first zero length
+* field (padding) or at the first element that does not fit in the data, so a
+* malformed report can never make a caller read past dataLength.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _AD_ITERATOR_H_
+#define _AD_ITERATOR_H_
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "EmbeddedTypes.h"
+#include "gap_types.h"
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+typedef struct adIterator_tag
+{
+    const uint8_t*  pData;
+    uint8_t         dataLength;
+    uint8_t         offset;
+} adIterator_t;
+
+/* View of one AD structure. pData points into the iterated buffer. */
+typedef struct adElement_tag
+{
+    gapAdType_t     adType;
+    uint8_t         length;     /* length of pData, AD type excluded */
+    const uint8_t*  pData;
+} adElement_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void AdIter_Init(adIterator_t* pIter, const uint8_t* pData, uint8_t dataLength);
+bool_t AdIter_Next(adIterator_t* pIter, adElement_t* pElement);
+bool_t AdIter_FindType
+(
+    const uint8_t*  pData,
+    uint8_t         dataLength,
+    gapAdType_t     adType,
+    adElement_t*    pElement
+);
+bool_t AdIter_FindName(const uint8_t* pData, uint8_t dataLength, adElement_t* pElement);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AD_ITERATOR_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
@@ -57,6 +57,20 @@
 /* Defines Size for Serial Manager Task*/
 #define gSerialTaskStackSize_c  500
 
+/* Messages handled by the application task on each wake-up, and the time
+ * budget of a wake-up in microseconds (0 - no time budget) */
+#define gAppThreadMsgBudget_c   8
+#define gAppThreadTimeBudgetUs_c 5000
+
+/* Application task counters, shown by the "appstats" shell command */
+#define gAppThreadStats_d       1
+
+/* Advertising reports buffered for the application task outside of the memory
+ * pools, and the report discarded when they are full. Drop-newest keeps the
+ * reports in arrival order (see ApplMain.h). */
+#define gAppScanRingSize_c      16
+#define gAppScanRingPolicy_c    gAppScanRingDropNewest_c
+
 /* Defines pools by block size and number of blocks. Must be aligned to 4 bytes.*/
 #define AppPoolsDetails_c \
          _block_size_  32  _number_of_blocks_    5 _eol_  \
@@ -66,11 +80,22 @@
          _block_size_ 512  _number_of_blocks_    5 _eol_
 
 /* Defines number of timers needed by the application */
-#define gTmrApplicationTimers_c         4
+#define gTmrApplicationTimers_c         6
 
 /* Defines number of timers needed by the protocol stack */
 #define gTmrStackTimers_c               5
 
+/* Active timers kept in a min-heap: the timer thread only visits the timers
+ * that expire instead of counting down the whole table on every wakeup */
+#define gTMR_EnableHeapScheduler_d      1
+
+/* Periodic housekeeping timers (throughput checker, "mem stats") are started
+ * with a slack so that they share the wakeups of the other timers */
+#define gTMR_EnableTimerSlack_d         1
+
+/* Lateness and execution time of the timer callbacks, shown by "tmr stats" */
+#define gTMR_EnableLatencyStats_d       1
+
 /* Set this define TRUE if the PIT frequency is an integer number of MHZ */
 #define gTMR_PIT_FreqMultipleOfMHZ_d    0
 
@@ -81,9 +106,15 @@
 #define gTimestamp_Enabled_d            1
 
 /* Number of commands the shell supports*/
-#define SHELL_MAX_COMMANDS  6
+#define SHELL_MAX_COMMANDS  7
 /* Max number of arguments for a command */
 #define SHELL_MAX_ARGS      11
+/* Shell output is coalesced into serial transfers of up to this size */
+#define SHELL_TX_BUFFER_SIZE 128
+/* ESC 'R' switches the shell to framed binary commands (see shell.h) */
+#define SHELL_USE_RPC        1
+/* shell_printf() formats in a small stack chunk, without pool buffers */
+#define SHELL_USE_PRINTF     1
 /*! *********************************************************************************
  *  RTOS Configuration
  ********************************************************************************** */
@@ -124,6 +155,39 @@
 #define gMaxBondedDevices_c         16
 #define gMaxResolvingListSize_c     16
 
+/*! *********************************************************************************
+ *  Hydrometer Configuration
+ ********************************************************************************** */
+/* Enables / Disables the per-meter derived-key cache */
+#define gHidroKeyCacheEnabled_d     1
+
+/* Number of meters whose derived key is cached. Must be a power of 2 */
+#define gHidroKeyCacheSize_c        32
+
+/* Software AES engine: 0 - byte-oriented, 1 - compact T-tables (~2 KB flash),
+ * 2 - full T-tables (~8 KB flash, fastest) */
+#define AES_TABLES                  2
+
+/* AES backend used by crypto_aes after reset (see cryptoAesBackend_t). The
+ * hardware AES is shared with the BLE link layer and may stall on a busy radio */
+#define gCryptoAesDefaultBackend_c  gCryptoAesBackendLogicalis_c
+
+/* Drops repeated meter frames (same address and data_crypt) for gHidroDedupTtlMs_c */
+#define gHidroDedupEnabled_d        1
+#define gHidroDedupSize_c           128
+#define gHidroDedupTtlMs_c          60000
+
+/* Latest reading per meter, used to report only changed readings. The table holds
+ * the meters in range, 24 bytes each; a larger population is served by replacing
+ * the meter not heard for the longest (see hidro_readings.h) */
+#define gHidroReadingsEnabled_d     1
+#define gHidroReadingsSize_c        128
+#define gHidroReadingsHeartbeatS_c  3600
+
+/* CRC-16 engine: 0 - bitwise, 1 - 256-entry table (512 B flash),
+ * 2 - slicing-by-4 (2 KB flash, fastest) */
+#define CRC16_ENGINE                2
+
 /*! *********************************************************************************
  *  Memory Pools Configuration
  ********************************************************************************** */
@@ -141,6 +205,34 @@
          AppPoolsDetails_c
 #endif
 
+/* Reference counted buffers, used to send binary records without waiting for
+ * the serial transmission */
+#define gMemBufferRefCount_d        1
+
+/* Buffers are allocated and freed without disabling interrupts, so the BLE
+ * and serial interrupts are not delayed by the Memory Manager */
+#define gMemLockFreePools_d         1
+
+/* Per pool usage, waste and requested size statistics, printed by the
+ * "mem stats" shell command */
+#define MEM_STATISTICS
+
+/* Records the last MEM_TRACE_SIZE allocations and frees, exported by the
+ * "mem trace" shell command for tools/mem_pool_optimizer.py. Recording
+ * disables interrupts on every allocation and free, which cancels
+ * gMemLockFreePools_d: define it only to capture a trace for pool tuning. */
+/* #define MEM_TRACE */
+#define MEM_TRACE_SIZE              128
+
+/* Allocations resolved in constant time: up to the largest block size, from
+ * the application pools and, when used, the NVM pools */
+#define gMemPoolLookupMaxSize_c     512
+#if gAppUseNvm_d
+    #define gMemPoolLookupIds_c     2
+#else
+    #define gMemPoolLookupIds_c     1
+#endif
+
 #endif /* _APP_PREINCLUDE_H_ */
 
 /*! *********************************************************************************
@@ -44,14 +44,22 @@
 #include "shell_gatt.h"
 #include "shell_gattdb.h"
 #include "shell_thrput.h"
+#include "shell_mem.h"
+#include "shell_tmr.h"
 
 #include "ble_conn_manager.h"
 #include "ApplMain.h"
 #include "ble_shell.h"
 
+#include "hidro_keycache.h"
+#include "hidro_dedup.h"
+#include "hidro_readings.h"
+
 //kannebley:autostart
 #include "gap_interface.h"
 
+#include <string.h>
+
 /************************************************************************************
 *************************************************************************************
 * Private macros
@@ -80,6 +88,9 @@ const char mpGapHelp[] = "\r\n"
            "gap scanstop\r\n"
            "gap scancfg [-type type] [-interval intervalInMs] [-window windowInMs]\r\n"
            "gap scandata [-erase] [-add type payload]\r\n"
+#if gAppScanRingSize_c
+           "gap scanring [-reset]\r\n"
+#endif
            "gap connectcfg [-interval intervalInMs] [-latency latency] [-timeout timeout]\r\n"
            "gap connect scannedDeviceId\r\n"
            "gap disconnect\r\n"
@@ -87,7 +98,19 @@ const char mpGapHelp[] = "\r\n"
            "gap paircfg [-usebonding usebonding] [-seclevel seclevel] [-keyflags flags]\r\n"
            "gap pair\r\n"
            "gap enterpin pin\r\n"
-           "gap bonds [-erase] [-remove deviceIndex]\r\n";
+           "gap bonds [-erase] [-remove deviceIndex]\r\n"
+#if gHidroKeyCacheEnabled_d
+           "gap keycache [-reset]\r\n"
+#endif
+           "gap aes [seclib-hw|seclib-sw|logicalis]\r\n"
+           "gap output [text|binary]\r\n"
+#if gHidroReadingsEnabled_d
+           "gap readings [-dump] [-reset] [-changes on|off] [-heartbeat s]\r\n"
+#endif
+#if gHidroDedupEnabled_d
+           "gap dedup [-reset] [-ttl ms]\r\n"
+#endif
+           ;
 
 const char mpGattHelp[] = "\r\n"
            "gatt discover [-all] [-service serviceUuid16InHex] \r\n"
@@ -108,6 +131,29 @@ const char mpThrputHelp[]  = "\r\n"
            "thrput start rx [-ci min max]\r\n"
            "thrput stop\r\n";
 
+#if defined(MEM_TRACE) || defined(MEM_STATISTICS)
+const char mpMemHelp[] = "\r\n"
+#ifdef MEM_TRACE
+           "mem trace [-start] [-stop] [-reset]\r\n"
+#endif
+#ifdef MEM_STATISTICS
+           "mem stats [-reset] [-period ms]\r\n"
+#endif
+           ;
+#endif
+
+#if gTMR_EnableLatencyStats_d
+const char mpTmrHelp[] = "\r\n"
+           "tmr stats [-reset]\r\n";
+#endif
+
+#if gAppThreadStats_d
+static int8_t BleApp_StatsCommand(uint8_t argc, char * argv[]);
+
+const char mpAppStatsHelp[] = "\r\n"
+           "appstats [-reset]\r\n";
+#endif
+
 /* Shell */
 const cmd_tbl_t mGapCmd =
 {
@@ -151,6 +197,50 @@ const cmd_tbl_t mThrputCmd =
     .help = "Contains commands for setting up and running throughput test"
 };
 
+#if defined(MEM_TRACE) || defined(MEM_STATISTICS)
+const cmd_tbl_t mMemCmd =
+{
+    .name = "mem",
+    .maxargs = 4,
+    .repeatable = 1,
+    .cmd = ShellMem_Command,
+    .usage = (char*)mpMemHelp,
+    .help = "Contains commands for the memory pool statistics and for exporting the allocation trace."
+};
+#endif
+
+#if gTMR_EnableLatencyStats_d
+const cmd_tbl_t mTmrCmd =
+{
+    .name = "tmr",
+    .maxargs = 3,
+    .repeatable = 1,
+    .cmd = ShellTmr_Command,
+    .usage = (char*)mpTmrHelp,
+    .help = "Shows how late the timer callbacks run and how long they take."
+};
+#endif
+
+#if gAppThreadStats_d
+const cmd_tbl_t mAppStatsCmd =
+{
+    .name = "appstats",
+    .maxargs = 2,
+    .repeatable = 1,
+    .cmd = BleApp_StatsCommand,
+    .usage = (char*)mpAppStatsHelp,
+    .help = "Shows the application task queue depths and message dispatch times."
+};
+#endif
+
+#if SHELL_USE_RPC
+/* Command IDs of the RPC mode, see ble_shell_rpc_cmds.h */
+const shell_rpc_cmd_t mRpcCmds[] =
+{
+#include "ble_shell_rpc_cmds.h"
+};
+#endif
+
 /************************************************************************************
 *************************************************************************************
 * Public memory declarations
@@ -187,6 +277,18 @@ void BleApp_Init(void)
     shell_register_function((cmd_tbl_t *)&mGattCmd);
     shell_register_function((cmd_tbl_t *)&mGattDbCmd);
     shell_register_function((cmd_tbl_t *)&mThrputCmd);
+#if gAppThreadStats_d
+    shell_register_function((cmd_tbl_t *)&mAppStatsCmd);
+#endif
+#if defined(MEM_TRACE) || defined(MEM_STATISTICS)
+    shell_register_function((cmd_tbl_t *)&mMemCmd);
+#endif
+#if gTMR_EnableLatencyStats_d
+    shell_register_function((cmd_tbl_t *)&mTmrCmd);
+#endif
+#if SHELL_USE_RPC
+    shell_rpc_register(mRpcCmds, NumberOfElements(mRpcCmds));
+#endif
 
     TMR_TimeStampInit();
 
@@ -254,6 +356,61 @@ static void BleApp_Config (void)
     ShellGattDb_Init();
 
 }
+
+#if gAppThreadStats_d
+/*! *********************************************************************************
+ * \brief        Shows or clears the application task counters.
+ *
+ ********************************************************************************** */
+static int8_t BleApp_StatsCommand(uint8_t argc, char * argv[])
+{
+    static const char* const queueNames[gAppQueueCount_c] = {"Host", "Scan", "Callback"};
+    appThreadStats_t stats;
+    uint8_t i;
+
+    if (argc == 2)
+    {
+        if(!strcmp((char*)argv[1], "-reset"))
+        {
+            App_ResetThreadStats();
+            return CMD_RET_SUCCESS;
+        }
+        return CMD_RET_USAGE;
+    }
+
+    App_GetThreadStats(&stats);
+
+    shell_write("\n\r-->  Application Task:");
+    shell_write("\n\r    -->  Passes: ");
+    shell_writeDec(stats.passes);
+    shell_write("\n\r    -->  Passes with messages left: ");
+    shell_writeDec(stats.budgetExhausted);
+    shell_write("\n\r    -->  Max messages per pass: ");
+    shell_writeDec(stats.maxMsgPerPass);
+
+    for (i = 0; i < gAppQueueCount_c; i++)
+    {
+        shell_write("\n\r    -->  ");
+        shell_write((char*)queueNames[i]);
+        shell_write(" queue: ");
+        shell_writeDec(stats.messages[i]);
+        shell_write(" msgs, max depth ");
+        shell_writeDec(stats.depthHighWaterMark[i]);
+        shell_write(", dispatch avg/max us ");
+        shell_writeDec(stats.messages[i] ? (stats.dispatchTotalUs[i] / stats.messages[i]) : 0);
+        shell_write("/");
+        shell_writeDec(stats.dispatchMaxUs[i]);
+    }
+
+#if gTMR_EnableTimerSlack_d
+    shell_write("\n\r-->  Timer wakeups saved by slack: ");
+    shell_writeDec(TMR_GetSavedWakeups());
+#endif
+
+    SHELL_NEWLINE();
+    return CMD_RET_SUCCESS;
+}
+#endif
 /*! *********************************************************************************
  * @}
  ********************************************************************************** */
@@ -0,0 +1,61 @@
+/*! *********************************************************************************
+* \file
+*
+* Command IDs of the shell RPC mode, one shell_rpc_cmd_t initializer per line,
+* sorted by ID. The arguments of the request follow the sub-command. The IDs
+* must not change, they are used by the host software.
+*
+* This file has no include guard: it is included inside the initializer of
+* mRpcCmds in ble_shell.c, and of the table of the host loopback test
+* (tools/host_tests/test_shell_rpc.c).
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+    {0x10, "gap",       "address"},
+    {0x11, "gap",       "devicename"},
+    {0x12, "gap",       "advstart"},
+    {0x13, "gap",       "advstop"},
+    {0x14, "gap",       "advcfg"},
+    {0x15, "gap",       "advdata"},
+    {0x16, "gap",       "scanstart"},
+    {0x17, "gap",       "scanstop"},
+    {0x18, "gap",       "scancfg"},
+    {0x19, "gap",       "scandata"},
+#if gAppScanRingSize_c
+    {0x1A, "gap",       "scanring"},
+#endif
+    {0x1B, "gap",       "connect"},
+    {0x1C, "gap",       "connectcfg"},
+    {0x1D, "gap",       "disconnect"},
+    {0x1E, "gap",       "connupdate"},
+    {0x1F, "gap",       "pair"},
+    {0x20, "gap",       "paircfg"},
+    {0x21, "gap",       "enterpin"},
+    {0x22, "gap",       "bonds"},
+#if gHidroKeyCacheEnabled_d
+    {0x23, "gap",       "keycache"},
+#endif
+    {0x24, "gap",       "aes"},
+    {0x25, "gap",       "output"},
+#if gHidroReadingsEnabled_d
+    {0x26, "gap",       "readings"},
+#endif
+#if gHidroDedupEnabled_d
+    {0x27, "gap",       "dedup"},
+#endif
+
+    {0x40, "gatt",      "discover"},
+    {0x41, "gatt",      "read"},
+    {0x42, "gatt",      "write"},
+    {0x43, "gatt",      "writecmd"},
+    {0x44, "gatt",      "notify"},
+    {0x45, "gatt",      "indicate"},
+
+    {0x50, "gattdb",    "read"},
+    {0x51, "gattdb",    "write"},
+    {0x52, "gattdb",    "addservice"},
+    {0x53, "gattdb",    "erase"},
+
+    {0x60, "thrput",    "start"},
+    {0x61, "thrput",    "stop"},
@@ -92,6 +92,15 @@
 /* Application Events */
 #define gAppEvtMsgFromHostStack_c       (1 << 0)
 #define gAppEvtAppCallback_c            (1 << 1)
+#define gAppEvtScanReport_c             (1 << 2)
+
+#if (gAppThreadMsgBudget_c < 1) || (gAppThreadMsgBudget_c > 255)
+#error "gAppThreadMsgBudget_c must be between 1 and 255"
+#endif
+
+#if (gAppScanRingSize_c > 255)
+#error "gAppScanRingSize_c must be up to 255"
+#endif
 
 #ifdef FSL_RTOS_FREE_RTOS
     #if (configUSE_IDLE_HOOK)
@@ -205,6 +214,14 @@ typedef struct appMsgCallback_tag{
     appCallbackHandler_t   handler;
     appCallbackParam_t     param;
 }appMsgCallback_t;
+
+#if gAppScanRingSize_c
+/* Scan report ring slot: the scanning event and a copy of its advertising data */
+typedef struct appScanReport_tag{
+    gapScanningEvent_t  scanEvent;
+    uint8_t             aData[gcGapMaxAdvertisingDataLength_c];
+}appScanReport_t;
+#endif
 /************************************************************************************
 *************************************************************************************
 * Private prototypes
@@ -226,6 +243,14 @@ static void App_KeyboardCallBack(uint8_t events);
 
 static void App_Thread (uint32_t param);
 static void App_HandleHostMessageInput(appMsgFromHost_t* pMsg);
+static bool_t App_DispatchMessage(appQueueId_t queue);
+static bool_t App_MessagesPending(void);
+
+#if gAppScanRingSize_c
+static bool_t App_ScanRingPut(gapScannedDevice_t* pScannedDevice);
+static bool_t App_ScanRingGet(appScanReport_t* pReport);
+static bool_t App_HandleScanReport(void);
+#endif
 
 #if !defined(MULTICORE_BLACKBOX)
 STATIC void App_GenericCallback (gapGenericEvent_t* pGenericEvent);
@@ -346,6 +371,22 @@ static osaEventId_t  mAppEvent;
 static anchor_t mHostAppInputQueue;
 static anchor_t mAppCbInputQueue;
 
+#if gAppScanRingSize_c
+/* Advertising reports, from the host stack to the application task */
+static appScanReport_t mScanRing[gAppScanRingSize_c];
+static uint8_t mScanRingHead;   /* Next slot to be written */
+static uint8_t mScanRingTail;   /* Next slot to be read */
+static uint8_t mScanRingCount;
+static appScanRingStats_t mScanRingStats;
+#endif
+
+/* Queue served first on the next pass of App_Thread */
+static appQueueId_t mAppNextQueue = gAppQueueHost_c;
+
+#if gAppThreadStats_d
+static appThreadStats_t mAppThreadStats;
+#endif
+
 static uint8_t platformInitialized = 0;
 
 static gapGenericCallback_t pfGenericCallback = NULL;
@@ -472,56 +513,78 @@ void main_task(uint32_t param)
 *         include timers, messages and any other user defined events.
 * \param[in]  argument
 *
-* \remarks  For bare-metal, process only one type of message at a time,
-*           to allow other higher priority task to run.
+* \remarks  The input queues are served in turn, one message from each, until
+*           they are empty or gAppThreadMsgBudget_c / gAppThreadTimeBudgetUs_c
+*           is used. The queue served first rotates between passes so that a
+*           busy queue does not delay the others. For bare-metal, return after
+*           each pass to allow other higher priority task to run.
 *
 ********************************************************************************** */
 void App_Thread (uint32_t param)
 {
     osaEventFlags_t event = 0;
+    appQueueId_t queue;
+    uint8_t msgCount;
+    uint8_t idleQueues;
+#if gAppThreadTimeBudgetUs_c
+    uint64_t passStart;
+#endif
 
     while(1)
     {
         OSA_EventWait(mAppEvent, osaEventFlagsAll_c, FALSE, mAppTaskWaitTime_c , &event);
 
-        /* Check for existing messages in queue */
-        if (MSG_Pending(&mHostAppInputQueue))
-        {
-            /* Pointer for storing the messages from host. */
-            appMsgFromHost_t *pMsgIn = MSG_DeQueue(&mHostAppInputQueue);
+#if gAppThreadTimeBudgetUs_c
+        passStart = TMR_GetTimestamp();
+#endif
+        queue = mAppNextQueue;
+        msgCount = 0;
+        idleQueues = 0;
 
-            if (pMsgIn)
+        /* Take one message from each queue in turn, until all are empty */
+        while ((idleQueues < gAppQueueCount_c) && (msgCount < gAppThreadMsgBudget_c))
+        {
+            if (App_DispatchMessage(queue))
             {
-                /* Process it */
-                App_HandleHostMessageInput(pMsgIn);
+                msgCount++;
+                idleQueues = 0;
+            }
+            else
+            {
+                idleQueues++;
+            }
 
-                /* Messages must always be freed. */
-                MSG_Free(pMsgIn);
+            queue = (queue + 1 < gAppQueueCount_c) ? (appQueueId_t)(queue + 1) : gAppQueueHost_c;
+
+#if gAppThreadTimeBudgetUs_c
+            if ((TMR_GetTimestamp() - passStart) >= gAppThreadTimeBudgetUs_c)
+            {
+                break;
             }
+#endif
         }
 
-        /* Check for existing messages in queue */
-        if (MSG_Pending(&mAppCbInputQueue))
+        mAppNextQueue = queue;
+
+        /* Signal the App_Thread again if there are more messages pending */
+        event = App_MessagesPending() ? gAppEvtAppCallback_c : 0;
+
+#if gAppThreadStats_d
+        if (msgCount)
         {
-            /* Pointer for storing the callback messages. */
-            appMsgCallback_t *pMsgIn = MSG_DeQueue(&mAppCbInputQueue);
+            mAppThreadStats.passes++;
 
-            if (pMsgIn)
+            if (msgCount > mAppThreadStats.maxMsgPerPass)
             {
-                /* Execute callback handler */
-                if (pMsgIn->handler)
-                {
-                    pMsgIn->handler (pMsgIn->param);
-                }
+                mAppThreadStats.maxMsgPerPass = msgCount;
+            }
 
-                /* Messages must always be freed. */
-                MSG_Free(pMsgIn);
+            if (event)
+            {
+                mAppThreadStats.budgetExhausted++;
             }
         }
-
-        /* Signal the App_Thread again if there are more messages pending */
-        event = MSG_Pending(&mHostAppInputQueue) ? gAppEvtMsgFromHostStack_c : 0;
-        event |= MSG_Pending(&mAppCbInputQueue) ? gAppEvtAppCallback_c : 0;
+#endif
 
         if (event)
         {
@@ -654,6 +717,37 @@ bleResult_t App_StartScanning(
     return Gap_StartScanning(pScanningParameters, App_ScanningCallback,  enableFilterDuplicates);
 }
 
+#if gAppThreadStats_d
+void App_GetThreadStats(appThreadStats_t* pStats)
+{
+    FLib_MemCpy(pStats, &mAppThreadStats, sizeof(appThreadStats_t));
+}
+
+void App_ResetThreadStats(void)
+{
+    FLib_MemSet(&mAppThreadStats, 0, sizeof(appThreadStats_t));
+}
+#endif
+
+#if gAppScanRingSize_c
+void App_GetScanRingStats(appScanRingStats_t* pStats)
+{
+    OSA_InterruptDisable();
+    FLib_MemCpy(pStats, &mScanRingStats, sizeof(appScanRingStats_t));
+    pStats->pending = mScanRingCount;
+    OSA_InterruptEnable();
+}
+
+void App_ResetScanRingStats(void)
+{
+    OSA_InterruptDisable();
+    mScanRingStats.received = 0;
+    mScanRingStats.dropped = 0;
+    mScanRingStats.highWaterMark = mScanRingCount;
+    OSA_InterruptEnable();
+}
+#endif
+
 bleResult_t App_RegisterGattServerCallback(gattServerCallback_t  serverCallback)
 {
     pfGattServerCallback = serverCallback;
@@ -1152,6 +1246,122 @@ static void App_KeyboardCallBack
 }
 #endif
 
+/*****************************************************************************
+* Takes one message from an input queue of the application task and handles it.
+* Interface assumptions: None
+* Return value: FALSE if the queue is empty
+*****************************************************************************/
+static bool_t App_DispatchMessage(appQueueId_t queue)
+{
+#if gAppThreadStats_d
+    uint64_t dispatchStart = TMR_GetTimestamp();
+    uint32_t dispatchTime;
+    uint16_t depth;
+#endif
+
+    switch (queue)
+    {
+        case gAppQueueHost_c:
+        {
+            /* Pointer for storing the messages from host. */
+            appMsgFromHost_t *pMsgIn;
+
+#if gAppThreadStats_d
+            depth = (uint16_t)ListGetSize(&mHostAppInputQueue);
+#endif
+            pMsgIn = MSG_DeQueue(&mHostAppInputQueue);
+
+            if (!pMsgIn)
+            {
+                return FALSE;
+            }
+
+            /* Process it */
+            App_HandleHostMessageInput(pMsgIn);
+
+            /* Messages must always be freed. */
+            MSG_Free(pMsgIn);
+            break;
+        }
+
+#if gAppScanRingSize_c
+        case gAppQueueScan_c:
+        {
+#if gAppThreadStats_d
+            depth = mScanRingCount;
+#endif
+            if (!App_HandleScanReport())
+            {
+                return FALSE;
+            }
+            break;
+        }
+#endif
+
+        case gAppQueueCallback_c:
+        {
+            /* Pointer for storing the callback messages. */
+            appMsgCallback_t *pMsgIn;
+
+#if gAppThreadStats_d
+            depth = (uint16_t)ListGetSize(&mAppCbInputQueue);
+#endif
+            pMsgIn = MSG_DeQueue(&mAppCbInputQueue);
+
+            if (!pMsgIn)
+            {
+                return FALSE;
+            }
+
+            /* Execute callback handler */
+            if (pMsgIn->handler)
+            {
+                pMsgIn->handler (pMsgIn->param);
+            }
+
+            /* Messages must always be freed. */
+            MSG_Free(pMsgIn);
+            break;
+        }
+
+        default:
+            return FALSE;
+    }
+
+#if gAppThreadStats_d
+    dispatchTime = (uint32_t)(TMR_GetTimestamp() - dispatchStart);
+
+    mAppThreadStats.messages[queue]++;
+    mAppThreadStats.dispatchTotalUs[queue] += dispatchTime;
+
+    if (dispatchTime > mAppThreadStats.dispatchMaxUs[queue])
+    {
+        mAppThreadStats.dispatchMaxUs[queue] = dispatchTime;
+    }
+
+    if (depth > mAppThreadStats.depthHighWaterMark[queue])
+    {
+        mAppThreadStats.depthHighWaterMark[queue] = depth;
+    }
+#endif
+
+    return TRUE;
+}
+
+/*****************************************************************************
+* Tells whether any input queue of the application task holds messages.
+* Interface assumptions: None
+* Return value: TRUE if messages are pending
+*****************************************************************************/
+static bool_t App_MessagesPending(void)
+{
+    return MSG_Pending(&mHostAppInputQueue) ||
+#if gAppScanRingSize_c
+           (mScanRingCount != 0) ||
+#endif
+           MSG_Pending(&mAppCbInputQueue);
+}
+
 /*****************************************************************************
 * Handles all messages received from the host task.
 * Interface assumptions: None
@@ -1248,6 +1458,118 @@ static void App_HandleHostMessageInput(appMsgFromHost_t* pMsg)
     }
 }
 
+#if gAppScanRingSize_c
+/*****************************************************************************
+* Stores an advertising report in the scan ring. When the ring is full the
+* oldest or the new report is discarded, according to gAppScanRingPolicy_c.
+* Interface assumptions: dataLength <= gcGapMaxAdvertisingDataLength_c
+* Return value: TRUE if the report was stored
+*****************************************************************************/
+static bool_t App_ScanRingPut(gapScannedDevice_t* pScannedDevice)
+{
+    appScanReport_t* pSlot;
+
+    OSA_InterruptDisable();
+
+    mScanRingStats.received++;
+
+    if (mScanRingCount == gAppScanRingSize_c)
+    {
+        mScanRingStats.dropped++;
+
+#if (gAppScanRingPolicy_c == gAppScanRingDropNewest_c)
+        OSA_InterruptEnable();
+        return FALSE;
+#else
+        if (++mScanRingTail == gAppScanRingSize_c)
+        {
+            mScanRingTail = 0;
+        }
+        mScanRingCount--;
+#endif
+    }
+
+    pSlot = &mScanRing[mScanRingHead];
+    pSlot->scanEvent.eventType = gDeviceScanned_c;
+    FLib_MemCpy(&pSlot->scanEvent.eventData.scannedDevice, pScannedDevice, sizeof(gapScannedDevice_t));
+    FLib_MemCpy(pSlot->aData, pScannedDevice->data, pScannedDevice->dataLength);
+
+    if (++mScanRingHead == gAppScanRingSize_c)
+    {
+        mScanRingHead = 0;
+    }
+
+    mScanRingCount++;
+
+    if (mScanRingCount > mScanRingStats.highWaterMark)
+    {
+        mScanRingStats.highWaterMark = mScanRingCount;
+    }
+
+    OSA_InterruptEnable();
+
+    return TRUE;
+}
+
+/*****************************************************************************
+* Takes the oldest advertising report out of the scan ring. The report is
+* copied, so the slot can be reused by the host stack while it is handled.
+* Interface assumptions: None
+* Return value: FALSE if the ring is empty
+*****************************************************************************/
+static bool_t App_ScanRingGet(appScanReport_t* pReport)
+{
+    appScanReport_t* pSlot;
+
+    OSA_InterruptDisable();
+
+    if (!mScanRingCount)
+    {
+        OSA_InterruptEnable();
+        return FALSE;
+    }
+
+    pSlot = &mScanRing[mScanRingTail];
+    FLib_MemCpy(&pReport->scanEvent, &pSlot->scanEvent, sizeof(gapScanningEvent_t));
+    FLib_MemCpy(pReport->aData, pSlot->aData, pSlot->scanEvent.eventData.scannedDevice.dataLength);
+
+    if (++mScanRingTail == gAppScanRingSize_c)
+    {
+        mScanRingTail = 0;
+    }
+
+    mScanRingCount--;
+
+    OSA_InterruptEnable();
+
+    pReport->scanEvent.eventData.scannedDevice.data = pReport->aData;
+
+    return TRUE;
+}
+
+/*****************************************************************************
+* Handles one advertising report from the scan ring.
+* Interface assumptions: None
+* Return value: FALSE if the ring is empty
+*****************************************************************************/
+static bool_t App_HandleScanReport(void)
+{
+    appScanReport_t report;
+
+    if (!App_ScanRingGet(&report))
+    {
+        return FALSE;
+    }
+
+    if (pfScanCallback)
+    {
+        pfScanCallback(&report.scanEvent);
+    }
+
+    return TRUE;
+}
+#endif /* gAppScanRingSize_c */
+
 #if !defined(MULTICORE_BLACKBOX)
 STATIC void App_GenericCallback (gapGenericEvent_t* pGenericEvent)
 {
@@ -1399,6 +1721,21 @@ STATIC void App_ScanningCallback (gapScanningEvent_t* pScanningEvent)
 
     uint8_t msgLen = GetRelAddr(appMsgFromHost_t, msgData) + sizeof(gapScanningEvent_t);
 
+#if gAppScanRingSize_c
+    /* Advertising reports go through the scan ring, the memory pools are kept
+       for the other events */
+    if ((pScanningEvent->eventType == gDeviceScanned_c) &&
+        (pScanningEvent->eventData.scannedDevice.dataLength <= gcGapMaxAdvertisingDataLength_c))
+    {
+        if (App_ScanRingPut(&pScanningEvent->eventData.scannedDevice))
+        {
+            /* Signal application */
+            OSA_EventSet(mAppEvent, gAppEvtScanReport_c);
+        }
+        return;
+    }
+#endif
+
     if (pScanningEvent->eventType == gDeviceScanned_c)
     {
         msgLen += pScanningEvent->eventData.scannedDevice.dataLength;
@@ -29,6 +29,34 @@
 typedef void* appCallbackParam_t;
 typedef void (*appCallbackHandler_t)(appCallbackParam_t param);
 
+/*! Application task input queues, in the order they are served */
+typedef enum appQueueId_tag{
+    gAppQueueHost_c = 0,    /*!< Host stack events */
+    gAppQueueScan_c,        /*!< Advertising reports, from the scan ring */
+    gAppQueueCallback_c,    /*!< Messages posted by App_PostCallbackMessage */
+    gAppQueueCount_c
+}appQueueId_t;
+
+/*! Application task counters. Dispatch time is the time spent handling one
+    message, in microseconds. */
+typedef struct appThreadStats_tag{
+    uint32_t    passes;                                 /*!< Passes that handled at least one message */
+    uint32_t    budgetExhausted;                        /*!< Passes that ended with messages still pending */
+    uint32_t    messages[gAppQueueCount_c];             /*!< Messages handled */
+    uint32_t    dispatchTotalUs[gAppQueueCount_c];      /*!< Sum of the dispatch times */
+    uint32_t    dispatchMaxUs[gAppQueueCount_c];        /*!< Longest dispatch time */
+    uint16_t    depthHighWaterMark[gAppQueueCount_c];   /*!< Maximum queue depth seen by the task */
+    uint8_t     maxMsgPerPass;                          /*!< Maximum messages handled in one pass */
+}appThreadStats_t;
+
+/*! Scan report ring counters */
+typedef struct appScanRingStats_tag{
+    uint32_t    received;       /*!< Advertising reports received from the host stack */
+    uint32_t    dropped;        /*!< Advertising reports lost because the ring was full */
+    uint8_t     pending;        /*!< Advertising reports waiting for the application task */
+    uint8_t     highWaterMark;  /*!< Maximum number of pending reports */
+}appScanRingStats_t;
+
 /*! *********************************************************************************
 *************************************************************************************
 * Public macros
@@ -55,6 +83,45 @@ typedef void (*appCallbackHandler_t)(appCallbackParam_t param);
 #define gAppIdleTaskPriority_c  (8)
 #endif
 
+/*! Maximum number of messages the application task handles on each wake-up,
+    taken from its input queues in turn. Remaining messages are handled on the
+    next pass, after the other tasks had a chance to run. */
+#ifndef gAppThreadMsgBudget_c
+#define gAppThreadMsgBudget_c   (8)
+#endif
+
+/*! Maximum time, in microseconds, the application task keeps handling
+    messages on each wake-up. 0 - limited only by gAppThreadMsgBudget_c */
+#ifndef gAppThreadTimeBudgetUs_c
+#define gAppThreadTimeBudgetUs_c (0)
+#endif
+
+/*! Enables the application task counters (App_GetThreadStats) */
+#ifndef gAppThreadStats_d
+#define gAppThreadStats_d       (0)
+#endif
+
+/*! Number of advertising reports buffered between the host stack and the
+    application task in a dedicated ring, instead of a message allocated from
+    the memory pools for each report. 0 disables the ring. */
+#ifndef gAppScanRingSize_c
+#define gAppScanRingSize_c      (16)
+#endif
+
+/*! Scan report ring overflow policies */
+#define gAppScanRingDropNewest_c    (0)
+#define gAppScanRingDropOldest_c    (1)
+
+/*! Report discarded when an advertising report arrives and the ring is full.
+    Drop-newest keeps the reports that arrived first, so the application
+    receives them in arrival order. Drop-oldest overwrites reports that were
+    not handled yet: once the ring wraps, the application skips to newer
+    reports and receives them out of order with the scan events and long
+    reports that still go through the host message queue. */
+#ifndef gAppScanRingPolicy_c
+#define gAppScanRingPolicy_c    (gAppScanRingDropNewest_c)
+#endif
+
 /*! *********************************************************************************
 *************************************************************************************
 * Public memory declarations
@@ -123,6 +190,39 @@ bleResult_t App_StartScanning(
     bool_t                      enableFilterDuplicates
 );
 
+#if gAppThreadStats_d
+/*! *********************************************************************************
+* \brief  Returns the application task counters.
+*
+* \param[out] pStats   Pointer to the counters.
+*
+********************************************************************************** */
+void App_GetThreadStats(appThreadStats_t* pStats);
+
+/*! *********************************************************************************
+* \brief  Clears the application task counters.
+*
+********************************************************************************** */
+void App_ResetThreadStats(void);
+#endif
+
+#if gAppScanRingSize_c
+/*! *********************************************************************************
+* \brief  Returns the counters of the scan report ring.
+*
+* \param[out] pStats   Pointer to the counters.
+*
+********************************************************************************** */
+void App_GetScanRingStats(appScanRingStats_t* pStats);
+
+/*! *********************************************************************************
+* \brief  Clears the received/dropped counters and the high-water mark of the
+*         scan report ring.
+*
+********************************************************************************** */
+void App_ResetScanRingStats(void);
+#endif
+
 /*! *********************************************************************************
 * \brief  Application wrapper function for GattClient_RegisterNotificationCallback.
 *
@@ -0,0 +1,278 @@
+/*! *********************************************************************************
+ * \addtogroup CRYPTO AES
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the AES-128 facade.
+*
+* The SecLib block functions require 4 bytes aligned buffers; blocks that are not
+* aligned (e.g. the packed advertising payload) are copied through an aligned
+* scratch block. The Logicalis engine works on the pre-expanded key schedule and
+* processes all blocks in one call.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "fsl_device_registers.h"
+#include "FunctionLib.h"
+#include "SecLib.h"
+#include "crypto_aes.h"
+
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+#define mCryptoAesIsAligned_m(p)        ((((uint32_t)(p)) & 0x03U) == 0U)
+
+/************************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+************************************************************************************/
+/* SecLib software AES (lib_crypto). Not exported by SecLib.h. */
+extern void sw_Aes128(const uint8_t *pData, const uint8_t *pKey, uint8_t enc, uint8_t *pReturnData);
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+static cryptoAesBackend_t mCryptoAesBackend = gCryptoAesDefaultBackend_c;
+
+static const char* const mCryptoAesBackendNames[gCryptoAesBackendCount_c] =
+{
+    "seclib-hw",
+    "seclib-sw",
+    "logicalis"
+};
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Runs one block through a SecLib backend, 4 bytes aligned buffers.
+ ********************************************************************************** */
+static void CryptoAes_SecLibBlock
+(
+    cryptoAesBackend_t  backend,
+    cryptoAesOp_t       op,
+    const uint8_t*      pKey,
+    const uint8_t*      pInput,
+    uint8_t*            pOutput
+)
+{
+#if FSL_FEATURE_SOC_AES_HW
+    if (backend == gCryptoAesBackendSecLibHw_c)
+    {
+        if (op == gCryptoAesEncrypt_c)
+        {
+            AES_128_Encrypt(pInput, pKey, pOutput);
+        }
+        else
+        {
+            AES_128_Decrypt(pInput, pKey, pOutput);
+        }
+    }
+    else
+#else
+    (void)backend;
+#endif
+    {
+        sw_Aes128(pInput, pKey, (op == gCryptoAesEncrypt_c) ? 1 : 0, pOutput);
+    }
+}
+
+/*! *********************************************************************************
+ * \brief        Multi-block ECB through a SecLib backend.
+ ********************************************************************************** */
+static void CryptoAes_SecLibEcb
+(
+    cryptoAesBackend_t      backend,
+    cryptoAesOp_t           op,
+    const uint32_t*         pRawKey,
+    const uint8_t*          pInput,
+    uint8_t*                pOutput,
+    uint32_t                numBlocks
+)
+{
+    uint32_t alignedIn[gCryptoAesBlockSize_c / sizeof(uint32_t)];
+    uint32_t alignedOut[gCryptoAesBlockSize_c / sizeof(uint32_t)];
+    const uint8_t* pIn;
+    uint8_t* pOut;
+
+    while (numBlocks--)
+    {
+        pIn = pInput;
+        pOut = pOutput;
+
+        if (!mCryptoAesIsAligned_m(pInput))
+        {
+            FLib_MemCpy(alignedIn, (void*)pInput, gCryptoAesBlockSize_c);
+            pIn = (const uint8_t*)alignedIn;
+        }
+
+        /* Unaligned, or in place: sw_Aes128() does not support overlapping buffers */
+        if (!mCryptoAesIsAligned_m(pOutput) || (pOutput == pInput))
+        {
+            pOut = (uint8_t*)alignedOut;
+        }
+
+        CryptoAes_SecLibBlock(backend, op, (const uint8_t*)pRawKey, pIn, pOut);
+
+        if (pOut != pOutput)
+        {
+            FLib_MemCpy(pOutput, alignedOut, gCryptoAesBlockSize_c);
+        }
+
+        pInput += gCryptoAesBlockSize_c;
+        pOutput += gCryptoAesBlockSize_c;
+    }
+}
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Tells whether a backend is linked in this build.
+ ********************************************************************************** */
+bool_t CryptoAes_IsBackendAvailable(cryptoAesBackend_t backend)
+{
+    switch (backend)
+    {
+#if FSL_FEATURE_SOC_AES_HW
+        case gCryptoAesBackendSecLibHw_c:
+#endif
+        case gCryptoAesBackendSecLibSw_c:
+        case gCryptoAesBackendLogicalis_c:
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+/*! *********************************************************************************
+ * \brief        Selects the backend used by CryptoAes_Ecb().
+ *
+ * \param[in]    backend    One of cryptoAesBackend_t.
+ *
+ * \return       FALSE if the backend is not available in this build.
+ ********************************************************************************** */
+bool_t CryptoAes_SetBackend(cryptoAesBackend_t backend)
+{
+    if (!CryptoAes_IsBackendAvailable(backend))
+    {
+        return FALSE;
+    }
+
+    mCryptoAesBackend = backend;
+    return TRUE;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the backend used by CryptoAes_Ecb().
+ ********************************************************************************** */
+cryptoAesBackend_t CryptoAes_GetBackend(void)
+{
+    return mCryptoAesBackend;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the name of a backend, as used by the shell.
+ ********************************************************************************** */
+const char* CryptoAes_GetBackendName(cryptoAesBackend_t backend)
+{
+    if (backend >= gCryptoAesBackendCount_c)
+    {
+        return "unknown";
+    }
+
+    return mCryptoAesBackendNames[backend];
+}
+
+/*! *********************************************************************************
+ * \brief        Prepares a 128 bit key for every backend, for one direction. The
+ *               key schedule of the software engine is expanded here, once per key.
+ *
+ * \param[out]   pKey       Pointer to the key object.
+ * \param[in]    pRawKey    Pointer to the 16 bytes key, any alignment.
+ * \param[in]    op         Direction the key is used for by CryptoAes_Ecb().
+ ********************************************************************************** */
+void CryptoAes_SetKey(cryptoAesKey_t* pKey, const uint8_t* pRawKey, cryptoAesOp_t op)
+{
+    FLib_MemCpy(pKey->key, (void*)pRawKey, gCryptoAesBlockSize_c);
+    pKey->op = op;
+
+    if (op == gCryptoAesEncrypt_c)
+    {
+        AES_init_enc_ctx(&pKey->aesCtx.enc, (const uint8_t*)pKey->key);
+    }
+    else
+    {
+        AES_init_dec_ctx(&pKey->aesCtx.dec, (const uint8_t*)pKey->key);
+    }
+}
+
+/*! *********************************************************************************
+ * \brief        Encrypts or decrypts consecutive 16 bytes blocks in ECB mode with
+ *               the selected backend.
+ *
+ * \param[in]    op         gCryptoAesEncrypt_c or gCryptoAesDecrypt_c.
+ * \param[in]    pKey       Key prepared by CryptoAes_SetKey() for the same op.
+ * \param[in]    pInput     Pointer to the input blocks, any alignment.
+ * \param[out]   pOutput    Pointer to the output blocks, any alignment. May be
+ *                          equal to pInput.
+ * \param[in]    numBlocks  Number of 16 bytes blocks.
+ *
+ * \return       FALSE if the key was prepared for the other direction.
+ ********************************************************************************** */
+bool_t CryptoAes_Ecb
+(
+    cryptoAesOp_t           op,
+    const cryptoAesKey_t*   pKey,
+    const uint8_t*          pInput,
+    uint8_t*                pOutput,
+    uint32_t                numBlocks
+)
+{
+    if (op != pKey->op)
+    {
+        return FALSE;
+    }
+
+    if (mCryptoAesBackend == gCryptoAesBackendLogicalis_c)
+    {
+        if (op == gCryptoAesEncrypt_c)
+        {
+            AES_ECB_encrypt_enc_ctx(&pKey->aesCtx.enc, pInput, pOutput, numBlocks * gCryptoAesBlockSize_c);
+        }
+        else
+        {
+            AES_ECB_decrypt_dec_ctx(&pKey->aesCtx.dec, pInput, pOutput, numBlocks * gCryptoAesBlockSize_c);
+        }
+    }
+    else
+    {
+        CryptoAes_SecLibEcb(mCryptoAesBackend, op, pKey->key, pInput, pOutput, numBlocks);
+    }
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
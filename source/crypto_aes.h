@@ -0,0 +1,107 @@
+/*! *********************************************************************************
+ * \defgroup CRYPTO AES
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the AES-128 facade. It routes block
+* operations to one of the AES implementations linked in the firmware:
+*   - SecLib on the QN908X AES hardware (shared with the BLE link layer),
+*   - the SecLib software AES (lib_crypto),
+*   - the Logicalis_HAL software AES (aes.c).
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _CRYPTO_AES_H_
+#define _CRYPTO_AES_H_
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "EmbeddedTypes.h"
+#include "aes.h"
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+#define gCryptoAesBlockSize_c           16
+
+/* Backend used after reset. Can be changed at run time with CryptoAes_SetBackend() */
+#ifndef gCryptoAesDefaultBackend_c
+#define gCryptoAesDefaultBackend_c      gCryptoAesBackendLogicalis_c
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+typedef enum cryptoAesBackend_tag
+{
+    gCryptoAesBackendSecLibHw_c,
+    gCryptoAesBackendSecLibSw_c,
+    gCryptoAesBackendLogicalis_c,
+    gCryptoAesBackendCount_c
+} cryptoAesBackend_t;
+
+typedef enum cryptoAesOp_tag
+{
+    gCryptoAesEncrypt_c,
+    gCryptoAesDecrypt_c
+} cryptoAesOp_t;
+
+/* A key prepared for every backend, in one direction: SecLib takes the raw key
+ * (4 bytes aligned), the Logicalis engine takes the key schedule of that
+ * direction, expanded once (196 bytes in all, against 384 with both schedules). */
+typedef struct cryptoAesKey_tag
+{
+    uint32_t        key[gCryptoAesBlockSize_c / sizeof(uint32_t)];
+    cryptoAesOp_t   op;
+    union
+    {
+        aes_enc_ctx_t   enc;
+        aes_dec_ctx_t   dec;
+    } aesCtx;
+} cryptoAesKey_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool_t CryptoAes_SetBackend(cryptoAesBackend_t backend);
+cryptoAesBackend_t CryptoAes_GetBackend(void);
+bool_t CryptoAes_IsBackendAvailable(cryptoAesBackend_t backend);
+const char* CryptoAes_GetBackendName(cryptoAesBackend_t backend);
+
+void CryptoAes_SetKey(cryptoAesKey_t* pKey, const uint8_t* pRawKey, cryptoAesOp_t op);
+
+bool_t CryptoAes_Ecb
+(
+    cryptoAesOp_t           op,
+    const cryptoAesKey_t*   pKey,
+    const uint8_t*          pInput,
+    uint8_t*                pOutput,
+    uint32_t                numBlocks
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CRYPTO_AES_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
@@ -0,0 +1,225 @@
+/*! *********************************************************************************
+ * \addtogroup HIDRO DEDUP
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the hydrometer duplicate-advertisement filter.
+*
+* The table is set associative: the advertiser address selects a set of
+* gHidroDedupWays_c entries, and each advertiser owns at most one entry holding
+* the hash of its last processed frame. A lookup therefore costs one hash of the
+* address, one hash of data_crypt and at most gHidroDedupWays_c compares. When a
+* set is full the entry seen longest ago is replaced.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "FunctionLib.h"
+#include "TimersManager.h"
+#include "ble_general.h"
+#include "hidro_dedup.h"
+
+#if gHidroDedupEnabled_d
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+#define mHidroDedupSets_c               (gHidroDedupSize_c / gHidroDedupWays_c)
+
+#if (gHidroDedupSize_c & (gHidroDedupSize_c - 1)) || (gHidroDedupSize_c < gHidroDedupWays_c)
+#error "gHidroDedupSize_c must be a power of 2, at least gHidroDedupWays_c"
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private type definitions
+*************************************************************************************
+************************************************************************************/
+typedef struct hidroDedupEntry_tag
+{
+    bleDeviceAddress_t  address;
+    bool_t              valid;
+    uint32_t            frameHash;
+    uint32_t            lastProcessedMs;
+} hidroDedupEntry_t;
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+static hidroDedupEntry_t mDedupTable[mHidroDedupSets_c][gHidroDedupWays_c];
+
+static uint32_t mDedupTtlMs = gHidroDedupTtlMs_c;
+
+static uint32_t mDedupProcessed;
+static uint32_t mDedupSuppressed;
+static uint32_t mDedupEvictions;
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        FNV-1a hash of a byte string.
+ ********************************************************************************** */
+static uint32_t HidroDedup_Hash(const uint8_t* pData, uint8_t length)
+{
+    uint32_t hash = 2166136261U;
+
+    while (length--)
+    {
+        hash ^= *pData++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Checks whether an advertisement repeats the last frame processed
+ *               for its advertiser, and records it otherwise.
+ *
+ * \param[in]    pAddress    Advertiser address.
+ * \param[in]    pData       Advertising data.
+ * \param[in]    dataLength  Length of the advertising data. Frames too short to
+ *                           hold data_crypt are never suppressed.
+ *
+ * \return       TRUE if the frame is a duplicate and must be dropped.
+ ********************************************************************************** */
+bool_t HidroDedup_IsDuplicate(const uint8_t* pAddress, const uint8_t* pData, uint8_t dataLength)
+{
+    hidroDedupEntry_t* pSet;
+    hidroDedupEntry_t* pEntry = NULL;
+    uint32_t frameHash;
+    uint32_t nowMs;
+    uint8_t way;
+
+    if (dataLength < (gHidroDataCryptOffset_c + gHidroDataCryptSize_c))
+    {
+        mDedupProcessed++;
+        return FALSE;
+    }
+
+    nowMs = (uint32_t)(TMR_GetTimestamp() / 1000);
+    frameHash = HidroDedup_Hash(&pData[gHidroDataCryptOffset_c], gHidroDataCryptSize_c);
+    pSet = mDedupTable[HidroDedup_Hash(pAddress, sizeof(bleDeviceAddress_t)) & (mHidroDedupSets_c - 1)];
+
+    for (way = 0; way < gHidroDedupWays_c; way++)
+    {
+        if (pSet[way].valid && FLib_MemCmp(pSet[way].address, (void*)pAddress, sizeof(bleDeviceAddress_t)))
+        {
+            pEntry = &pSet[way];
+            break;
+        }
+    }
+
+    if (pEntry != NULL)
+    {
+        if ((pEntry->frameHash == frameHash) &&
+            ((uint32_t)(nowMs - pEntry->lastProcessedMs) < mDedupTtlMs))
+        {
+            mDedupSuppressed++;
+            return TRUE;
+        }
+    }
+    else
+    {
+        /* New advertiser: take a free way, or the one processed longest ago */
+        pEntry = &pSet[0];
+
+        for (way = 0; way < gHidroDedupWays_c; way++)
+        {
+            if (!pSet[way].valid)
+            {
+                pEntry = &pSet[way];
+                break;
+            }
+
+            if ((uint32_t)(nowMs - pSet[way].lastProcessedMs) > (uint32_t)(nowMs - pEntry->lastProcessedMs))
+            {
+                pEntry = &pSet[way];
+            }
+        }
+
+        if (pEntry->valid)
+        {
+            mDedupEvictions++;
+        }
+
+        FLib_MemCpy(pEntry->address, (void*)pAddress, sizeof(bleDeviceAddress_t));
+        pEntry->valid = TRUE;
+    }
+
+    pEntry->frameHash = frameHash;
+    pEntry->lastProcessedMs = nowMs;
+    mDedupProcessed++;
+
+    return FALSE;
+}
+
+/*! *********************************************************************************
+ * \brief        Forgets all advertisers. Statistics and TTL are kept.
+ ********************************************************************************** */
+void HidroDedup_Reset(void)
+{
+    FLib_MemSet(mDedupTable, 0, sizeof(mDedupTable));
+}
+
+/*! *********************************************************************************
+ * \brief        Sets the time an identical frame is suppressed. 0 disables the filter.
+ ********************************************************************************** */
+void HidroDedup_SetTtl(uint32_t ttlMs)
+{
+    mDedupTtlMs = ttlMs;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the time, in milliseconds, an identical frame is suppressed.
+ ********************************************************************************** */
+uint32_t HidroDedup_GetTtl(void)
+{
+    return mDedupTtlMs;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the processed/suppressed counters.
+ ********************************************************************************** */
+void HidroDedup_GetStats(hidroDedupStats_t* pStats)
+{
+    pStats->processed = mDedupProcessed;
+    pStats->suppressed = mDedupSuppressed;
+    pStats->evictions = mDedupEvictions;
+}
+
+/*! *********************************************************************************
+ * \brief        Clears the processed/suppressed counters.
+ ********************************************************************************** */
+void HidroDedup_ResetStats(void)
+{
+    mDedupProcessed = 0;
+    mDedupSuppressed = 0;
+    mDedupEvictions = 0;
+}
+
+#endif /* gHidroDedupEnabled_d */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
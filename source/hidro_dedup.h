@@ -0,0 +1,94 @@
+/*! *********************************************************************************
+ * \defgroup HIDRO DEDUP
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the hydrometer duplicate-advertisement
+* filter. Meters re-broadcast the same encrypted frame many times between
+* readings; the filter remembers, per advertiser address, a hash of the last
+* processed data_crypt field so that repeated frames are dropped before they are
+* decrypted and printed. Only frames already matched as meter advertisements must
+* be passed to the filter, so that other advertisers do not take table entries.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _HIDRO_DEDUP_H_
+#define _HIDRO_DEDUP_H_
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "EmbeddedTypes.h"
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+/* Enables / Disables the duplicate-advertisement filter */
+#ifndef gHidroDedupEnabled_d
+#define gHidroDedupEnabled_d            1
+#endif
+
+/* Number of advertisers tracked. Must be a power of 2, at least gHidroDedupWays_c. */
+#ifndef gHidroDedupSize_c
+#define gHidroDedupSize_c               128
+#endif
+
+/* Time, in milliseconds, an identical frame is suppressed after it was processed */
+#ifndef gHidroDedupTtlMs_c
+#define gHidroDedupTtlMs_c              60000
+#endif
+
+/* Entries per set. An advertiser always maps to the same set. */
+#define gHidroDedupWays_c               4
+
+/* Location of data_crypt in the advertising data of a meter (see hidroPackage) */
+#define gHidroDataCryptOffset_c         9
+#define gHidroDataCryptSize_c           16
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+typedef struct hidroDedupStats_tag
+{
+    uint32_t    processed;
+    uint32_t    suppressed;
+    uint32_t    evictions;
+} hidroDedupStats_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if gHidroDedupEnabled_d
+bool_t HidroDedup_IsDuplicate(const uint8_t* pAddress, const uint8_t* pData, uint8_t dataLength);
+void HidroDedup_Reset(void);
+void HidroDedup_SetTtl(uint32_t ttlMs);
+uint32_t HidroDedup_GetTtl(void);
+void HidroDedup_GetStats(hidroDedupStats_t* pStats);
+void HidroDedup_ResetStats(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HIDRO_DEDUP_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
@@ -0,0 +1,134 @@
+/*! *********************************************************************************
+ * \addtogroup HIDRO KEY CACHE
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the hydrometer derived-key cache.
+*
+* The entries live in a hidro_table, keyed on dev_name; when the cache is full the
+* meter not heard for the longest CLOCK pass gives its entry to the new one.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "FunctionLib.h"
+#include "hidro_keycache.h"
+
+#if gHidroKeyCacheEnabled_d
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+#if (gHidroKeyCacheSize_c & (gHidroKeyCacheSize_c - 1)) || (gHidroKeyCacheSize_c > gHidroTableMaxSize_c)
+#error "gHidroKeyCacheSize_c must be a power of 2, up to gHidroTableMaxSize_c"
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+static hidroKeyCacheEntry_t mKeyCache[gHidroKeyCacheSize_c];
+static uint16_t mKeyCacheIndex[2 * gHidroKeyCacheSize_c];
+
+static hidroTable_t mKeyCacheTable = HidroTable_Init_m(mKeyCache, mKeyCacheIndex);
+
+static uint32_t mKeyCacheHits;
+static uint32_t mKeyCacheMisses;
+static uint32_t mKeyCacheEvictions;
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Drops all cached keys. Statistics are kept.
+ ********************************************************************************** */
+void HidroKeyCache_Reset(void)
+{
+    HidroTable_Reset(&mKeyCacheTable);
+}
+
+/*! *********************************************************************************
+ * \brief        Looks up the cached key of a meter.
+ *
+ * \param[in]    pDevName    Pointer to the gHidroDevNameSize_c bytes dev_name.
+ *
+ * \return       Pointer to the cache entry, or NULL on a miss.
+ ********************************************************************************** */
+const hidroKeyCacheEntry_t* HidroKeyCache_Find(const uint8_t* pDevName)
+{
+    const hidroKeyCacheEntry_t* pEntry = HidroTable_Find(&mKeyCacheTable, pDevName);
+
+    if (pEntry == NULL)
+    {
+        mKeyCacheMisses++;
+    }
+    else
+    {
+        mKeyCacheHits++;
+    }
+
+    return pEntry;
+}
+
+/*! *********************************************************************************
+ * \brief        Stores the derived key of a meter and expands its key schedule.
+ *               Must be called only after HidroKeyCache_Find() missed.
+ *
+ * \param[in]    pDevName    Pointer to the gHidroDevNameSize_c bytes dev_name.
+ * \param[in]    pKey        Pointer to the gHidroKeySize_c bytes derived key.
+ *
+ * \return       Pointer to the new cache entry.
+ ********************************************************************************** */
+const hidroKeyCacheEntry_t* HidroKeyCache_Insert(const uint8_t* pDevName, const uint8_t* pKey)
+{
+    hidroKeyCacheEntry_t* pEntry;
+
+    if (HidroTable_GetCount(&mKeyCacheTable) == gHidroKeyCacheSize_c)
+    {
+        mKeyCacheEvictions++;
+    }
+
+    pEntry = HidroTable_Insert(&mKeyCacheTable, pDevName);
+    CryptoAes_SetKey(&pEntry->key, pKey, gCryptoAesDecrypt_c);
+
+    return pEntry;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the cache hit/miss counters.
+ ********************************************************************************** */
+void HidroKeyCache_GetStats(hidroKeyCacheStats_t* pStats)
+{
+    pStats->hits = mKeyCacheHits;
+    pStats->misses = mKeyCacheMisses;
+    pStats->evictions = mKeyCacheEvictions;
+    pStats->entries = HidroTable_GetCount(&mKeyCacheTable);
+}
+
+/*! *********************************************************************************
+ * \brief        Clears the cache hit/miss counters.
+ ********************************************************************************** */
+void HidroKeyCache_ResetStats(void)
+{
+    mKeyCacheHits = 0;
+    mKeyCacheMisses = 0;
+    mKeyCacheEvictions = 0;
+}
+
+#endif /* gHidroKeyCacheEnabled_d */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
@@ -0,0 +1,94 @@
+/*! *********************************************************************************
+ * \defgroup HIDRO KEY CACHE
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the hydrometer derived-key cache. The cache
+* keeps, per meter, the AES key derived from its dev_name, prepared for the
+* crypto_aes backends (raw key and expanded key schedule), so that repeated
+* advertisements from the same meter skip both key derivation and key expansion.
+* Meter frames are only decrypted, so only the inverse cipher schedule is kept.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _HIDRO_KEYCACHE_H_
+#define _HIDRO_KEYCACHE_H_
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "EmbeddedTypes.h"
+#include "crypto_aes.h"
+#include "hidro_table.h"
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+/* Enables / Disables the derived-key cache */
+#ifndef gHidroKeyCacheEnabled_d
+#define gHidroKeyCacheEnabled_d         1
+#endif
+
+/* Number of meters kept in the cache. Must be a power of 2, up to gHidroTableMaxSize_c.
+ * Each entry takes about 200 bytes of RAM (the raw key and the decryption
+ * schedule), 6.4 KB for 32 meters; the index adds 4 bytes per entry. */
+#ifndef gHidroKeyCacheSize_c
+#define gHidroKeyCacheSize_c            32
+#endif
+
+/* Size of the derived AES key */
+#define gHidroKeySize_c                 16
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+typedef struct hidroKeyCacheEntry_tag
+{
+    hidroTableEntry_t   header;
+    cryptoAesKey_t      key;
+} hidroKeyCacheEntry_t;
+
+typedef struct hidroKeyCacheStats_tag
+{
+    uint32_t    hits;
+    uint32_t    misses;
+    uint32_t    evictions;
+    uint16_t    entries;
+} hidroKeyCacheStats_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if gHidroKeyCacheEnabled_d
+void HidroKeyCache_Reset(void);
+const hidroKeyCacheEntry_t* HidroKeyCache_Find(const uint8_t* pDevName);
+const hidroKeyCacheEntry_t* HidroKeyCache_Insert(const uint8_t* pDevName, const uint8_t* pKey);
+void HidroKeyCache_GetStats(hidroKeyCacheStats_t* pStats);
+void HidroKeyCache_ResetStats(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HIDRO_KEYCACHE_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
@@ -0,0 +1,171 @@
+/*! *********************************************************************************
+ * \addtogroup HIDRO READINGS
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the hydrometer latest-reading table.
+*
+* The readings live in a hidro_table keyed on dev_name, as the derived keys do.
+* When the table is full the meter not heard for the longest CLOCK pass is
+* replaced, and is reported as new the next time it is heard.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "FunctionLib.h"
+#include "TimersManager.h"
+#include "hidro_readings.h"
+
+#if gHidroReadingsEnabled_d
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+#if (gHidroReadingsSize_c & (gHidroReadingsSize_c - 1)) || (gHidroReadingsSize_c > gHidroTableMaxSize_c)
+#error "gHidroReadingsSize_c must be a power of 2, up to gHidroTableMaxSize_c"
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+static hidroReadingEntry_t mReadings[gHidroReadingsSize_c];
+static uint16_t mReadingsIndex[2 * gHidroReadingsSize_c];
+
+static hidroTable_t mReadingsTable = HidroTable_Init_m(mReadings, mReadingsIndex);
+
+static uint32_t mReadingsHeartbeatMs = gHidroReadingsHeartbeatS_c * 1000UL;
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Drops all readings. The next reading of every meter is reported.
+ ********************************************************************************** */
+void HidroReadings_Reset(void)
+{
+    HidroTable_Reset(&mReadingsTable);
+}
+
+/*! *********************************************************************************
+ * \brief        Stores the latest reading of a meter and tells whether it must be
+ *               reported.
+ *
+ * \param[in]    pDevName    Pointer to the gHidroDevNameSize_c bytes dev_name.
+ * \param[in]    acumulado   Accumulated volume.
+ * \param[in]    flags       Fraud flags (gHidroReadingFraudxxx_c).
+ * \param[in]    bateria     Battery voltage, 100 mV units.
+ *
+ * \return       0 if the reading did not change, otherwise the gHidroReadingxxx_c
+ *               reasons for reporting it.
+ ********************************************************************************** */
+uint8_t HidroReadings_Update
+(
+    const uint8_t*  pDevName,
+    uint32_t        acumulado,
+    uint8_t         flags,
+    uint8_t         bateria
+)
+{
+    hidroReadingEntry_t* pEntry;
+    uint32_t nowMs = (uint32_t)(TMR_GetTimestamp() / 1000);
+    uint8_t reasons = 0;
+
+    flags &= gHidroReadingFraudMask_c;
+    pEntry = HidroTable_Find(&mReadingsTable, pDevName);
+
+    if (pEntry == NULL)
+    {
+        pEntry = HidroTable_Insert(&mReadingsTable, pDevName);
+        reasons = gHidroReadingNew_c;
+    }
+    else
+    {
+        if (pEntry->acumulado != acumulado)
+        {
+            reasons |= gHidroReadingAcumulado_c;
+        }
+
+        if (pEntry->flags != flags)
+        {
+            reasons |= gHidroReadingFraud_c;
+        }
+
+        if ((pEntry->bateria / gHidroReadingsBatteryBucket_c) != (bateria / gHidroReadingsBatteryBucket_c))
+        {
+            reasons |= gHidroReadingBattery_c;
+        }
+
+        if (!reasons && mReadingsHeartbeatMs &&
+            ((uint32_t)(nowMs - pEntry->lastReportMs) >= mReadingsHeartbeatMs))
+        {
+            reasons = gHidroReadingHeartbeat_c;
+        }
+    }
+
+    pEntry->acumulado = acumulado;
+    pEntry->flags = flags;
+    pEntry->bateria = bateria;
+    pEntry->lastSeenMs = nowMs;
+
+    if (reasons)
+    {
+        pEntry->lastReportMs = nowMs;
+    }
+
+    return reasons;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the number of meters in the table.
+ ********************************************************************************** */
+uint16_t HidroReadings_GetCount(void)
+{
+    return HidroTable_GetCount(&mReadingsTable);
+}
+
+/*! *********************************************************************************
+ * \brief        Returns an entry of the table, for listing.
+ *
+ * \param[in]    index    0 to HidroReadings_GetCount() - 1.
+ *
+ * \return       Pointer to the entry, or NULL if index is out of range.
+ ********************************************************************************** */
+const hidroReadingEntry_t* HidroReadings_GetEntry(uint16_t index)
+{
+    return HidroTable_GetEntry(&mReadingsTable, index);
+}
+
+/*! *********************************************************************************
+ * \brief        Sets the heartbeat period, in seconds. 0 disables the heartbeat.
+ ********************************************************************************** */
+void HidroReadings_SetHeartbeat(uint32_t heartbeatS)
+{
+    mReadingsHeartbeatMs = heartbeatS * 1000UL;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the heartbeat period, in seconds.
+ ********************************************************************************** */
+uint32_t HidroReadings_GetHeartbeat(void)
+{
+    return mReadingsHeartbeatMs / 1000UL;
+}
+
+#endif /* gHidroReadingsEnabled_d */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
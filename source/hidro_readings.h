@@ -0,0 +1,117 @@
+/*! *********************************************************************************
+ * \defgroup HIDRO READINGS
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the hydrometer latest-reading table. The
+* table keeps the last decoded reading of each meter, so that a reading is
+* reported only when it differs from the previous one (acumulado, fraud flags or
+* battery bucket) or when the heartbeat period of the meter expired.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _HIDRO_READINGS_H_
+#define _HIDRO_READINGS_H_
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "EmbeddedTypes.h"
+#include "hidro_table.h"
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+/* Enables / Disables the latest-reading table */
+#ifndef gHidroReadingsEnabled_d
+#define gHidroReadingsEnabled_d         1
+#endif
+
+/* Number of meters kept in the table. Must be a power of 2, up to gHidroTableMaxSize_c.
+ * Each meter takes 24 bytes of RAM with its index slots. The table is a cache of the
+ * meters in range, not of the whole population: 5000 meters would take 120 KB, nearly
+ * all of the QN9080 RAM. Past the table size, the meter not heard for the longest is
+ * replaced and its next reading is reported as new (gHidroReadingNew_c), so a
+ * larger population costs extra reports, not lost ones. */
+#ifndef gHidroReadingsSize_c
+#define gHidroReadingsSize_c            128
+#endif
+
+/* A reading is reported again after this many seconds even if unchanged. 0 disables. */
+#ifndef gHidroReadingsHeartbeatS_c
+#define gHidroReadingsHeartbeatS_c      3600
+#endif
+
+/* Width of a battery bucket, in 100 mV units (bateria field) */
+#ifndef gHidroReadingsBatteryBucket_c
+#define gHidroReadingsBatteryBucket_c   2
+#endif
+
+/* Fraud bits compared between readings, in hidroReadingEntry_t.flags */
+#define gHidroReadingFraudMagnetic_c    (1 << 0)
+#define gHidroReadingFraudMovement_c    (1 << 1)
+#define gHidroReadingFraudMask_c        (gHidroReadingFraudMagnetic_c | gHidroReadingFraudMovement_c)
+
+/* Reasons returned by HidroReadings_Update() */
+#define gHidroReadingNew_c              (1 << 0)
+#define gHidroReadingAcumulado_c        (1 << 1)
+#define gHidroReadingFraud_c            (1 << 2)
+#define gHidroReadingBattery_c          (1 << 3)
+#define gHidroReadingHeartbeat_c        (1 << 4)
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+typedef struct hidroReadingEntry_tag
+{
+    hidroTableEntry_t   header;
+    uint8_t             flags;
+    uint8_t             bateria;
+    uint32_t            acumulado;
+    uint32_t            lastSeenMs;
+    uint32_t            lastReportMs;
+} hidroReadingEntry_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if gHidroReadingsEnabled_d
+void HidroReadings_Reset(void);
+uint8_t HidroReadings_Update
+(
+    const uint8_t*  pDevName,
+    uint32_t        acumulado,
+    uint8_t         flags,
+    uint8_t         bateria
+);
+uint16_t HidroReadings_GetCount(void);
+const hidroReadingEntry_t* HidroReadings_GetEntry(uint16_t index);
+void HidroReadings_SetHeartbeat(uint32_t heartbeatS);
+uint32_t HidroReadings_GetHeartbeat(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HIDRO_READINGS_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
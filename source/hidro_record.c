@@ -0,0 +1,68 @@
+/*! *********************************************************************************
+ * \addtogroup HIDRO RECORD
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the binary meter reading records.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "FunctionLib.h"
+#include "crc16.h"
+#include "hidro_record.h"
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Returns where the record is filled in a frame buffer, so that it
+ *               is encoded in place by HidroRecord_Encode().
+ *
+ * \param[in]    pFrame      Pointer to gHidroRecordFrameMaxSize_c bytes.
+ *
+ * \return       Pointer to the record, in pFrame.
+ ********************************************************************************** */
+hidroRecord_t* HidroRecord_GetRecord(uint8_t* pFrame)
+{
+    return (hidroRecord_t*)&pFrame[gHidroRecordInPlaceOffset_c];
+}
+
+/*! *********************************************************************************
+ * \brief        Builds the frame of the record filled in pFrame: CRC, COBS
+ *               encoding and delimiter, without copying the record.
+ *
+ * \param[in,out] pFrame     Pointer to gHidroRecordFrameMaxSize_c bytes, holding
+ *                           the record at HidroRecord_GetRecord(pFrame).
+ *
+ * \return       Length of the frame, delimiter included.
+ ********************************************************************************** */
+uint8_t HidroRecord_Encode(uint8_t* pFrame)
+{
+    uint8_t* pRaw = &pFrame[gHidroRecordInPlaceOffset_c];
+    uint16_t crc;
+    uint8_t length;
+
+    crc = crc16_ccitt(pRaw, sizeof(hidroRecord_t));
+    pRaw[sizeof(hidroRecord_t)] = (uint8_t)crc;
+    pRaw[sizeof(hidroRecord_t) + 1] = (uint8_t)(crc >> 8);
+
+    length = (uint8_t)cobs_encode(pRaw, gHidroRecordRawSize_c, pFrame);
+    pFrame[length++] = COBS_DELIMITER;
+
+    return length;
+}
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
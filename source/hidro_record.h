@@ -0,0 +1,100 @@
+/*! *********************************************************************************
+ * \defgroup HIDRO RECORD
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the binary meter reading records.
+*
+* In binary output mode every valid reading is written to the shell UART as one
+* frame:
+*
+*   COBS( hidroRecord_t | crc16 ) 0x00
+*
+* - hidroRecord_t is packed, multi-byte fields are little endian;
+* - crc16 is CRC-16/CCITT-FALSE (see crc16.h) of the record, little endian;
+* - the frame is COBS encoded (see cobs.h) and terminated by 0x00, so a reader
+*   resynchronizes on the next 0x00 even if text is interleaved on the link.
+*
+* The frames are decoded on the host by tools/hidro_record_decode.py.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _HIDRO_RECORD_H_
+#define _HIDRO_RECORD_H_
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "EmbeddedTypes.h"
+#include "cobs.h"
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+/* Layout version, first byte of every record */
+#define gHidroRecordVersion_c           0x01
+
+#define gHidroRecordNameSize_c          10
+#define gHidroRecordHistSize_c          9
+
+/* hidroRecord_t.flags */
+#define gHidroRecordFraudMagnetic_c     (1 << 0)
+#define gHidroRecordFraudMovement_c     (1 << 1)
+#define gHidroRecordSignature_c         (1 << 2)
+
+/* Size of a record plus its CRC, before encoding */
+#define gHidroRecordRawSize_c           (sizeof(hidroRecord_t) + sizeof(uint16_t))
+
+/* Maximum size of an encoded frame, delimiter included */
+#define gHidroRecordFrameMaxSize_c      (COBS_ENCODED_MAX_SIZE(gHidroRecordRawSize_c) + 1)
+
+/* Position of the record in the frame buffer, before it is encoded in place */
+#define gHidroRecordInPlaceOffset_c     COBS_IN_PLACE_OFFSET(gHidroRecordRawSize_c)
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+typedef PACKED_STRUCT hidroRecord_tag
+{
+    uint8_t     version;                            /* gHidroRecordVersion_c */
+    uint8_t     address[6];                         /* advertiser address, as received */
+    uint8_t     name[gHidroRecordNameSize_c];       /* decoded device name, ASCII */
+    uint32_t    acumulado;                          /* accumulated volume, 10 L units */
+    uint8_t     bateria;                            /* battery voltage, 100 mV units */
+    uint8_t     flags;                              /* gHidroRecordFraudxxx_c / Signature */
+    uint8_t     hist[gHidroRecordHistSize_c];       /* consumption history, as sent */
+    int8_t      rssi;                               /* dBm */
+    uint32_t    timestampMs;                        /* gateway time of reception */
+} hidroRecord_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+hidroRecord_t* HidroRecord_GetRecord(uint8_t* pFrame);
+uint8_t HidroRecord_Encode(uint8_t* pFrame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HIDRO_RECORD_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
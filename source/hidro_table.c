@@ -0,0 +1,264 @@
+/*! *********************************************************************************
+ * \addtogroup HIDRO TABLE
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the per-meter table.
+*
+* The index is twice the table size, so probe sequences stay short, and entries
+* are removed by shifting back the probe chain that follows them, so no tombstones
+* are needed. Every lookup hit sets the entry's referenced flag; when the table is
+* full the CLOCK hand clears flags until it finds an entry that was not used since
+* its last pass, and that entry is reused.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "FunctionLib.h"
+#include "hidro_table.h"
+
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+#define mHidroTableEmptySlot_c          0xFFFF
+
+#define mHidroTableIndexMask_m(pTable)  ((uint16_t)(2 * (pTable)->size - 1))
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Returns an entry by number.
+ ********************************************************************************** */
+static hidroTableEntry_t* HidroTable_Entry(const hidroTable_t* pTable, uint16_t entryIdx)
+{
+    return (hidroTableEntry_t*)(pTable->pEntries + (uint32_t)entryIdx * pTable->entrySize);
+}
+
+/*! *********************************************************************************
+ * \brief        FNV-1a hash of a dev_name, folded to an index slot.
+ ********************************************************************************** */
+static uint16_t HidroTable_Hash(const hidroTable_t* pTable, const uint8_t* pDevName)
+{
+    uint32_t hash = 2166136261U;
+    uint8_t i;
+
+    for (i = 0; i < gHidroDevNameSize_c; i++)
+    {
+        hash ^= pDevName[i];
+        hash *= 16777619U;
+    }
+
+    return (uint16_t)((hash ^ (hash >> 16)) & mHidroTableIndexMask_m(pTable));
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the index slot that holds pDevName, or the empty slot
+ *               where it should be inserted.
+ ********************************************************************************** */
+static uint16_t HidroTable_Probe(const hidroTable_t* pTable, const uint8_t* pDevName)
+{
+    uint16_t slot = HidroTable_Hash(pTable, pDevName);
+
+    while (pTable->pIndex[slot] != mHidroTableEmptySlot_c)
+    {
+        if (FLib_MemCmp(HidroTable_Entry(pTable, pTable->pIndex[slot])->devName, (void*)pDevName, gHidroDevNameSize_c))
+        {
+            break;
+        }
+
+        slot = (slot + 1) & mHidroTableIndexMask_m(pTable);
+    }
+
+    return slot;
+}
+
+/*! *********************************************************************************
+ * \brief        Removes an index slot, shifting back the entries of the probe
+ *               chain that follows it.
+ ********************************************************************************** */
+static void HidroTable_RemoveSlot(hidroTable_t* pTable, uint16_t slot)
+{
+    uint16_t mask = mHidroTableIndexMask_m(pTable);
+    uint16_t next = slot;
+    uint16_t home;
+
+    for (;;)
+    {
+        next = (next + 1) & mask;
+
+        if (pTable->pIndex[next] == mHidroTableEmptySlot_c)
+        {
+            break;
+        }
+
+        home = HidroTable_Hash(pTable, HidroTable_Entry(pTable, pTable->pIndex[next])->devName);
+
+        /* Move the element back only if its home slot is not in (slot, next] */
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            pTable->pIndex[slot] = pTable->pIndex[next];
+            slot = next;
+        }
+    }
+
+    pTable->pIndex[slot] = mHidroTableEmptySlot_c;
+}
+
+/*! *********************************************************************************
+ * \brief        Selects an entry to be reused, using the CLOCK algorithm.
+ ********************************************************************************** */
+static uint16_t HidroTable_Evict(hidroTable_t* pTable)
+{
+    hidroTableEntry_t* pEntry;
+    uint16_t victim;
+
+    for (;;)
+    {
+        pEntry = HidroTable_Entry(pTable, pTable->hand);
+
+        if (!pEntry->referenced)
+        {
+            break;
+        }
+
+        pEntry->referenced = 0;
+        pTable->hand = (pTable->hand + 1) & (pTable->size - 1);
+    }
+
+    victim = pTable->hand;
+    pTable->hand = (pTable->hand + 1) & (pTable->size - 1);
+
+    HidroTable_RemoveSlot(pTable, HidroTable_Probe(pTable, pEntry->devName));
+
+    return victim;
+}
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+ * \brief        Drops all entries.
+ ********************************************************************************** */
+void HidroTable_Reset(hidroTable_t* pTable)
+{
+    FLib_MemSet(pTable->pIndex, 0xFF, 2 * pTable->size * sizeof(uint16_t));
+    pTable->count = 0;
+    pTable->hand = 0;
+    pTable->initialized = TRUE;
+}
+
+/*! *********************************************************************************
+ * \brief        Looks up the entry of a meter and marks it as referenced.
+ *
+ * \param[in]    pTable      Pointer to the table.
+ * \param[in]    pDevName    Pointer to the gHidroDevNameSize_c bytes dev_name.
+ *
+ * \return       Pointer to the entry, or NULL on a miss.
+ ********************************************************************************** */
+void* HidroTable_Find(hidroTable_t* pTable, const uint8_t* pDevName)
+{
+    hidroTableEntry_t* pEntry;
+    uint16_t slot;
+
+    if (!pTable->initialized)
+    {
+        HidroTable_Reset(pTable);
+    }
+
+    slot = HidroTable_Probe(pTable, pDevName);
+
+    if (pTable->pIndex[slot] == mHidroTableEmptySlot_c)
+    {
+        return NULL;
+    }
+
+    pEntry = HidroTable_Entry(pTable, pTable->pIndex[slot]);
+    pEntry->referenced = 1;
+
+    return pEntry;
+}
+
+/*! *********************************************************************************
+ * \brief        Adds the entry of a meter, replacing the CLOCK victim if the table
+ *               is full. Must be called only after HidroTable_Find() missed. The
+ *               header is set, the rest of the entry is left to the caller.
+ *
+ * \param[in]    pTable      Pointer to the table.
+ * \param[in]    pDevName    Pointer to the gHidroDevNameSize_c bytes dev_name.
+ *
+ * \return       Pointer to the new entry.
+ ********************************************************************************** */
+void* HidroTable_Insert(hidroTable_t* pTable, const uint8_t* pDevName)
+{
+    hidroTableEntry_t* pEntry;
+    uint16_t entryIdx;
+
+    if (!pTable->initialized)
+    {
+        HidroTable_Reset(pTable);
+    }
+
+    if (pTable->count < pTable->size)
+    {
+        entryIdx = pTable->count++;
+    }
+    else
+    {
+        entryIdx = HidroTable_Evict(pTable);
+    }
+
+    pEntry = HidroTable_Entry(pTable, entryIdx);
+    FLib_MemCpy(pEntry->devName, (void*)pDevName, gHidroDevNameSize_c);
+    pEntry->referenced = 0;
+
+    /* Probed after the eviction, which may have shifted the chain of pDevName */
+    pTable->pIndex[HidroTable_Probe(pTable, pDevName)] = entryIdx;
+
+    return pEntry;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns the number of entries in the table.
+ ********************************************************************************** */
+uint16_t HidroTable_GetCount(const hidroTable_t* pTable)
+{
+    return pTable->initialized ? pTable->count : 0;
+}
+
+/*! *********************************************************************************
+ * \brief        Returns an entry of the table, for listing.
+ *
+ * \param[in]    pTable    Pointer to the table.
+ * \param[in]    index     0 to HidroTable_GetCount() - 1.
+ *
+ * \return       Pointer to the entry, or NULL if index is out of range.
+ ********************************************************************************** */
+void* HidroTable_GetEntry(const hidroTable_t* pTable, uint16_t index)
+{
+    if (index >= HidroTable_GetCount(pTable))
+    {
+        return NULL;
+    }
+
+    return HidroTable_Entry(pTable, index);
+}
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
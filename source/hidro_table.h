@@ -0,0 +1,93 @@
+/*! *********************************************************************************
+ * \defgroup HIDRO TABLE
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the per-meter table shared by the hydrometer
+* derived-key cache and latest-reading table. Entries are keyed on dev_name and
+* located through an open-addressing (linear probing) index twice the table size.
+* When the table is full an entry is replaced with the CLOCK algorithm.
+*
+* Every entry type starts with a hidroTableEntry_t; the table only knows the entry
+* size, so one implementation serves entries of any layout.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _HIDRO_TABLE_H_
+#define _HIDRO_TABLE_H_
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "EmbeddedTypes.h"
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+/* Size of the dev_name field that identifies a meter */
+#define gHidroDevNameSize_c             5
+
+/* Largest table, the index slots are 16 bit entry numbers */
+#define gHidroTableMaxSize_c            16384
+
+/* Static initializer of a table over an entry array and an index array of
+ * 2 * NumberOfElements(entries) slots. The size must be a power of 2. */
+#define HidroTable_Init_m(entries, index)                                           \
+    { (uint8_t*)(entries), (index), sizeof((entries)[0]), NumberOfElements(entries), \
+      0, 0, FALSE }
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+/* Header of every table entry, must be the first member of the entry type */
+typedef struct hidroTableEntry_tag
+{
+    uint8_t     devName[gHidroDevNameSize_c];
+    uint8_t     referenced;
+} hidroTableEntry_t;
+
+typedef struct hidroTable_tag
+{
+    uint8_t*    pEntries;
+    uint16_t*   pIndex;         /* Index slot -> entry number, or empty */
+    uint16_t    entrySize;
+    uint16_t    size;
+    uint16_t    count;
+    uint16_t    hand;
+    bool_t      initialized;
+} hidroTable_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void HidroTable_Reset(hidroTable_t* pTable);
+void* HidroTable_Find(hidroTable_t* pTable, const uint8_t* pDevName);
+void* HidroTable_Insert(hidroTable_t* pTable, const uint8_t* pDevName);
+uint16_t HidroTable_GetCount(const hidroTable_t* pTable);
+void* HidroTable_GetEntry(const hidroTable_t* pTable, uint16_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HIDRO_TABLE_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
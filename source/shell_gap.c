@@ -48,13 +48,21 @@
 /* LOGICALIS_HAL */
 #include "aes.h"
 #include "log_uart.h"
+#include "crc16.h"
+
+#include "hidro_keycache.h"
+#include "crypto_aes.h"
+#include "hidro_dedup.h"
+#include "hidro_record.h"
+#include "hidro_readings.h"
+#include "ad_iterator.h"
 //#include "fsl_aes.h"
 /************************************************************************************
 *************************************************************************************
 * Private macros
 *************************************************************************************
 ************************************************************************************/
-#define mShellGapCmdsCount_c                20
+#define mShellGapCmdsCount_c                NumberOfElements(mGapShellCmds)
 #define mShellGapMaxScannedDevicesCount_c   30		//kannebley:max scanned devices
 #define mShellGapMaxDeviceNameLength_c      20
 /************************************************************************************
@@ -62,12 +70,6 @@
 * Private type definitions
 *************************************************************************************
 ************************************************************************************/
-typedef struct gapCmds_tag
-{
-    char*       name;
-    int8_t      (*cmd)(uint8_t argc, char * argv[]);
-}gapCmds_t;
-
 typedef struct gapScannedDevices_tag
 {
     bleAddressType_t    addrType;
@@ -123,36 +125,62 @@ static int8_t ShellGap_Pair(uint8_t argc, char * argv[]);
 static int8_t ShellGap_PairCfg(uint8_t argc, char * argv[]);
 static int8_t ShellGap_EnterPasskey(uint8_t argc, char * argv[]);
 static int8_t ShellGap_Bonds(uint8_t argc, char * argv[]);
+
+#if gHidroKeyCacheEnabled_d
+static int8_t ShellGap_KeyCache(uint8_t argc, char * argv[]);
+#endif
+static int8_t ShellGap_Aes(uint8_t argc, char * argv[]);
+static int8_t ShellGap_Output(uint8_t argc, char * argv[]);
+#if gHidroReadingsEnabled_d
+static int8_t ShellGap_Readings(uint8_t argc, char * argv[]);
+#endif
+#if gHidroDedupEnabled_d
+static int8_t ShellGap_Dedup(uint8_t argc, char * argv[]);
+#endif
+#if gAppScanRingSize_c
+static int8_t ShellGap_ScanRing(uint8_t argc, char * argv[]);
+#endif
+
 /************************************************************************************
 *************************************************************************************
 * Private memory declarations
 *************************************************************************************
 ************************************************************************************/
-const gapCmds_t mGapShellCmds[mShellGapCmdsCount_c] =
+/* Sorted by name (strcmp order), searched with shell_exec_subcommand() */
+const shell_subcmd_t mGapShellCmds[] =
 {
     {"address",     ShellGap_DeviceAddress},
-    {"devicename",  ShellGap_DeviceName},
-
-    {"advstart",    ShellGap_StartAdvertising},
-    {"advstop",     ShellGap_StopAdvertising},
     {"advcfg",      ShellGap_SetAdvertisingParameters},
     {"advdata",     ShellGap_ChangeAdvertisingData},
-
-    {"scanstart",   ShellGap_StartScanning},
-    {"scanstop",    ShellGap_StopScanning},
-    {"scancfg",     ShellGap_SetScanParameters},
-    {"scandata",    ShellGap_ChangeScanData},
-
+    {"advstart",    ShellGap_StartAdvertising},
+    {"advstop",     ShellGap_StopAdvertising},
+    {"aes",         ShellGap_Aes},
+    {"bonds",       ShellGap_Bonds},
     {"connect",     ShellGap_Connect},
     {"connectcfg",  ShellGap_SetConnectionParameters},
-    {"disconnect",  ShellGap_Disconnect},
     {"connupdate",  ShellGap_UpdateConnection},
-
+#if gHidroDedupEnabled_d
+    {"dedup",       ShellGap_Dedup},
+#endif
+    {"devicename",  ShellGap_DeviceName},
+    {"disconnect",  ShellGap_Disconnect},
+    {"enterpin",    ShellGap_EnterPasskey},
+#if gHidroKeyCacheEnabled_d
+    {"keycache",    ShellGap_KeyCache},
+#endif
+    {"output",      ShellGap_Output},
     {"pair",        ShellGap_Pair},
     {"paircfg",     ShellGap_PairCfg},
-    {"enterpin",    ShellGap_EnterPasskey},
-    {"bonds",       ShellGap_Bonds},
-
+#if gHidroReadingsEnabled_d
+    {"readings",    ShellGap_Readings},
+#endif
+    {"scancfg",     ShellGap_SetScanParameters},
+    {"scandata",    ShellGap_ChangeScanData},
+#if gAppScanRingSize_c
+    {"scanring",    ShellGap_ScanRing},
+#endif
+    {"scanstart",   ShellGap_StartScanning},
+    {"scanstop",    ShellGap_StopScanning},
 };
 
 static bool_t mAdvOn = FALSE;
@@ -184,7 +212,8 @@ struct {
 } __attribute__((packed))hidroPayload;
 
 /* kannebley:package struct for assignment */
-struct {
+/* Mapped in place over the advertising data of a meter */
+typedef PACKED_STRUCT hidroPackage_tag {
 	uint8_t  len_data;
 	uint8_t  type_data;
 	uint8_t  dev_name[5];
@@ -193,7 +222,19 @@ struct {
 	uint8_t  len_id;
 	uint8_t  type_id;
 	uint8_t  name_id[4];
-} __attribute__((packed))hidroPackage;
+} hidroPackage_t;
+
+/* Key used to derive the meter keys from the device name, expanded on first use */
+static cryptoAesKey_t mHidroSeedKey;
+static bool_t mHidroSeedKeyReady = FALSE;
+
+/* Meter readings are written as binary records (hidro_record.h) instead of text */
+static bool_t mHidroBinaryOutput = FALSE;
+
+#if gHidroReadingsEnabled_d
+/* Only readings that changed (or whose heartbeat expired) are reported */
+static bool_t mHidroChangesOnly = FALSE;
+#endif
 
 /************************************************************************************
 *************************************************************************************
@@ -214,21 +255,7 @@ static char     mDeviceName[mMaxCharValueLength_d + 1]="";
 ************************************************************************************/
 int8_t ShellGap_Command(uint8_t argc, char * argv[])
 {
-    uint8_t i;
-
-    if (argc < 2)
-    {
-        return CMD_RET_USAGE;
-    }
-
-    for (i=0; i< mShellGapCmdsCount_c; i++)
-    {
-        if(!strcmp((char*)argv[1], mGapShellCmds[i].name) )
-        {
-            return mGapShellCmds[i].cmd(argc-2, (char **)(&argv[2]));
-        }
-    }
-    return CMD_RET_USAGE;
+    return shell_exec_subcommand(argc, argv, mGapShellCmds, mShellGapCmdsCount_c);
 }
 /************************************************************************************
 *************************************************************************************
@@ -354,11 +381,10 @@ static int8_t ShellGap_SetAdvertisingParameters(uint8_t argc, char * argv[])
 
     if (argc == 0)
     {
-        shell_write("\n\r-->  Advertising Parameters:");
-        shell_write("\n\r    -->  Advertising Interval: ");
-        shell_writeDec(gAdvParams.maxInterval * 625 / 1000);
-        shell_write(" ms");
-        shell_write("\n\r    -->  Advertising Type: ");
+        shell_printf("\n\r-->  Advertising Parameters:"
+                     "\n\r    -->  Advertising Interval: %u ms"
+                     "\n\r    -->  Advertising Type: ",
+                     gAdvParams.maxInterval * 625 / 1000);
 
         switch(gAdvParams.advertisingType)
         {
@@ -570,16 +596,13 @@ static int8_t ShellGap_SetScanParameters(uint8_t argc, char * argv[])
 
     if (argc == 0)
     {
-        shell_write("\n\r-->  Scan Parameters:");
-        shell_write("\n\r    -->  Scan Interval: ");
-        shell_writeDec(gAppScanParams.interval * 625 / 1000);
-        shell_write(" ms");
-        shell_write("\n\r    -->  Scan Window: ");
-        shell_writeDec(gAppScanParams.window * 625 / 1000);
-        shell_write(" ms");
-        shell_write("\n\r    -->  Scan Type: ");
-        (gAppScanParams.type) ? shell_write("ACTIVE") : shell_write("PASSIVE");
-        SHELL_NEWLINE();
+        shell_printf("\n\r-->  Scan Parameters:"
+                     "\n\r    -->  Scan Interval: %u ms"
+                     "\n\r    -->  Scan Window: %u ms"
+                     "\n\r    -->  Scan Type: %s\n\r",
+                     gAppScanParams.interval * 625 / 1000,
+                     gAppScanParams.window * 625 / 1000,
+                     (gAppScanParams.type) ? "ACTIVE" : "PASSIVE");
         return CMD_RET_SUCCESS;
     }
 
@@ -732,19 +755,13 @@ static int8_t ShellGap_SetConnectionParameters(uint8_t argc, char * argv[])
 
     if (bValidCmd)
     {
-        shell_write("\n\r-->  Connection Parameters:");
-        shell_write("\n\r    -->  Connection Interval: ");
-        shell_writeDec(gConnReqParams.connIntervalMax * 10 / 8);
-        shell_write(" ms");
-
-        shell_write("\n\r    -->  Connection Latency: ");
-        shell_writeDec(gConnReqParams.connLatency);
-
-        shell_write("\n\r    -->  Supervision Timeout: ");
-        shell_writeDec(gConnReqParams.supervisionTimeout * 10);
-        shell_write(" ms\n\r");
-
-        SHELL_NEWLINE();
+        shell_printf("\n\r-->  Connection Parameters:"
+                     "\n\r    -->  Connection Interval: %u ms"
+                     "\n\r    -->  Connection Latency: %u"
+                     "\n\r    -->  Supervision Timeout: %u ms\n\r\n\r",
+                     gConnReqParams.connIntervalMax * 10 / 8,
+                     gConnReqParams.connLatency,
+                     gConnReqParams.supervisionTimeout * 10);
         return CMD_RET_SUCCESS;
     }
     else
@@ -855,17 +872,13 @@ static int8_t ShellGap_PairCfg(uint8_t argc, char * argv[])
 
     if (bValidCmd)
     {
-        shell_write("\n\r-->  Pairing Configuration:");
-        shell_write("\n\r    -->  Use Bonding: ");
-        shell_writeBool(gPairingParameters.withBonding);
-
-        shell_write("\n\r    -->  SecurityLevel: ");
-        shell_writeHex((uint8_t*)&gPairingParameters.securityModeAndLevel, 1);
-
-        shell_write("\n\r    -->  Flags: ");
-        shell_writeHex((uint8_t*)&gPairingParameters.centralKeys, 1);
-
-        SHELL_NEWLINE();
+        shell_printf("\n\r-->  Pairing Configuration:"
+                     "\n\r    -->  Use Bonding: %s"
+                     "\n\r    -->  SecurityLevel: %02X"
+                     "\n\r    -->  Flags: %02X\n\r",
+                     gPairingParameters.withBonding ? "TRUE" : "FALSE",
+                     *(uint8_t*)&gPairingParameters.securityModeAndLevel,
+                     *(uint8_t*)&gPairingParameters.centralKeys);
         return CMD_RET_SUCCESS;
     }
     else
@@ -920,19 +933,10 @@ static int8_t ShellGap_Bonds(uint8_t argc, char * argv[])
 
                 for (i=0; i<count;i++)
                 {
-                    shell_write("\n\r-->  ");
-                    shell_writeDec(i);
-                    shell_write(". ");
                     Gap_GetBondedDeviceName(i, pBuffer, mShellGapMaxDeviceNameLength_c);
 
-                    if (strlen(pBuffer) > 0)
-                    {
-                        shell_write(pBuffer);
-                    }
-                    else
-                    {
-                        shell_write("[No saved name]");
-                    }
+                    shell_printf("\n\r-->  %u. %s", i,
+                                 (strlen(pBuffer) > 0) ? (char*)pBuffer : "[No saved name]");
                 }
                 SHELL_NEWLINE();
                 result = CMD_RET_SUCCESS;
@@ -1001,14 +1005,345 @@ static int8_t ShellGap_Bonds(uint8_t argc, char * argv[])
     return result;
 }
 
+#if gHidroKeyCacheEnabled_d
+static int8_t ShellGap_KeyCache(uint8_t argc, char * argv[])
+{
+    hidroKeyCacheStats_t stats;
+
+    switch(argc)
+    {
+        case 0:
+        {
+            HidroKeyCache_GetStats(&stats);
+
+            shell_printf("\n\r-->  Key Cache:"
+                         "\n\r    -->  Entries: %u / %u"
+                         "\n\r    -->  Hits: %u"
+                         "\n\r    -->  Misses: %u"
+                         "\n\r    -->  Evictions: %u\n\r",
+                         stats.entries, gHidroKeyCacheSize_c,
+                         stats.hits, stats.misses, stats.evictions);
+            return CMD_RET_SUCCESS;
+        }
+
+        case 1:
+        {
+            if(!strcmp((char*)argv[0], "-reset"))
+            {
+                HidroKeyCache_Reset();
+                HidroKeyCache_ResetStats();
+                shell_write("\n\r-->  Key Cache Erased.\n\r");
+                return CMD_RET_SUCCESS;
+            }
+            return CMD_RET_USAGE;
+        }
+
+        default:
+            return CMD_RET_USAGE;
+    }
+}
+#endif
+
+static int8_t ShellGap_Aes(uint8_t argc, char * argv[])
+{
+    uint8_t backend;
+
+    switch(argc)
+    {
+        case 0:
+        {
+            shell_printf("\n\r-->  AES backend: %s"
+                         "\n\r    -->  Available:",
+                         CryptoAes_GetBackendName(CryptoAes_GetBackend()));
+
+            for (backend = 0; backend < gCryptoAesBackendCount_c; backend++)
+            {
+                if (CryptoAes_IsBackendAvailable((cryptoAesBackend_t)backend))
+                {
+                    shell_printf(" %s", CryptoAes_GetBackendName((cryptoAesBackend_t)backend));
+                }
+            }
+            SHELL_NEWLINE();
+            return CMD_RET_SUCCESS;
+        }
+
+        case 1:
+        {
+            for (backend = 0; backend < gCryptoAesBackendCount_c; backend++)
+            {
+                if(!strcmp((char*)argv[0], CryptoAes_GetBackendName((cryptoAesBackend_t)backend)))
+                {
+                    if (!CryptoAes_SetBackend((cryptoAesBackend_t)backend))
+                    {
+                        shell_write("\n\r-->  AES backend not available.\n\r");
+                        return CMD_RET_FAILURE;
+                    }
+
+                    shell_write("\n\r-->  AES backend: ");
+                    shell_write(argv[0]);
+                    SHELL_NEWLINE();
+                    return CMD_RET_SUCCESS;
+                }
+            }
+            return CMD_RET_USAGE;
+        }
+
+        default:
+            return CMD_RET_USAGE;
+    }
+}
+
+#if gHidroDedupEnabled_d
+static int8_t ShellGap_Dedup(uint8_t argc, char * argv[])
+{
+    hidroDedupStats_t stats;
+
+    switch(argc)
+    {
+        case 0:
+        {
+            HidroDedup_GetStats(&stats);
+
+            shell_printf("\n\r-->  Duplicate Filter:"
+                         "\n\r    -->  TTL (ms): %u"
+                         "\n\r    -->  Processed: %u"
+                         "\n\r    -->  Suppressed: %u"
+                         "\n\r    -->  Evictions: %u\n\r",
+                         HidroDedup_GetTtl(), stats.processed,
+                         stats.suppressed, stats.evictions);
+            return CMD_RET_SUCCESS;
+        }
+
+        case 1:
+        {
+            if(!strcmp((char*)argv[0], "-reset"))
+            {
+                HidroDedup_Reset();
+                HidroDedup_ResetStats();
+                shell_write("\n\r-->  Duplicate Filter Erased.\n\r");
+                return CMD_RET_SUCCESS;
+            }
+            return CMD_RET_USAGE;
+        }
+
+        case 2:
+        {
+            if(!strcmp((char*)argv[0], "-ttl"))
+            {
+                HidroDedup_SetTtl((uint32_t)atoi(argv[1]));
+                return CMD_RET_SUCCESS;
+            }
+            return CMD_RET_USAGE;
+        }
+
+        default:
+            return CMD_RET_USAGE;
+    }
+}
+#endif
+
+#if gAppScanRingSize_c
+static int8_t ShellGap_ScanRing(uint8_t argc, char * argv[])
+{
+    appScanRingStats_t stats;
+
+    switch(argc)
+    {
+        case 0:
+        {
+            App_GetScanRingStats(&stats);
+
+            shell_printf("\n\r-->  Scan Report Ring:"
+                         "\n\r    -->  Size: %u, drop %s"
+                         "\n\r    -->  Received: %u"
+                         "\n\r    -->  Dropped: %u"
+                         "\n\r    -->  Pending: %u"
+                         "\n\r    -->  High-water mark: %u\n\r",
+                         gAppScanRingSize_c,
+                         (gAppScanRingPolicy_c == gAppScanRingDropOldest_c) ? "oldest" : "newest",
+                         stats.received, stats.dropped, stats.pending, stats.highWaterMark);
+            return CMD_RET_SUCCESS;
+        }
+
+        case 1:
+        {
+            if(!strcmp((char*)argv[0], "-reset"))
+            {
+                App_ResetScanRingStats();
+                return CMD_RET_SUCCESS;
+            }
+            return CMD_RET_USAGE;
+        }
+
+        default:
+            return CMD_RET_USAGE;
+    }
+}
+#endif
+
+static int8_t ShellGap_Output(uint8_t argc, char * argv[])
+{
+    switch(argc)
+    {
+        case 0:
+        {
+            shell_printf("\n\r-->  Output: %s\n\r", mHidroBinaryOutput ? "binary" : "text");
+            return CMD_RET_SUCCESS;
+        }
+
+        case 1:
+        {
+            if(!strcmp((char*)argv[0], "binary"))
+            {
+                mHidroBinaryOutput = TRUE;
+                return CMD_RET_SUCCESS;
+            }
+            else if(!strcmp((char*)argv[0], "text"))
+            {
+                mHidroBinaryOutput = FALSE;
+                return CMD_RET_SUCCESS;
+            }
+            return CMD_RET_USAGE;
+        }
+
+        default:
+            return CMD_RET_USAGE;
+    }
+}
+
+#if gHidroReadingsEnabled_d
+static int8_t ShellGap_Readings(uint8_t argc, char * argv[])
+{
+    const hidroReadingEntry_t* pEntry;
+    uint32_t nowMs;
+    uint16_t i;
+
+    switch(argc)
+    {
+        case 0:
+        {
+            shell_printf("\n\r-->  Readings:"
+                         "\n\r    -->  Meters: %u / %u"
+                         "\n\r    -->  Report: %s"
+                         "\n\r    -->  Heartbeat (s): %u\n\r",
+                         HidroReadings_GetCount(), gHidroReadingsSize_c,
+                         mHidroChangesOnly ? "changes" : "all",
+                         HidroReadings_GetHeartbeat());
+            return CMD_RET_SUCCESS;
+        }
+
+        case 1:
+        {
+            if(!strcmp((char*)argv[0], "-dump"))
+            {
+                nowMs = (uint32_t)(TMR_GetTimestamp() / 1000);
+
+                for (i = 0; i < HidroReadings_GetCount(); i++)
+                {
+                    pEntry = HidroReadings_GetEntry(i);
+
+                    shell_write("\n\r");
+                    shell_writeHex((uint8_t*)pEntry->header.devName, gHidroDevNameSize_c);
+                    shell_printf("  %u L  %u mV  fraud %u  seen %u s ago",
+                                 pEntry->acumulado * 10, pEntry->bateria * 100,
+                                 pEntry->flags, (nowMs - pEntry->lastSeenMs) / 1000);
+                }
+                SHELL_NEWLINE();
+                return CMD_RET_SUCCESS;
+            }
+            else if(!strcmp((char*)argv[0], "-reset"))
+            {
+                HidroReadings_Reset();
+                shell_write("\n\r-->  Readings Erased.\n\r");
+                return CMD_RET_SUCCESS;
+            }
+            return CMD_RET_USAGE;
+        }
+
+        case 2:
+        {
+            if(!strcmp((char*)argv[0], "-changes"))
+            {
+                if(!strcmp((char*)argv[1], "on"))
+                {
+                    mHidroChangesOnly = TRUE;
+                    return CMD_RET_SUCCESS;
+                }
+                else if(!strcmp((char*)argv[1], "off"))
+                {
+                    mHidroChangesOnly = FALSE;
+                    return CMD_RET_SUCCESS;
+                }
+            }
+            else if(!strcmp((char*)argv[0], "-heartbeat"))
+            {
+                HidroReadings_SetHeartbeat((uint32_t)atoi(argv[1]));
+                return CMD_RET_SUCCESS;
+            }
+            return CMD_RET_USAGE;
+        }
+
+        default:
+            return CMD_RET_USAGE;
+    }
+}
+#endif
+
+/*! *********************************************************************************
+ * \brief        Writes a valid meter reading as one binary record frame.
+ ********************************************************************************** */
+static void ShellGap_WriteHidroRecord(gapScannedDevice_t* pData, const uint8_t* pName)
+{
+    uint8_t frame[gHidroRecordFrameMaxSize_c];
+    uint8_t* pFrame;
+    hidroRecord_t* pRecord;
+    uint8_t length;
+
+    /* The frame is sent from the buffer while the next reports are handled */
+    pFrame = MEM_BufferAlloc(gHidroRecordFrameMaxSize_c);
+
+    if (pFrame == NULL)
+    {
+        pFrame = frame;
+    }
+
+    /* The record is filled in the frame buffer and encoded there */
+    pRecord = HidroRecord_GetRecord(pFrame);
+    pRecord->version = gHidroRecordVersion_c;
+    FLib_MemCpy(pRecord->address, pData->aAddress, sizeof(pRecord->address));
+    FLib_MemCpy(pRecord->name, (void*)pName, gHidroRecordNameSize_c);
+    pRecord->acumulado = hidroPayload.acumulado;
+    pRecord->bateria = hidroPayload.bateria;
+    pRecord->flags = (hidroPayload.fraude_magnetico ? gHidroRecordFraudMagnetic_c : 0) |
+                     (hidroPayload.fraude_acelerometro ? gHidroRecordFraudMovement_c : 0) |
+                     (hidroPayload.assinatura ? gHidroRecordSignature_c : 0);
+    FLib_MemCpy(pRecord->hist, hidroPayload.hist, gHidroRecordHistSize_c);
+    pRecord->rssi = pData->rssi;
+    pRecord->timestampMs = (uint32_t)(TMR_GetTimestamp() / 1000);
+
+    length = HidroRecord_Encode(pFrame);
+
+    if (pFrame != frame)
+    {
+        shell_writeShared(pFrame, length);
+        MEM_BufferFree(pFrame);
+    }
+    else
+    {
+        shell_writeN((char*)frame, length);
+    }
+}
+
 static void ShellGap_ParseScannedDevice(gapScannedDevice_t* pData)
 {
-    uint8_t index = 0;
+    adElement_t adElement;
     uint8_t nameLength;
 
     bool_t hasName = FALSE;			//kannebley:boolean to control if the device found has a name
     bool_t isHidrometer = FALSE;	//kannebley:boolean to control if the device found was the hidrometer
     bool_t crcStatus = FALSE;		//kannebley:boolean to control if the CRC is valid
+    bool_t report = FALSE;			/* TRUE if the reading is reported */
+    bool_t changesOnly = FALSE;		/* TRUE if only readings that changed are reported */
 
     //kannebley:string with the decrypted payload
     uint8_t	decryptedPayload[16];
@@ -1025,55 +1360,48 @@ static void ShellGap_ParseScannedDevice(gapScannedDevice_t* pData)
     uint8_t newName[11];
     uint8_t i,j;
 
+    const hidroPackage_t* pPackage;
 
-    while (index < pData->dataLength)
-    {
-        gapAdStructure_t adElement;
-
-        adElement.length = pData->data[index];
-        adElement.adType = (gapAdType_t)pData->data[index + 1];
-        adElement.aData = &pData->data[index + 2];
-
-        if ((adElement.adType == gAdShortenedLocalName_c) ||
-          (adElement.adType == gAdCompleteLocalName_c))
-        {
-            nameLength = MIN(adElement.length-1, mShellGapMaxDeviceNameLength_c);
+#if gHidroKeyCacheEnabled_d
+    const hidroKeyCacheEntry_t* pKeyEntry;
+#else
+    cryptoAesKey_t meterKey;
+#endif
 
-            //kannebley:rewrite/restart on the first position of the buffer
-            if (mScannedDevicesCount >= mShellGapMaxScannedDevicesCount_c) {
-            	mScannedDevicesCount = 0;
+    /* Only the name is looked up before the duplicate check: a re-broadcast of an
+       already processed meter frame is dropped before anything is copied or decrypted */
+    hasName = AdIter_FindName(pData->data, pData->dataLength, &adElement);
 
-            	//kannebley:clear the "name" field from the mScannedDevices array
-            	for(int j = 0; j < mShellGapMaxScannedDevicesCount_c; j++) {
-//					for(uchar_t i = 0; i < strlen((char*)mScannedDevices[j].name); i++) {
-//						mScannedDevices[j].name[i] = NULL;
-//					}
-					memset(mScannedDevices[j].name, 0, sizeof(mScannedDevices[j].name));
-            	}
-            }
+    //kannebley:compare if the device found was the hidrometer
+    if (hasName && (adElement.length == 4) && FLib_MemCmp((void*)adElement.pData, "AGUA", 4)) {
+        /* The meter fields are read in place, the frame must hold all of them */
+        isHidrometer = (pData->dataLength >= sizeof(hidroPackage_t));
+    }
 
-        	FLib_MemCpy(mScannedDevices[mScannedDevicesCount].name, adElement.aData, nameLength);
+#if gHidroDedupEnabled_d
+    /* Only meter frames are recorded, other advertisers never take a table entry */
+    if (isHidrometer && HidroDedup_IsDuplicate(pData->aAddress, pData->data, pData->dataLength)) {
+        return;
+    }
+#endif
 
-        	//kannebley:compare if the device found was the hidrometer
-        	if(strcmp((char*)mScannedDevices[mScannedDevicesCount].name, "AGUA") == 0) {
-				shell_write("\n\r-->  GAP Event: Found hidrometer (AGUA)");
-//				shell_write(" : ");
-//				shell_write((char*)mScannedDevices[mScannedDevicesCount].name);
-				shell_write(" ");
-				isHidrometer = TRUE;
-        	}
+    if (hasName) {
+        /* Keep room for the terminator */
+        nameLength = MIN(adElement.length, sizeof(mScannedDevices[0].name) - 1);
 
-        	hasName = TRUE;
+        //kannebley:rewrite/restart on the first position of the buffer
+        if (mScannedDevicesCount >= mShellGapMaxScannedDevicesCount_c) {
+            mScannedDevicesCount = 0;
         }
 
-        /* Move on to the next AD elemnt type */
-        index += adElement.length + sizeof(uint8_t);
+        /* Clear the previous name, mScannedDevices entries are reused */
+        FLib_MemSet(mScannedDevices[mScannedDevicesCount].name, 0, sizeof(mScannedDevices[0].name));
+        FLib_MemCpy(mScannedDevices[mScannedDevicesCount].name, (void*)adElement.pData, nameLength);
     }
 
     //kannebley:condition to show only the hidrometer devices that have a name
     if (hasName && isHidrometer) {
-		shell_write("\tMAC Address: ");
-    	shell_writeHexLe(pData->aAddress, sizeof(bleDeviceAddress_t));
+		pPackage = (const hidroPackage_t*)pData->data;
 
 		/* Temporary store scanned data to use for connection */
 //		mScannedDevices[mScannedDevicesCount].addrType = pData->addressType;
@@ -1082,31 +1410,10 @@ static void ShellGap_ParseScannedDevice(gapScannedDevice_t* pData)
 //					sizeof(bleDeviceAddress_t));
 
 
-		//kannebley:write the raw data for debugging
-		shell_write("\n\rRaw data in HEX (crypted):\n\r");
-		shell_writeHex(pData->data, pData->dataLength);
-		shell_write("\n\r");
-
-
-		//kannebley:copy the package data to manipulate the payload
-		FLib_MemCpy(&hidroPackage, pData->data, pData->dataLength);
-
-
-		//kannebley:write the name_id for debugging
-//		shell_writeHex((char*)hidroPackage.name_id, 4);
-		shell_write("\n\r");
-
+		i = (pPackage->dev_name[0] & 0xF0) >> 4;			//catch the upper nibble that has the index to be read in the table
+		newName[0] = (i < sizeof(tabela_designacao)) ? tabela_designacao[i] : '?';	//out of table: the CRC check will fail
 
-		//kannebley:write the encrypted data in hexadecimal for debugging
-		shell_write("Payload crypted in HEX:     ");
-		shell_writeHex(hidroPackage.data_crypt, 16);
-		shell_write("\n\r");
-
-
-		i = (hidroPackage.dev_name[0] & 0xF0) >> 4;			//catch the upper nibble that has the index to be read in the table
-		newName[0] = tabela_designacao[i];
-
-		newName[1] = (hidroPackage.dev_name[0] & 0x0F) + 0x30;		//catch the second byte in hexa
+		newName[1] = (pPackage->dev_name[0] & 0x0F) + 0x30;		//catch the second byte in hexa
 		if (newName[1] > 0x39)
 			newName[1] += 7;		//if catches a text caracter (higher than 9)
 
@@ -1114,11 +1421,11 @@ static void ShellGap_ParseScannedDevice(gapScannedDevice_t* pData)
 
 		for (i=1; i<5; i++)			//calculate for the rest of the buffer
 		{
-			newName[j] = ((hidroPackage.dev_name[i] & 0xF0) >> 4) + 0x30;
+			newName[j] = ((pPackage->dev_name[i] & 0xF0) >> 4) + 0x30;
 			if (newName[j] > 0x39)
 				newName[j] += 7;		//if catches a text caracter (higher than 9)
 			j++;
-			newName[j] = (hidroPackage.dev_name[i] & 0x0F) + 0x30;
+			newName[j] = (pPackage->dev_name[i] & 0x0F) + 0x30;
 			if (newName[j] > 0x39)
 				newName[j] += 7;		//if catches a text caracter (higher than 9)
 			j++;
@@ -1126,25 +1433,38 @@ static void ShellGap_ParseScannedDevice(gapScannedDevice_t* pData)
 
 		newName[j]=0;		//sets the end of the array
 
-		shell_write("Device Name:    ");
-		shell_write((char*)newName);
-		shell_write("\n\r");
+		if (!mHidroSeedKeyReady)
+		{
+			CryptoAes_SetKey(&mHidroSeedKey, seedAES, gCryptoAesEncrypt_c);
+			mHidroSeedKeyReady = TRUE;
+		}
 
-		memset(keyAES, 0, sizeof(keyAES));
+#if gHidroKeyCacheEnabled_d
+		/* Derive and expand the meter key only the first time the meter is heard */
+		pKeyEntry = HidroKeyCache_Find(pPackage->dev_name);
 
-		AES_ECB_encrypt(newName, seedAES, keyAES, 10);
+		if (pKeyEntry == NULL)
+		{
+			/* The key is the encrypted 10 chars name, zero padded to one block */
+			memset(keyAES, 0, sizeof(keyAES));
+			FLib_MemCpy(keyAES, newName, 10);
 
-		shell_write("Key:   ");
-		shell_writeHex(keyAES, 16);
+			(void)CryptoAes_Ecb(gCryptoAesEncrypt_c, &mHidroSeedKey, keyAES, keyAES, 1);
 
+			pKeyEntry = HidroKeyCache_Insert(pPackage->dev_name, keyAES);
+		}
 
-		AES_ECB_decrypt(hidroPackage.data_crypt, keyAES, decryptedPayload, 16);
+		(void)CryptoAes_Ecb(gCryptoAesDecrypt_c, &pKeyEntry->key, pPackage->data_crypt, decryptedPayload, 1);
+#else
+		/* The key is the encrypted 10 chars name, zero padded to one block */
+		memset(keyAES, 0, sizeof(keyAES));
+		FLib_MemCpy(keyAES, newName, 10);
 
+		(void)CryptoAes_Ecb(gCryptoAesEncrypt_c, &mHidroSeedKey, keyAES, keyAES, 1);
 
-		//kannebley:write the decrypted data in hexadecimal for debugging
-		shell_write("\n\rPayload DEcrypted in HEX:   ");
-		shell_writeHex(decryptedPayload, 16);
-		shell_write("\n\r");
+		CryptoAes_SetKey(&meterKey, keyAES, gCryptoAesDecrypt_c);
+		(void)CryptoAes_Ecb(gCryptoAesDecrypt_c, &meterKey, pPackage->data_crypt, decryptedPayload, 1);
+#endif
 
 
 		//kannebley:copy the decryptedPayload to the struct hidroPayload for easier manipulation
@@ -1152,35 +1472,79 @@ static void ShellGap_ParseScannedDevice(gapScannedDevice_t* pData)
 
 
 		//kannebley:CRC code to check package
-		uint8_t x;
-		uint16_t crc16(const uint8_t* data_p, uint8_t length){	//kannebley: returns the inverted CRC (MSB / LSB)
-			uint16_t crc = 0xFFFF;
-
-			while (length--){
-				x = crc >> 8 ^ *data_p++;
-				x ^= x>>4;
-				crc = (crc << 8) ^ ((uint16_t)(x << 12)) ^ ((uint16_t)(x <<5)) ^ ((uint16_t)x);
-			}
-			return crc;
+		/* CRC-16/CCITT-FALSE over the first 14 bytes */
+		uint16_t crc = crc16_ccitt(decryptedPayload, 14);
+
+		crcStatus = (hidroPayload.crc == crc);
+		report = crcStatus;
+
+#if gHidroReadingsEnabled_d
+		/* Keep the latest reading of every meter, report only changes if asked to */
+		changesOnly = mHidroChangesOnly;
+
+		if (crcStatus) {
+			uint8_t reasons = HidroReadings_Update(pPackage->dev_name,
+			                                       hidroPayload.acumulado,
+			                                       (hidroPayload.fraude_magnetico ? gHidroReadingFraudMagnetic_c : 0) |
+			                                       (hidroPayload.fraude_acelerometro ? gHidroReadingFraudMovement_c : 0),
+			                                       hidroPayload.bateria);
+			report = !changesOnly || reasons;
 		}
-		uint16_t crc = crc16(decryptedPayload, 14);
+#endif
+
+		/* Binary mode sends only valid readings, one record each. Text mode prints the
+		   whole report of those readings, and of invalid frames unless only changes are
+		   reported. */
+		if (mHidroBinaryOutput) {
+			if (report) {
+				ShellGap_WriteHidroRecord(pData, newName);
+			}
+		} else if (report || (!crcStatus && !changesOnly)) {
+			shell_printf("\n\r-->  GAP Event: Found hidrometer (AGUA) \tMAC Address: ");
+//			shell_write(" : ");
+//			shell_write((char*)mScannedDevices[mScannedDevicesCount].name);
+			shell_writeHexLe(pData->aAddress, sizeof(bleDeviceAddress_t));
+
 
-		if (hidroPayload.crc == crc) {
-			crcStatus = TRUE;
-			shell_write("\n\rVALID CRC.\n\rValue:\t");
-			shell_writeDec(crc);
+			//kannebley:write the raw data for debugging
+			shell_write("\n\rRaw data in HEX (crypted):\n\r");
+			shell_writeHex(pData->data, pData->dataLength);
 			shell_write("\n\r");
-		} else {
-			crcStatus = FALSE;
-			shell_write("\n\rNOT VALID CRC.\n\rCalculated:\t");
-			shell_writeDec(crc);
-			shell_write("\n\rPayload:\t");
-			shell_writeDec(hidroPayload.crc);
+
+
+			//kannebley:write the encrypted data in hexadecimal for debugging
+			//kannebley:write the name_id for debugging
+//			shell_writeHex((char*)pPackage->name_id, 4);
+			shell_write("\n\r");
+
+			shell_write("Payload crypted in HEX:     ");
+			shell_writeHex((uint8_t*)pPackage->data_crypt, 16);
+
+
+			shell_printf("\n\rDevice Name:    %s\n\rKey:   ", (char*)newName);
+#if gHidroKeyCacheEnabled_d
+			shell_writeHex((uint8_t*)pKeyEntry->key.key, 16);
+#else
+			shell_writeHex(keyAES, 16);
+#endif
+
+
+			//kannebley:write the decrypted data in hexadecimal for debugging
+			shell_write("\n\rPayload DEcrypted in HEX:   ");
+			shell_writeHex(decryptedPayload, 16);
 			shell_write("\n\r");
+
+
+			if (crcStatus) {
+				shell_printf("\n\rVALID CRC.\n\rValue:\t%u\n\r", crc);
+			} else {
+				shell_printf("\n\rNOT VALID CRC.\n\rCalculated:\t%u\n\rPayload:\t%u\n\r",
+						crc, hidroPayload.crc);
+			}
 		}
 
 		//kannebley:check if the payload was decrypted
-		if (crcStatus){
+		if (report && !mHidroBinaryOutput){
 
 			shell_write("\n\r**************Payload Information**************");
 
@@ -1194,20 +1558,15 @@ static void ShellGap_ParseScannedDevice(gapScannedDevice_t* pData)
 
 
 			//kannebley:show water consumption in liters
-			shell_write("\n\rWater consumption: ");
-			shell_writeDec(hidroPayload.acumulado * 10);
-			shell_write(" L\n\r");
+			shell_printf("\n\rWater consumption: %u L\n\r", hidroPayload.acumulado * 10);
 
 
 			//kannebley:show battery voltage
-			shell_write("Battery voltage: ");
-			shell_writeDec(hidroPayload.bateria * 100);
-			shell_write(" mV\n\r");
+			shell_printf("Battery voltage: %u mV\n\r", hidroPayload.bateria * 100);
 
 
 			//kannebley:show movement alarm
-			shell_write("Movement alarm: ");
-			shell_writeDec(hidroPayload.fraude_acelerometro);
+			shell_printf("Movement alarm: %u", hidroPayload.fraude_acelerometro);
 
 
 			shell_write("\n\r***********************************************");
@@ -1402,9 +1761,7 @@ void ShellGap_ConnectionCallback
 
         case gConnEvtPasskeyDisplay_c:
         {
-            shell_write("\n\r-->  GAP Event: Passkey is ");
-            shell_writeDec(pConnectionEvent->eventData.passkeyForDisplay);
-            SHELL_NEWLINE();
+            shell_printf("\n\r-->  GAP Event: Passkey is %u\n\r", pConnectionEvent->eventData.passkeyForDisplay);
             shell_cmd_finished();
         }
         break;
@@ -1479,15 +1836,13 @@ void ShellGap_ConnectionCallback
                 mConnectionParams.connLatency = pConnectionEvent->eventData.connectionUpdateComplete.connLatency;
                 mConnectionParams.supervisionTimeout = pConnectionEvent->eventData.connectionUpdateComplete.supervisionTimeout;
 
-                shell_write("\n\r-->  GAP Event: Connection Parameters Changed.");
-                shell_write("\n\r   -->Connection Interval: ");
-                shell_writeDec(mConnectionParams.connInterval * 10/8);
-                shell_write(" ms");
-                shell_write("\n\r   -->Connection Latency: ");
-                shell_writeDec(mConnectionParams.connLatency);
-                shell_write("\n\r   -->Supervision Timeout: ");
-                shell_writeDec(mConnectionParams.supervisionTimeout * 10);
-                shell_write(" ms");
+                shell_printf("\n\r-->  GAP Event: Connection Parameters Changed."
+                             "\n\r   -->Connection Interval: %u ms"
+                             "\n\r   -->Connection Latency: %u"
+                             "\n\r   -->Supervision Timeout: %u ms",
+                             mConnectionParams.connInterval * 10/8,
+                             mConnectionParams.connLatency,
+                             mConnectionParams.supervisionTimeout * 10);
                 shell_cmd_finished();
             }
             else
@@ -59,12 +59,6 @@
 * Private type definitions
 *************************************************************************************
 ************************************************************************************/
-typedef struct gattCmds_tag
-{
-    char*       name;
-    int8_t      (*cmd)(uint8_t argc, char * argv[]);
-}gattCmds_t;
-
 /************************************************************************************
 *************************************************************************************
 * Private functions prototypes
@@ -95,14 +89,15 @@ static uint8_t ShellGatt_ParseHexValue(char* pInput);
 * Private memory declarations
 *************************************************************************************
 ************************************************************************************/
-const gattCmds_t mGattShellCmds[mShellGattCmdsCount_c] =
+/* Sorted by name (strcmp order), searched with shell_exec_subcommand() */
+const shell_subcmd_t mGattShellCmds[mShellGattCmdsCount_c] =
 {
     {"discover",    ShellGatt_Discover},
+    {"indicate",    ShellGatt_Indicate},
+    {"notify",      ShellGatt_Notify},
     {"read",        ShellGatt_Read},
     {"write",       ShellGatt_WriteRsp},
-    {"writecmd",    ShellGatt_WriteCmd},
-    {"notify",      ShellGatt_Notify},
-    {"indicate",    ShellGatt_Indicate}
+    {"writecmd",    ShellGatt_WriteCmd}
 };
 
 const gattUuidNames_t mGattServices[]={
@@ -398,21 +393,7 @@ extern void ShellThr_MtuExchangeCallback(void);
 ************************************************************************************/
 int8_t ShellGatt_Command(uint8_t argc, char * argv[])
 {
-    uint8_t i;
-
-    if (argc < 2)
-    {
-        return CMD_RET_USAGE;
-    }
-
-    for (i=0; i< mShellGattCmdsCount_c; i++)
-    {
-        if(!strcmp((char*)argv[1], mGattShellCmds[i].name) )
-        {
-            return mGattShellCmds[i].cmd(argc-2, (char **)(&argv[2]));
-        }
-    }
-    return CMD_RET_USAGE;
+    return shell_exec_subcommand(argc, argv, mGattShellCmds, mShellGattCmdsCount_c);
 }
 
 /*! *********************************************************************************
@@ -54,12 +54,6 @@
 * Private type definitions
 *************************************************************************************
 ************************************************************************************/
-typedef struct gattCmds_tag
-{
-    char*       name;
-    int8_t      (*cmd)(uint8_t argc, char * argv[]);
-}gattCmds_t;
-
 
 /************************************************************************************
 *************************************************************************************
@@ -80,12 +74,13 @@ static bleResult_t ShellGattDb_AddServiceInDatabase(serviceInfo_t* pServiceInfo)
 * Private memory declarations
 *************************************************************************************
 ************************************************************************************/
-const gattCmds_t mGattDbShellCmds[mShellGattDbCmdsCount_c] =
+/* Sorted by name (strcmp order), searched with shell_exec_subcommand() */
+const shell_subcmd_t mGattDbShellCmds[mShellGattDbCmdsCount_c] =
 {
-    {"read",        ShellGattDb_Read},
-    {"write",       ShellGattDb_Write},
     {"addservice",  ShellGattDb_AddService},
-    {"erase",       ShellGattDb_Erase}
+    {"erase",       ShellGattDb_Erase},
+    {"read",        ShellGattDb_Read},
+    {"write",       ShellGattDb_Write}
 };
 
 const char* mGattDbStatus[] = {
@@ -124,21 +119,7 @@ bleResult_t ShellGattDb_Init(void)
 
 int8_t ShellGattDb_Command(uint8_t argc, char * argv[])
 {
-    uint8_t i;
-
-    if (argc < 2)
-    {
-        return CMD_RET_USAGE;
-    }
-
-    for (i=0; i< mShellGattDbCmdsCount_c; i++)
-    {
-        if(!strcmp((char*)argv[1], mGattDbShellCmds[i].name) )
-        {
-            return mGattDbShellCmds[i].cmd(argc-2, (char **)(&argv[2]));
-        }
-    }
-    return CMD_RET_USAGE;
+    return shell_exec_subcommand(argc, argv, mGattDbShellCmds, mShellGattDbCmdsCount_c);
 }
 
 static int8_t ShellGattDb_Read(uint8_t argc, char * argv[])
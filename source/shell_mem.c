@@ -0,0 +1,308 @@
+/*! *********************************************************************************
+ * \addtogroup SHELL MEM
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the MEM Shell module
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+ *************************************************************************************
+ * Include
+ *************************************************************************************
+ ************************************************************************************/
+/* Framework / Drivers */
+#include "TimersManager.h"
+#include "shell.h"
+#include "MemManager.h"
+
+#include "shell_mem.h"
+
+#include <string.h>
+#include <stdlib.h>
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+/* Trace events read from the Memory Manager at once */
+#define mShellMemTraceChunk_c               8
+
+/* Width of the columns of the statistics table */
+#define mShellMemColumnWidth_c              9
+
+/* The periodic snapshots may be late by this fraction of the period */
+#define mShellMemStatsSlackDiv_c            8
+
+/************************************************************************************
+*************************************************************************************
+* Private type definitions
+*************************************************************************************
+************************************************************************************/
+/************************************************************************************
+*************************************************************************************
+* Private functions prototypes
+*************************************************************************************
+************************************************************************************/
+/* Shell API Functions */
+#ifdef MEM_TRACE
+static int8_t   ShellMem_Trace(uint8_t argc, char * argv[]);
+#endif
+#ifdef MEM_STATISTICS
+static int8_t   ShellMem_Stats(uint8_t argc, char * argv[]);
+static void     ShellMem_PrintStats(void);
+static void     ShellMem_StatsTimerCallback(void *param);
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+#if defined(MEM_TRACE) || defined(MEM_STATISTICS)
+/* Sorted by name (strcmp order), searched with shell_exec_subcommand() */
+const shell_subcmd_t mMemShellCmds[] =
+{
+#ifdef MEM_STATISTICS
+    {"stats",       ShellMem_Stats},
+#endif
+#ifdef MEM_TRACE
+    {"trace",       ShellMem_Trace},
+#endif
+};
+#endif
+
+#ifdef MEM_STATISTICS
+static tmrTimerID_t mShellMemStatsTimerId = gTmrInvalidTimerID_c;
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+#if defined(MEM_TRACE) || defined(MEM_STATISTICS)
+int8_t ShellMem_Command(uint8_t argc, char * argv[])
+{
+    return shell_exec_subcommand(argc, argv, mMemShellCmds, NumberOfElements(mMemShellCmds));
+}
+#endif
+
+#ifdef MEM_TRACE
+/*! *********************************************************************************
+ * \brief        Time-stamp of the Memory Manager trace, in milliseconds.
+ ********************************************************************************** */
+uint32_t MEM_GetTimeStamp(void)
+{
+    return (uint32_t)(TMR_GetTimestamp() / 1000);
+}
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+#ifdef MEM_TRACE
+/*! *********************************************************************************
+ * \brief        Starts, stops or clears the allocation trace. Without options,
+ *               prints the pool layout and removes the recorded events from the
+ *               trace, oldest first.
+ ********************************************************************************** */
+static int8_t ShellMem_Trace(uint8_t argc, char * argv[])
+{
+    static const char mTraceOps[] = {'A', 'F', 'X'};
+    memTraceEntry_t entries[mShellMemTraceChunk_c];
+    const pools_t* pPool;
+    uint16_t total = 0;
+    uint16_t count;
+    uint16_t i;
+
+    if (argc == 1)
+    {
+        if (!strcmp((char*)argv[0], "-start"))
+        {
+            MEM_TraceEnable(TRUE);
+        }
+        else if (!strcmp((char*)argv[0], "-stop"))
+        {
+            MEM_TraceEnable(FALSE);
+        }
+        else if (!strcmp((char*)argv[0], "-reset"))
+        {
+            MEM_TraceReset();
+        }
+        else
+        {
+            return CMD_RET_USAGE;
+        }
+        return CMD_RET_SUCCESS;
+    }
+    else if (argc != 0)
+    {
+        return CMD_RET_USAGE;
+    }
+
+    shell_printf("\n\rM,%u,%u", (uint32_t)sizeof(listHeader_t), MEM_TraceGetLost());
+
+    for (i = 0; i < MEM_GetPoolCount(); i++)
+    {
+        pPool = MEM_GetPool(i);
+        shell_printf("\n\rP,%u,%u,%u,%u,%u", i, pPool->poolId, pPool->blockSize,
+                     pPool->numBlocks, pPool->allocatedBlocks);
+    }
+
+    /* Events recorded while printing are left for the next export */
+    while (total < MEM_TRACE_SIZE)
+    {
+        count = MEM_TraceRead(entries, mShellMemTraceChunk_c);
+
+        if (count == 0)
+        {
+            break;
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            shell_printf("\n\rT,%u,%c,%u,%u,%u,%08X", entries[i].timeStamp, mTraceOps[entries[i].op],
+                         entries[i].requestedSize, entries[i].poolIdx, entries[i].blockId,
+                         entries[i].caller);
+        }
+
+        total += count;
+    }
+
+    SHELL_NEWLINE();
+    return CMD_RET_SUCCESS;
+}
+#endif /* MEM_TRACE */
+
+#ifdef MEM_STATISTICS
+/*! *********************************************************************************
+ * \brief        Prints the pool statistics. -reset restarts them from the current
+ *               state; -period prints them every given number of milliseconds,
+ *               0 stops the periodic snapshots.
+ ********************************************************************************** */
+static int8_t ShellMem_Stats(uint8_t argc, char * argv[])
+{
+    uint32_t periodMs;
+
+    if (argc == 0)
+    {
+        ShellMem_PrintStats();
+    }
+    else if ((argc == 1) && !strcmp((char*)argv[0], "-reset"))
+    {
+        MEM_ResetStatistics();
+    }
+    else if ((argc == 2) && !strcmp((char*)argv[0], "-period"))
+    {
+        periodMs = (uint32_t)atoi(argv[1]);
+
+        if (periodMs == 0)
+        {
+            if (mShellMemStatsTimerId != gTmrInvalidTimerID_c)
+            {
+                (void)TMR_StopTimer(mShellMemStatsTimerId);
+            }
+            return CMD_RET_SUCCESS;
+        }
+
+        if (mShellMemStatsTimerId == gTmrInvalidTimerID_c)
+        {
+            mShellMemStatsTimerId = TMR_AllocateTimer();
+
+            if (mShellMemStatsTimerId == gTmrInvalidTimerID_c)
+            {
+                shell_write("\n\rNo timer available");
+                return CMD_RET_FAILURE;
+            }
+        }
+
+        (void)TMR_StartTimerWithSlack(mShellMemStatsTimerId, gTmrIntervalTimer_c, periodMs,
+                                      periodMs / mShellMemStatsSlackDiv_c, ShellMem_StatsTimerCallback, NULL);
+    }
+    else
+    {
+        return CMD_RET_USAGE;
+    }
+
+    return CMD_RET_SUCCESS;
+}
+
+/*! *********************************************************************************
+ * \brief        Prints one line per pool, the free blocks and the histogram of the
+ *               requested sizes of each pool, in fractions of its block size.
+ ********************************************************************************** */
+static void ShellMem_PrintStats(void)
+{
+    poolStat_t stats;
+    const pools_t* pPool;
+    uint32_t freeBlocks = 0;
+    uint8_t i;
+    uint8_t bin;
+
+    shell_write("\n\r     Pool       Id     Size   Blocks    InUse     Peak    Fails AvgWaste MaxWaste");
+
+    for (i = 0; i < MEM_GetPoolCount(); i++)
+    {
+        pPool = MEM_GetPool(i);
+        (void)MEM_GetPoolStatistics(i, &stats);
+
+        SHELL_NEWLINE();
+        shell_writeColumn(i, mShellMemColumnWidth_c);
+        shell_writeColumn(pPool->poolId, mShellMemColumnWidth_c);
+        shell_writeColumn(pPool->blockSize, mShellMemColumnWidth_c);
+        shell_writeColumn(stats.numBlocks, mShellMemColumnWidth_c);
+        shell_writeColumn(stats.allocatedBlocks, mShellMemColumnWidth_c);
+        shell_writeColumn(stats.allocatedBlocksPeak, mShellMemColumnWidth_c);
+        shell_writeColumn(stats.allocationFailures, mShellMemColumnWidth_c);
+        shell_writeColumn(stats.allocations ? (stats.wasteSum / stats.allocations) : 0, mShellMemColumnWidth_c);
+        shell_writeColumn(stats.wasteMax, mShellMemColumnWidth_c);
+
+        freeBlocks += stats.numBlocks - stats.allocatedBlocks;
+    }
+
+    shell_printf("\n\rFree blocks: %u, min: %u", freeBlocks, MEM_GetFreeBlocksMin());
+
+    /* Upper limit of each bin, in percent of the block size */
+    shell_write("\n\r\n\r     Pool");
+    for (bin = 1; bin <= MEM_SIZE_HISTOGRAM_BINS; bin++)
+    {
+        shell_writeColumn((100 * bin) / MEM_SIZE_HISTOGRAM_BINS, mShellMemColumnWidth_c);
+        shell_putc('%');
+    }
+
+    for (i = 0; i < MEM_GetPoolCount(); i++)
+    {
+        (void)MEM_GetPoolStatistics(i, &stats);
+
+        SHELL_NEWLINE();
+        shell_writeColumn(i, mShellMemColumnWidth_c);
+        for (bin = 0; bin < MEM_SIZE_HISTOGRAM_BINS; bin++)
+        {
+            shell_writeColumn(stats.sizeHistogram[bin], mShellMemColumnWidth_c);
+            shell_putc(' ');
+        }
+    }
+
+    SHELL_NEWLINE();
+}
+
+/*! *********************************************************************************
+ * \brief        Periodic snapshot of the pool statistics.
+ ********************************************************************************** */
+static void ShellMem_StatsTimerCallback(void *param)
+{
+    (void)param;
+    ShellMem_PrintStats();
+}
+#endif /* MEM_STATISTICS */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
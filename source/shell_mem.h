@@ -0,0 +1,54 @@
+/*! *********************************************************************************
+ * \defgroup SHELL MEM
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the MEM Shell module. It exports the
+* Memory Manager allocation trace (MEM_TRACE) as text lines that are replayed on
+* the host by tools/mem_pool_optimizer.py:
+*
+*   M,<listHeader_t size>,<lost events>
+*   P,<pool index>,<pool ID>,<block size>,<number of blocks>,<allocated blocks>
+*   T,<ms>,<A|F|X>,<requested size>,<pool index>,<block ID>,<caller>
+*
+* A is an allocation, F a free and X an allocation that failed.
+*
+* With MEM_STATISTICS, "mem stats" prints the usage, failures and fragment waste
+* of each pool and a histogram of the requested sizes, in fractions of the block
+* size of the pool. The snapshot can be repeated periodically.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _SHELL_MEM_H_
+#define _SHELL_MEM_H_
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int8_t ShellMem_Command(uint8_t argc, char * argv[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_MEM_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
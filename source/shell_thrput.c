@@ -42,6 +42,7 @@
 #include "ApplMain.h"
 #include "shell_thrput.h"
 #include "dynamic_gatt_database.h"
+#include "ad_iterator.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -68,18 +69,14 @@
 
 #define mShellThrTxInterval_c              (0) /* ms */
 
+/* The end-of-test check may run up to a quarter of its timeout late */
+#define mShellThrCheckSlack_m(timeout)     ((timeout) / 4)
+
 /************************************************************************************
 *************************************************************************************
 * Private type definitions
 *************************************************************************************
 ************************************************************************************/
-/* Command structure type definition */
-typedef struct thrCmds_tag
-{
-    char*       name;
-    int8_t      (*cmd)(uint8_t argc, char * argv[]);
-}thrCmds_t;
-
 /* GAP roles type definition */
 typedef enum thrGapRoles_tag
 {
@@ -97,7 +94,7 @@ static void ShellThr_StartThroughputTest(thrGapRoles_t role);
 static void ShellThr_PrintReport(appCallbackParam_t p);
 static void ShellThr_CheckResults(void* p);
 static bool_t ShellThr_CheckScanEvent(gapScannedDevice_t* pData);
-static bool_t ShellThr_MatchDataInAdvElementList(gapAdStructure_t *pElement, void *pData, uint8_t iDataLen);
+static bool_t ShellThr_MatchDataInAdvElementList(const adElement_t *pElement, void *pData, uint8_t iDataLen);
 #if mShellThrTxInterval_c
 static void ShellThr_TxTimerCallback(void *p);
 #endif
@@ -119,8 +116,8 @@ static int8_t ShellThr_Stop(uint8_t argc, char * argv[]);
 *************************************************************************************
 ************************************************************************************/
 
-/* Throughput test shell commands */
-const thrCmds_t mThrShellCmds[] =
+/* Throughput test shell commands, sorted by name (strcmp order) */
+const shell_subcmd_t mThrShellCmds[] =
 {
     {"start",         ShellThr_Start},
     {"stop",          ShellThr_Stop},
@@ -255,22 +252,7 @@ thrStatistics_t gThrStatistics;
  ********************************************************************************** */
 int8_t ShellThrput_Command(uint8_t argc, char * argv[])
 {
-    uint8_t i;
-    int8_t status = CMD_RET_USAGE;
-
-    if (argc > 1)
-    {
-        for (i=0; i<NumberOfElements(mThrShellCmds); i++)
-        {
-            if(!strcmp((char*)argv[1], mThrShellCmds[i].name) )
-            {
-                status = mThrShellCmds[i].cmd(argc-2, (char **)(&argv[2]));
-                break;
-            }
-        }
-    }
-
-    return status;
+    return shell_exec_subcommand(argc, argv, mThrShellCmds, NumberOfElements(mThrShellCmds));
 }
 
 /************************************************************************************
@@ -708,22 +690,20 @@ void ShellThr_ScanningCallback (gapScanningEvent_t* pScanningEvent)
  ********************************************************************************** */
 static bool_t ShellThr_CheckScanEvent(gapScannedDevice_t* pData)
 {
-    uint8_t index = 0;
+    adIterator_t adIter;
+    adElement_t adElement;
     uint8_t name[10];
     uint8_t nameLength = 0;
     bool_t foundMatch = FALSE;
 
-    while (index < pData->dataLength)
-    {
-        gapAdStructure_t adElement;
-
-        adElement.length = pData->data[index];
-        adElement.adType = (gapAdType_t)pData->data[index + 1];
-        adElement.aData = &pData->data[index + 2];
+    AdIter_Init(&adIter, pData->data, pData->dataLength);
 
+    while (AdIter_Next(&adIter, &adElement))
+    {
         /* Search for Temperature Custom Service */
-        if ((adElement.adType == gAdIncomplete128bitServiceList_c) ||
-            (adElement.adType == gAdComplete128bitServiceList_c))
+        if (!foundMatch &&
+            ((adElement.adType == gAdIncomplete128bitServiceList_c) ||
+             (adElement.adType == gAdComplete128bitServiceList_c)))
         {
             foundMatch = ShellThr_MatchDataInAdvElementList(&adElement, &uuid_service_throughput, 16);
         }
@@ -731,19 +711,16 @@ static bool_t ShellThr_CheckScanEvent(gapScannedDevice_t* pData)
         if ((adElement.adType == gAdShortenedLocalName_c) ||
             (adElement.adType == gAdCompleteLocalName_c))
         {
-            nameLength = MIN(adElement.length, 10);
-            FLib_MemCpy(name, adElement.aData, nameLength);
+            nameLength = MIN(adElement.length, sizeof(name));
+            FLib_MemCpy(name, (void*)adElement.pData, nameLength);
         }
-
-        /* Move on to the next AD element type */
-        index += adElement.length + sizeof(uint8_t);
     }
 
     if (foundMatch)
     {
         /* UI */
         shell_write("\r\nFound device: \r\n");
-        shell_writeN((char*)name, nameLength-1);
+        shell_writeN((char*)name, nameLength);
         SHELL_NEWLINE();
         shell_writeHex(pData->aAddress, 6);
     }
@@ -762,16 +739,16 @@ static bool_t ShellThr_CheckScanEvent(gapScannedDevice_t* pData)
  *
  * \return       TRUE if data is found, FALSE otherwise
  ********************************************************************************** */
-static bool_t ShellThr_MatchDataInAdvElementList(gapAdStructure_t *pElement,
+static bool_t ShellThr_MatchDataInAdvElementList(const adElement_t *pElement,
                                                  void *pData,
                                                  uint8_t iDataLen)
 {
     uint8_t i;
     bool_t status = FALSE;
 
-    for (i=0; i < pElement->length; i+=iDataLen)
+    for (i=0; (i + iDataLen) <= pElement->length; i+=iDataLen)
     {
-        if (FLib_MemCmp(pData, &pElement->aData[i], iDataLen))
+        if (FLib_MemCmp(pData, (void*)&pElement->pData[i], iDataLen))
         {
             status = TRUE;
             break;
@@ -802,7 +779,7 @@ static void ShellThr_StartThroughputTest(thrGapRoles_t role)
         if(gTmrInvalidTimerID_c != gThroughputTestTimerId)
         {
             uint32_t timeout = 3 * (mConnReqParams.connIntervalMax + mConnReqParams.connIntervalMax/4);
-            TMR_StartIntervalTimer(gThroughputTestTimerId, timeout, ShellThr_CheckResults, NULL);
+            TMR_StartTimerWithSlack(gThroughputTestTimerId, gTmrIntervalTimer_c, timeout, mShellThrCheckSlack_m(timeout), ShellThr_CheckResults, NULL);
             shell_write("Throughput test started.\n\rReceiving packets...\n\r");
             gTroughputInProgress = TRUE;
         }
@@ -924,7 +901,7 @@ void ShellThr_ProcessNotification(uint32_t len)
         gThrStatistics.firstPacketTs = TMR_GetTimestamp();
         gThrStatistics.bytesRcv = 0;
         /* Restart the timer */
-        TMR_StartIntervalTimer(gThroughputTestTimerId, timeout, ShellThr_CheckResults, NULL);
+        TMR_StartTimerWithSlack(gThroughputTestTimerId, gTmrIntervalTimer_c, timeout, mShellThrCheckSlack_m(timeout), ShellThr_CheckResults, NULL);
     }
 
     gThrStatistics.lastPacketTs = TMR_GetTimestamp();
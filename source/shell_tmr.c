@@ -0,0 +1,141 @@
+/*! *********************************************************************************
+ * \addtogroup SHELL TMR
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the source file for the TMR Shell module
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+ *************************************************************************************
+ * Include
+ *************************************************************************************
+ ************************************************************************************/
+/* Framework / Drivers */
+#include "TimersManager.h"
+#include "shell.h"
+
+#include "shell_tmr.h"
+
+#include <string.h>
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+/* Width of the columns of the statistics table */
+#define mShellTmrColumnWidth_c              9
+
+/************************************************************************************
+*************************************************************************************
+* Private type definitions
+*************************************************************************************
+************************************************************************************/
+
+/************************************************************************************
+*************************************************************************************
+* Private functions prototypes
+*************************************************************************************
+************************************************************************************/
+/* Shell API Functions */
+#if gTMR_EnableLatencyStats_d
+static int8_t   ShellTmr_Stats(uint8_t argc, char * argv[]);
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+#if gTMR_EnableLatencyStats_d
+/* Sorted by name (strcmp order), searched with shell_exec_subcommand() */
+const shell_subcmd_t mTmrShellCmds[] =
+{
+    {"stats",       ShellTmr_Stats},
+};
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+#if gTMR_EnableLatencyStats_d
+int8_t ShellTmr_Command(uint8_t argc, char * argv[])
+{
+    return shell_exec_subcommand(argc, argv, mTmrShellCmds, NumberOfElements(mTmrShellCmds));
+}
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+#if gTMR_EnableLatencyStats_d
+/*! *********************************************************************************
+ * \brief        Prints one line per timer that expired, with the lateness and the
+ *               execution time of its callback in microseconds, then the lateness
+ *               histogram. -reset clears the statistics.
+ ********************************************************************************** */
+static int8_t ShellTmr_Stats(uint8_t argc, char * argv[])
+{
+    tmrLatencyStats_t stats;
+    uint32_t histogram[gTMR_LatencyHistogramBins_c];
+    uint8_t i;
+
+    if ((argc == 1) && !strcmp((char*)argv[0], "-reset"))
+    {
+        TMR_ResetLatencyStats();
+        return CMD_RET_SUCCESS;
+    }
+    else if (argc != 0)
+    {
+        return CMD_RET_USAGE;
+    }
+
+    shell_write("\n\r    Timer   Count  LateMin  LateAvg  LateMax    CbMin    CbAvg    CbMax Callback");
+
+    for (i = 0; i < gTmrTotalTimers_c; i++)
+    {
+        if (!TMR_GetLatencyStats(i, &stats))
+        {
+            continue;
+        }
+
+        SHELL_NEWLINE();
+        shell_writeColumn(i, mShellTmrColumnWidth_c);
+        shell_writeColumn(stats.expirations, mShellTmrColumnWidth_c);
+        shell_writeColumn(stats.latenessMinUs, mShellTmrColumnWidth_c);
+        shell_writeColumn(stats.latenessAvgUs, mShellTmrColumnWidth_c);
+        shell_writeColumn(stats.latenessMaxUs, mShellTmrColumnWidth_c);
+        shell_writeColumn(stats.callbackMinUs, mShellTmrColumnWidth_c);
+        shell_writeColumn(stats.callbackAvgUs, mShellTmrColumnWidth_c);
+        shell_writeColumn(stats.callbackMaxUs, mShellTmrColumnWidth_c);
+        shell_printf(" 0x%08X", (uint32_t)(uintptr_t)stats.callback);
+    }
+
+    /* Bin i counts the callbacks late by less than the base limit << i */
+    TMR_GetLatencyHistogram(histogram);
+
+    shell_write("\n\r\n\rLateness (us)");
+    for (i = 0; i < gTMR_LatencyHistogramBins_c; i++)
+    {
+        shell_printf("\n\r  %s %*u: %u", (i < (gTMR_LatencyHistogramBins_c - 1)) ? "< " : ">=",
+                     mShellTmrColumnWidth_c,
+                     (uint32_t)gTMR_LatencyHistogramBaseUs_c << ((i < (gTMR_LatencyHistogramBins_c - 1)) ? i : (i - 1)),
+                     histogram[i]);
+    }
+
+    SHELL_NEWLINE();
+    return CMD_RET_SUCCESS;
+}
+#endif /* gTMR_EnableLatencyStats_d */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
@@ -0,0 +1,45 @@
+/*! *********************************************************************************
+ * \defgroup SHELL TMR
+ * @{
+ ********************************************************************************** */
+/*! *********************************************************************************
+* \file
+*
+* This file is the interface file for the TMR Shell module. With
+* gTMR_EnableLatencyStats_d, "tmr stats" prints, for every timer that expired,
+* how late its callback ran after the nominal expiry time and how long it took,
+* and the lateness histogram of all the timer callbacks.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _SHELL_TMR_H_
+#define _SHELL_TMR_H_
+
+/*************************************************************************************
+**************************************************************************************
+* Public macros
+**************************************************************************************
+*************************************************************************************/
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int8_t ShellTmr_Command(uint8_t argc, char * argv[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_TMR_H_ */
+
+/*! *********************************************************************************
+ * @}
+ ********************************************************************************** */
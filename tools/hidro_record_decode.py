@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""
+Decodes the binary meter reading records of the gateway shell.
+
+In binary output mode ("gap output binary") the gateway writes one frame per
+valid reading to the shell UART (see source/hidro_record.h):
+
+    COBS( hidroRecord_t | crc16 ) 0x00
+
+hidroRecord_t is packed and little endian. crc16 is CRC-16/CCITT-FALSE of the
+record, little endian. Frames are delimited by 0x00, so text interleaved on the
+link (prompt, echo, events) is skipped: a chunk between two delimiters that is
+not a valid COBS frame of the right size, with a matching CRC and layout
+version, is ignored and counted as rejected. Text written between two frames
+is rejected together with the frame that follows it.
+
+One CSV line is printed per record:
+
+    timestamp_ms,address,name,acumulado_l,bateria_mv,fraud_magnetic,fraud_movement,signature,rssi,hist
+
+Usage:
+    hidro_record_decode.py capture.bin
+    hidro_record_decode.py --self-test
+"""
+
+import argparse
+import struct
+import sys
+
+RECORD_VERSION = 0x01
+RECORD_FORMAT = '<B6s10sIBB9sbI'
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+RAW_SIZE = RECORD_SIZE + 2
+
+FLAG_FRAUD_MAGNETIC = 1 << 0
+FLAG_FRAUD_MOVEMENT = 1 << 1
+FLAG_SIGNATURE = 1 << 2
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, as crc16_ccitt() in framework/common/crc16.c."""
+    for byte in bytearray(data):
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    """COBS encoding without delimiter, as cobs_encode() in framework/common/cobs.c."""
+    out = bytearray([0])
+    code_idx = 0
+    code = 1
+    data = bytearray(data)
+    for i, byte in enumerate(data):
+        if byte != 0:
+            out.append(byte)
+            code += 1
+        if byte == 0 or code == 0xFF:
+            out[code_idx] = code
+            code = 1
+            code_idx = len(out)
+            out.append(0)
+            if byte != 0 and i == len(data) - 1:
+                return bytes(out[:code_idx])
+    out[code_idx] = code
+    return bytes(out)
+
+
+def cobs_decode(frame):
+    """Decodes a frame without delimiter. Returns None if it is not valid COBS."""
+    out = bytearray()
+    frame = bytearray(frame)
+    idx = 0
+    while idx < len(frame):
+        code = frame[idx]
+        idx += 1
+        if code == 0 or idx + code - 1 > len(frame):
+            return None
+        block = frame[idx:idx + code - 1]
+        if 0 in block:
+            return None
+        out += block
+        idx += code - 1
+        if code != 0xFF and idx < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Record(object):
+    def __init__(self, address, name, acumulado, bateria, flags, hist, rssi, timestamp_ms):
+        self.address = address
+        self.name = name
+        self.acumulado = acumulado
+        self.bateria = bateria
+        self.flags = flags
+        self.hist = hist
+        self.rssi = rssi
+        self.timestamp_ms = timestamp_ms
+
+    def pack(self):
+        return struct.pack(RECORD_FORMAT, RECORD_VERSION, self.address,
+                           self.name.encode('ascii').ljust(10, b'\0'), self.acumulado,
+                           self.bateria, self.flags, self.hist, self.rssi, self.timestamp_ms)
+
+    @classmethod
+    def unpack(cls, raw):
+        (_, address, name, acumulado, bateria, flags, hist, rssi,
+         timestamp_ms) = struct.unpack(RECORD_FORMAT, raw)
+        return cls(address, name.rstrip(b'\0').decode('ascii', 'replace'), acumulado,
+                   bateria, flags, hist, rssi, timestamp_ms)
+
+    def __eq__(self, other):
+        return self.__dict__ == other.__dict__
+
+    def csv(self):
+        # The address is received little endian, as printed by shell_writeHexLe()
+        return ','.join([
+            str(self.timestamp_ms),
+            ':'.join('%02X' % b for b in bytearray(self.address)[::-1]),
+            self.name,
+            str(self.acumulado * 10),
+            str(self.bateria * 100),
+            str(int(bool(self.flags & FLAG_FRAUD_MAGNETIC))),
+            str(int(bool(self.flags & FLAG_FRAUD_MOVEMENT))),
+            str(int(bool(self.flags & FLAG_SIGNATURE))),
+            str(self.rssi),
+            ' '.join('%02X' % b for b in bytearray(self.hist)),
+        ])
+
+
+def encode_frame(record):
+    """Builds a frame the way HidroRecord_Encode() does."""
+    raw = record.pack()
+    return cobs_encode(raw + struct.pack('<H', crc16_ccitt(raw))) + b'\0'
+
+
+def decode_frame(frame):
+    """Checks and decodes a frame without delimiter: size, CRC and layout version."""
+    raw = cobs_decode(frame)
+    if raw is None or len(raw) != RAW_SIZE:
+        return None
+    if struct.unpack('<H', raw[RECORD_SIZE:])[0] != crc16_ccitt(raw[:RECORD_SIZE]):
+        return None
+    if bytearray(raw)[0] != RECORD_VERSION:
+        return None
+    return Record.unpack(raw[:RECORD_SIZE])
+
+
+def decode_stream(data):
+    """Splits a capture on the delimiters. Returns the records and the rejected count."""
+    records = []
+    rejected = 0
+    chunks = data.split(b'\0')
+    # The last chunk has no delimiter yet: it is an incomplete frame or trailing text
+    for chunk in chunks[:-1]:
+        if not chunk:
+            continue
+        record = decode_frame(chunk)
+        if record is None:
+            rejected += 1
+        else:
+            records.append(record)
+    return records, rejected
+
+
+def self_test():
+    records = [
+        Record(b'\x01\x02\x03\x04\x05\x06', 'A01234ABCD', 123456, 36, FLAG_SIGNATURE,
+               bytes(bytearray(range(9))), -67, 1000),
+        # Zeros everywhere, so that COBS has blocks of every size to restore
+        Record(b'\0' * 6, '', 0, 0, 0, b'\0' * 9, 0, 0),
+        Record(b'\xff' * 6, 'Z9999FFFFF', 0xFFFFFFFF, 255,
+               FLAG_FRAUD_MAGNETIC | FLAG_FRAUD_MOVEMENT | FLAG_SIGNATURE,
+               b'\xff' * 9, -128, 0xFFFFFFFF),
+    ]
+
+    for record in records:
+        frame = encode_frame(record)
+        assert frame.count(b'\0') == 1 and frame.endswith(b'\0'), 'delimiter'
+        assert decode_frame(frame[:-1]) == record, 'round trip'
+
+        # Any single bit flip must be rejected
+        for i in range(len(frame) - 1):
+            for bit in range(8):
+                bad = bytearray(frame[:-1])
+                bad[i] ^= 1 << bit
+                if 0 not in bad:
+                    assert decode_frame(bytes(bad)) is None, 'bit flip %d.%d' % (i, bit)
+
+    # A capture that starts mid-frame, text interleaved on the link (lost with the
+    # frame that follows it) and a capture that ends mid-frame
+    first = encode_frame(records[0])
+    stream = (first[5:] + first + b'\r\n> gap scan\r\n' + encode_frame(records[1]) +
+              b'text\0' + encode_frame(records[2]) + first[:10])
+    decoded, rejected = decode_stream(stream)
+    assert decoded == [records[0], records[2]], 'stream'
+    assert rejected == 3, 'rejected %d' % rejected
+
+    print('self-test passed: %d records, %d byte frames' % (len(records), len(first)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0].strip())
+    parser.add_argument('capture', nargs='?', type=argparse.FileType('rb'),
+                        default=getattr(sys.stdin, 'buffer', sys.stdin),
+                        help='raw capture of the shell UART (default: stdin)')
+    parser.add_argument('--self-test', action='store_true',
+                        help='round-trip records built like HidroRecord_Encode() and exit')
+    args = parser.parse_args()
+
+    if args.self_test:
+        self_test()
+        return 0
+
+    records, rejected = decode_stream(args.capture.read())
+    for record in records:
+        print(record.csv())
+    sys.stderr.write('%d records, %d chunks rejected\n' % (len(records), rejected))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
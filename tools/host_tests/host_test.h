@@ -0,0 +1,54 @@
+/*! *********************************************************************************
+* \file
+*
+* Checks shared by the host tests. A failed check prints its location and is
+* counted; main() returns HostTest_Report(), so make stops on the first failing
+* test binary.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static unsigned int mHostTestChecks;
+static unsigned int mHostTestFailures;
+
+#define HOST_CHECK(cond)                                                        \
+    do                                                                          \
+    {                                                                           \
+        mHostTestChecks++;                                                      \
+        if (!(cond))                                                            \
+        {                                                                       \
+            mHostTestFailures++;                                                \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+        }                                                                       \
+    } while (0)
+
+#define HOST_CHECK_MEM(a, b, len)       HOST_CHECK(memcmp((a), (b), (len)) == 0)
+
+/* Prints the summary line of a test binary and returns its exit status */
+static inline int HostTest_Report(const char *pName)
+{
+    printf("%-24s %6u checks, %u failed\n", pName, mHostTestChecks, mHostTestFailures);
+    return (mHostTestFailures == 0) ? 0 : 1;
+}
+
+/* Small deterministic PRNG (xorshift32), so failures reproduce */
+static inline uint32_t HostTest_Rand(uint32_t *pState)
+{
+    uint32_t x = *pState;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+
+    return x;
+}
+
+#endif /* _HOST_TEST_H_ */
@@ -0,0 +1,29 @@
+/*! *********************************************************************************
+* \file
+*
+* Memory Manager configuration of test_mem_isr.c, included in front of every
+* source of that test. Few blocks per pool, so that the pools run out and the
+* allocations fall through to the next block size, and two pool IDs, so that
+* both the lookup table and MEM_FindPool() serve requests.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _MEM_TEST_POOLS_H_
+#define _MEM_TEST_POOLS_H_
+
+#define PoolsDetails_c \
+         _block_size_  32  _number_of_blocks_    5 _eol_  \
+         _block_size_  64  _number_of_blocks_    5 _eol_  \
+         _block_size_ 128  _number_of_blocks_    5 _eol_  \
+         _block_size_ 260  _number_of_blocks_   12 _eol_  \
+         _block_size_ 512  _number_of_blocks_    4 _eol_  \
+         _block_size_  32  _number_of_blocks_    8 _pool_id_(1) _eol_ \
+         _block_size_  60  _number_of_blocks_    6 _pool_id_(1) _eol_ \
+         _block_size_ 100  _number_of_blocks_    2 _pool_id_(1) _eol_
+
+#define gMemPoolLookupIds_c     2
+#define gMemBufferRefCount_d    1
+#define MEM_STATISTICS
+
+#endif /* _MEM_TEST_POOLS_H_ */
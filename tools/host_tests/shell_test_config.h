@@ -0,0 +1,33 @@
+/*! *********************************************************************************
+* \file
+*
+* Shell configuration of test_shell_rpc.c, included in front of every source of
+* that test: the RPC mode with the output buffer, as in source/app_preinclude.h,
+* without the help, history and auto-completion commands.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _SHELL_TEST_CONFIG_H_
+#define _SHELL_TEST_CONFIG_H_
+
+#define SHELL_MAX_COMMANDS              7
+#define SHELL_MAX_ARGS                  11
+#define SHELL_TX_BUFFER_SIZE            128
+#define SHELL_USE_RPC                   1
+#define SHELL_USE_HELP                  0
+#define SHELL_USE_AUTO_COMPLETE         0
+#define SHELL_MAX_HIST                  0
+#define SHELL_USE_LOGO                  0
+
+#define APP_SERIAL_INTERFACE_TYPE       (gSerialMgrUsart_c)
+#define APP_SERIAL_INTERFACE_INSTANCE   0
+#define APP_SERIAL_INTERFACE_SPEED      115200
+
+/* Every optional command ID of ble_shell_rpc_cmds.h */
+#define gAppScanRingSize_c              16
+#define gHidroKeyCacheEnabled_d         1
+#define gHidroReadingsEnabled_d         1
+#define gHidroDedupEnabled_d            1
+
+#endif /* _SHELL_TEST_CONFIG_H_ */
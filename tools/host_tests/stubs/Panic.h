@@ -0,0 +1,25 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for framework/Panic/Interface/Panic.h. The test that links a
+* module calling panic() defines it.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef __PANIC_H__
+#define __PANIC_H__
+
+#include "EmbeddedTypes.h"
+
+typedef uint32_t panicId_t;
+
+void panic
+(
+    panicId_t id,
+    uint32_t location,
+    uint32_t extra1,
+    uint32_t extra2
+);
+
+#endif /* __PANIC_H__ */
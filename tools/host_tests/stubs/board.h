@@ -0,0 +1,13 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for the SDK board.h. Nothing from it is used by the modules
+* under test.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+#endif /* _BOARD_H_ */
@@ -0,0 +1,13 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for the SDK clock_config.h. Nothing from it is used by the modules
+* under test.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _CLOCK_CONFIG_H_
+#define _CLOCK_CONFIG_H_
+
+#endif /* _CLOCK_CONFIG_H_ */
@@ -0,0 +1,13 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for the SDK fsl_common.h. Nothing from it is used by the modules
+* under test.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _FSL_COMMON_H_
+#define _FSL_COMMON_H_
+
+#endif /* _FSL_COMMON_H_ */
@@ -0,0 +1,28 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for the SDK fsl_device_registers.h. It describes a device with a
+* free running 32-bit RTC counter as the stack timer (FSL_FEATURE_RTC_HAS_FRC),
+* and the one SYSCON register the TimersManager reads.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _FSL_DEVICE_REGISTERS_H_
+#define _FSL_DEVICE_REGISTERS_H_
+
+#include <stdint.h>
+
+#define FSL_FEATURE_RTC_HAS_FRC             1
+
+typedef struct
+{
+    volatile uint32_t CLK_DIS;
+} SYSCON_Type;
+
+extern SYSCON_Type gHostSyscon;
+
+#define SYSCON                              (&gHostSyscon)
+#define SYSCON_CLK_EN_CLK_BIV_EN_MASK       (0x1u)
+
+#endif /* _FSL_DEVICE_REGISTERS_H_ */
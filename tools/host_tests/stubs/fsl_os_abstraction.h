@@ -0,0 +1,45 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for framework/OSAbstraction/Interface/fsl_os_abstraction.h. Only
+* the interrupt masking, the events and the mutexes used by the framework
+* modules under test are declared; the test that links those modules defines what they do on the
+* host.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _FSL_OS_ABSTRACTION_H_
+#define _FSL_OS_ABSTRACTION_H_
+
+#include "EmbeddedTypes.h"
+
+typedef void* osaTaskParam_t;
+typedef void* osaEventId_t;
+typedef uint32_t osaEventFlags_t;
+typedef void* osaMutexId_t;
+
+#define osaWaitForever_c   ((uint32_t)(-1))
+
+typedef enum osaStatus_tag
+{
+    osaStatus_Success = 0U,
+    osaStatus_Error = 1U,
+    osaStatus_Timeout = 2U,
+    osaStatus_Idle = 3U
+} osaStatus_t;
+
+/* Enables the interrupts disabled by the matching OSA_InterruptDisable() */
+void OSA_InterruptEnable(void);
+
+/* Disables all interrupts. Calls nest. */
+void OSA_InterruptDisable(void);
+
+/* Sets the flags of an event, waking up the task waiting on it */
+osaStatus_t OSA_EventSet(osaEventId_t eventId, osaEventFlags_t flagsToSet);
+
+osaMutexId_t OSA_MutexCreate(void);
+osaStatus_t OSA_MutexLock(osaMutexId_t mutexId, uint32_t millisec);
+osaStatus_t OSA_MutexUnlock(osaMutexId_t mutexId);
+
+#endif /* _FSL_OS_ABSTRACTION_H_ */
@@ -0,0 +1,25 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for bluetooth/host/interface/gap_types.h, which pulls the OS
+* abstraction in. Only the AD types used by the host tests are listed, with the
+* values of the Bluetooth SIG.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _GAP_TYPES_H_
+#define _GAP_TYPES_H_
+
+#include "EmbeddedTypes.h"
+
+typedef enum gapAdType_tag
+{
+    gAdFlags_c                               = 0x01,
+    gAdShortenedLocalName_c                  = 0x08,
+    gAdCompleteLocalName_c                   = 0x09,
+    gAdTxPowerLevel_c                        = 0x0A,
+    gAdManufacturerSpecificData_c            = 0xFF
+} gapAdType_t;
+
+#endif /* _GAP_TYPES_H_ */
@@ -0,0 +1,13 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stand-in for the SDK pin_mux.h. Nothing from it is used by the modules
+* under test.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _PIN_MUX_H_
+#define _PIN_MUX_H_
+
+#endif /* _PIN_MUX_H_ */
@@ -0,0 +1,294 @@
+/*! *********************************************************************************
+* \file
+*
+* Host tests of the AD structure iterator (source/ad_iterator.c).
+*
+*   - well formed data, records of type only, data filling the 31 bytes;
+*   - a zero length record (padding) ends the iteration;
+*   - a length byte that runs past the end of the data ends the iteration, and
+*     the record is not returned;
+*   - a truncated final record (length byte only, or nothing after a record)
+*     ends the iteration;
+*   - AdIter_FindType() and AdIter_FindName() agree with the iteration;
+*   - random data: every returned element lies inside the data and matches a
+*     reference parser.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include "host_test.h"
+#include "ad_iterator.h"
+
+#define mMaxElements_c      128
+
+typedef struct refElement_tag
+{
+    uint8_t     adType;
+    uint8_t     length;
+    uint8_t     offset;     /* of the data, in the buffer */
+} refElement_t;
+
+static uint32_t mSeed = 0x9E3779B9;
+
+/* Reference parser: the elements up to the first padding or malformed record */
+static uint8_t RefParse(const uint8_t *pData, uint8_t dataLength, refElement_t *pElements)
+{
+    uint32_t offset = 0;
+    uint8_t count = 0;
+
+    while ((offset + 2) <= dataLength)
+    {
+        uint32_t fieldLength = pData[offset];
+
+        if ((fieldLength == 0) || ((offset + 1 + fieldLength) > dataLength))
+        {
+            break;
+        }
+
+        pElements[count].adType = pData[offset + 1];
+        pElements[count].length = (uint8_t)(fieldLength - 1);
+        pElements[count].offset = (uint8_t)(offset + 2);
+        count++;
+
+        offset += fieldLength + 1;
+    }
+
+    return count;
+}
+
+/* Iterates pData and checks every element against the reference parser */
+static uint8_t CheckIteration(const uint8_t *pData, uint8_t dataLength)
+{
+    refElement_t ref[mMaxElements_c];
+    adIterator_t iter;
+    adElement_t element;
+    uint8_t refCount = RefParse(pData, dataLength, ref);
+    uint8_t count = 0;
+
+    AdIter_Init(&iter, pData, dataLength);
+
+    while (AdIter_Next(&iter, &element))
+    {
+        HOST_CHECK(count < refCount);
+        if (count >= refCount)
+        {
+            break;
+        }
+
+        HOST_CHECK(element.adType == ref[count].adType);
+        HOST_CHECK(element.length == ref[count].length);
+        HOST_CHECK(element.pData == &pData[ref[count].offset]);
+        HOST_CHECK((element.pData + element.length) <= (pData + dataLength));
+        count++;
+    }
+
+    HOST_CHECK(count == refCount);
+
+    /* The end of the iteration is sticky */
+    HOST_CHECK(!AdIter_Next(&iter, &element));
+
+    return count;
+}
+
+/* Checks the Find functions against the reference parser */
+static void CheckFind(const uint8_t *pData, uint8_t dataLength)
+{
+    refElement_t ref[mMaxElements_c];
+    adElement_t element;
+    uint8_t refCount = RefParse(pData, dataLength, ref);
+    const uint8_t types[] = { gAdFlags_c, gAdShortenedLocalName_c, gAdCompleteLocalName_c,
+                              gAdManufacturerSpecificData_c };
+    bool_t found;
+    uint8_t t;
+    uint8_t i;
+
+    for (t = 0; t < sizeof(types); t++)
+    {
+        for (i = 0; (i < refCount) && (ref[i].adType != types[t]); i++)
+        {
+        }
+
+        found = AdIter_FindType(pData, dataLength, (gapAdType_t)types[t], &element);
+        HOST_CHECK(found == (i < refCount));
+
+        if (found && (i < refCount))
+        {
+            HOST_CHECK(element.adType == types[t]);
+            HOST_CHECK(element.length == ref[i].length);
+            HOST_CHECK(element.pData == &pData[ref[i].offset]);
+        }
+    }
+
+    for (i = 0; i < refCount; i++)
+    {
+        if ((ref[i].adType == gAdShortenedLocalName_c) || (ref[i].adType == gAdCompleteLocalName_c))
+        {
+            break;
+        }
+    }
+
+    found = AdIter_FindName(pData, dataLength, &element);
+    HOST_CHECK(found == (i < refCount));
+
+    if (found && (i < refCount))
+    {
+        HOST_CHECK(element.pData == &pData[ref[i].offset]);
+        HOST_CHECK(element.length == ref[i].length);
+    }
+}
+
+static void TestWellFormed(void)
+{
+    /* Flags, complete name "AGUA", manufacturer data */
+    const uint8_t data[] = { 0x02, 0x01, 0x06,
+                             0x05, 0x09, 'A', 'G', 'U', 'A',
+                             0x04, 0xFF, 0x11, 0x22, 0x33 };
+    /* A record of type only, last in the data */
+    const uint8_t typeOnly[] = { 0x02, 0x01, 0x06, 0x01, 0x08 };
+    uint8_t full[31];
+    adElement_t element;
+
+    HOST_CHECK(CheckIteration(data, sizeof(data)) == 3);
+    CheckFind(data, sizeof(data));
+
+    HOST_CHECK(AdIter_FindName(data, sizeof(data), &element));
+    HOST_CHECK((element.length == 4) && (memcmp(element.pData, "AGUA", 4) == 0));
+
+    HOST_CHECK(CheckIteration(typeOnly, sizeof(typeOnly)) == 2);
+    HOST_CHECK(AdIter_FindType(typeOnly, sizeof(typeOnly), gAdShortenedLocalName_c, &element));
+    HOST_CHECK(element.length == 0);
+
+    /* One record filling the legacy advertising data */
+    memset(full, 0x5A, sizeof(full));
+    full[0] = 30;
+    full[1] = gAdManufacturerSpecificData_c;
+    HOST_CHECK(CheckIteration(full, sizeof(full)) == 1);
+
+    /* No data */
+    HOST_CHECK(CheckIteration(data, 0) == 0);
+    HOST_CHECK(!AdIter_FindName(data, 0, &element));
+}
+
+static void TestZeroLength(void)
+{
+    /* Padding after the first record hides the name */
+    const uint8_t padded[] = { 0x02, 0x01, 0x06, 0x00, 0x03, 0x09, 'A', 'B' };
+    /* Padding first */
+    const uint8_t leading[] = { 0x00, 0x03, 0x09, 'A', 'B' };
+    /* All padding */
+    const uint8_t zeros[31] = { 0 };
+    adElement_t element;
+
+    HOST_CHECK(CheckIteration(padded, sizeof(padded)) == 1);
+    HOST_CHECK(!AdIter_FindName(padded, sizeof(padded), &element));
+    HOST_CHECK(!AdIter_FindType(padded, sizeof(padded), gAdCompleteLocalName_c, &element));
+    HOST_CHECK(AdIter_FindType(padded, sizeof(padded), gAdFlags_c, &element));
+
+    HOST_CHECK(CheckIteration(leading, sizeof(leading)) == 0);
+    HOST_CHECK(!AdIter_FindName(leading, sizeof(leading), &element));
+
+    HOST_CHECK(CheckIteration(zeros, sizeof(zeros)) == 0);
+}
+
+static void TestLengthPastEnd(void)
+{
+    /* The name claims 5 bytes, only 3 follow */
+    const uint8_t pastEnd[] = { 0x02, 0x01, 0x06, 0x05, 0x09, 'A', 'B', 'C' };
+    /* The first record claims the whole buffer and one more byte */
+    const uint8_t firstPastEnd[] = { 0x05, 0x09, 'A', 'B', 'C' };
+    /* Largest length byte */
+    const uint8_t maxLength[] = { 0xFF, 0x09, 'A' };
+    adElement_t element;
+
+    HOST_CHECK(CheckIteration(pastEnd, sizeof(pastEnd)) == 1);
+    HOST_CHECK(!AdIter_FindName(pastEnd, sizeof(pastEnd), &element));
+    HOST_CHECK(!AdIter_FindType(pastEnd, sizeof(pastEnd), gAdCompleteLocalName_c, &element));
+
+    HOST_CHECK(CheckIteration(firstPastEnd, sizeof(firstPastEnd)) == 0);
+    HOST_CHECK(!AdIter_FindName(firstPastEnd, sizeof(firstPastEnd), &element));
+
+    /* The same bytes with one more byte of data are valid */
+    HOST_CHECK(CheckIteration(pastEnd, sizeof(pastEnd) - 1) == 1);
+
+    HOST_CHECK(CheckIteration(maxLength, sizeof(maxLength)) == 0);
+    HOST_CHECK(!AdIter_FindName(maxLength, sizeof(maxLength), &element));
+}
+
+static void TestTruncatedFinal(void)
+{
+    /* Only the length byte of the last record is present */
+    const uint8_t lengthOnly[] = { 0x02, 0x01, 0x06, 0x03 };
+    /* Length 1, type byte missing */
+    const uint8_t typeMissing[] = { 0x02, 0x01, 0x06, 0x01 };
+    /* The name record cut inside its data by dataLength */
+    const uint8_t cut[] = { 0x02, 0x01, 0x06, 0x05, 0x09, 'A', 'G', 'U', 'A' };
+    adElement_t element;
+    uint8_t len;
+
+    HOST_CHECK(CheckIteration(lengthOnly, sizeof(lengthOnly)) == 1);
+    HOST_CHECK(!AdIter_FindName(lengthOnly, sizeof(lengthOnly), &element));
+
+    HOST_CHECK(CheckIteration(typeMissing, sizeof(typeMissing)) == 1);
+    HOST_CHECK(!AdIter_FindType(typeMissing, sizeof(typeMissing), gAdShortenedLocalName_c, &element));
+
+    /* Every cut of the name record hides it, the whole record shows it */
+    for (len = 3; len < sizeof(cut); len++)
+    {
+        HOST_CHECK(CheckIteration(cut, len) == 1);
+        HOST_CHECK(!AdIter_FindName(cut, len, &element));
+    }
+    HOST_CHECK(CheckIteration(cut, sizeof(cut)) == 2);
+    HOST_CHECK(AdIter_FindName(cut, sizeof(cut), &element));
+}
+
+static void TestRandom(void)
+{
+    uint8_t data[255];
+    uint8_t dataLength;
+    uint32_t round;
+    uint32_t i;
+    uint32_t offset;
+
+    for (round = 0; round < 100000; round++)
+    {
+        dataLength = (uint8_t)(HostTest_Rand(&mSeed) % 256);
+
+        if (round & 1)
+        {
+            /* Mostly well formed records, with short lengths and likely types */
+            offset = 0;
+            while (offset < dataLength)
+            {
+                uint8_t fieldLength = (uint8_t)(HostTest_Rand(&mSeed) % 12);
+
+                data[offset++] = fieldLength;
+                for (i = 0; (i < fieldLength) && (offset < dataLength); i++)
+                {
+                    data[offset++] = (i == 0) ? (uint8_t)(0x07 + (HostTest_Rand(&mSeed) % 4))
+                                              : (uint8_t)HostTest_Rand(&mSeed);
+                }
+            }
+        }
+        else
+        {
+            for (i = 0; i < dataLength; i++)
+            {
+                data[i] = (uint8_t)HostTest_Rand(&mSeed);
+            }
+        }
+
+        (void)CheckIteration(data, dataLength);
+        CheckFind(data, dataLength);
+    }
+}
+
+int main(void)
+{
+    TestWellFormed();
+    TestZeroLength();
+    TestLengthPastEnd();
+    TestTruncatedFinal();
+    TestRandom();
+
+    return HostTest_Report("ad_iterator");
+}
@@ -0,0 +1,208 @@
+/*! *********************************************************************************
+* \file
+*
+* Known answer tests of the Logicalis_HAL AES-128 (source/Logicalis_HAL/aes.c).
+* The Makefile builds this file once per AES_TABLES engine (0, 1 and 2).
+*
+* Vectors:
+*   - FIPS-197 appendix C.1 (AES-128 single block);
+*   - SP800-38A F.1.1/F.1.2 (ECB), F.2.1/F.2.2 (CBC), F.5.1/F.5.2 (CTR).
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include "host_test.h"
+#include "aes.h"
+
+#define STR_(x)     #x
+#define STR(x)      STR_(x)
+
+/* FIPS-197 C.1 */
+static const uint8_t mFipsKey[16] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t mFipsPlain[16] =
+{
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t mFipsCipher[16] =
+{
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+/* SP800-38A, shared by all the AES-128 vectors */
+static const uint8_t mSpKey[16] =
+{
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const uint8_t mSpPlain[64] =
+{
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+/* F.1.1 ECB-AES128.Encrypt */
+static const uint8_t mSpEcb[64] =
+{
+    0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+    0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf,
+    0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88,
+    0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4
+};
+
+/* F.2.1 CBC-AES128.Encrypt */
+static const uint8_t mSpCbcIv[16] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t mSpCbc[64] =
+{
+    0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+    0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+    0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+    0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+
+/* F.5.1 CTR-AES128.Encrypt */
+static const uint8_t mSpCtrIv[16] =
+{
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const uint8_t mSpCtr[64] =
+{
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+static void TestFips197(void)
+{
+    aes_ctx_t ctx;
+    aes_enc_ctx_t encCtx;
+    aes_dec_ctx_t decCtx;
+    uint8_t out[16];
+
+    AES_ECB_encrypt(mFipsPlain, mFipsKey, out, sizeof(out));
+    HOST_CHECK_MEM(out, mFipsCipher, 16);
+    AES_ECB_decrypt(mFipsCipher, mFipsKey, out, sizeof(out));
+    HOST_CHECK_MEM(out, mFipsPlain, 16);
+
+    AES_init_ctx(&ctx, mFipsKey);
+    AES_ECB_encrypt_ctx(&ctx, mFipsPlain, out, sizeof(out));
+    HOST_CHECK_MEM(out, mFipsCipher, 16);
+    AES_ECB_decrypt_ctx(&ctx, mFipsCipher, out, sizeof(out));
+    HOST_CHECK_MEM(out, mFipsPlain, 16);
+
+    AES_init_enc_ctx(&encCtx, mFipsKey);
+    AES_ECB_encrypt_enc_ctx(&encCtx, mFipsPlain, out, sizeof(out));
+    HOST_CHECK_MEM(out, mFipsCipher, 16);
+
+    AES_init_dec_ctx(&decCtx, mFipsKey);
+    AES_ECB_decrypt_dec_ctx(&decCtx, mFipsCipher, out, sizeof(out));
+    HOST_CHECK_MEM(out, mFipsPlain, 16);
+}
+
+static void TestEcb(void)
+{
+    aes_ctx_t ctx;
+    aes_enc_ctx_t encCtx;
+    aes_dec_ctx_t decCtx;
+    uint8_t out[64];
+    uint8_t i;
+
+    AES_init_ctx(&ctx, mSpKey);
+    AES_init_enc_ctx(&encCtx, mSpKey);
+    AES_init_dec_ctx(&decCtx, mSpKey);
+
+    /* All the blocks in one call */
+    AES_ECB_encrypt_ctx(&ctx, mSpPlain, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpEcb, 64);
+    AES_ECB_decrypt_ctx(&ctx, mSpEcb, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpPlain, 64);
+
+    AES_ECB_encrypt_enc_ctx(&encCtx, mSpPlain, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpEcb, 64);
+    AES_ECB_decrypt_dec_ctx(&decCtx, mSpEcb, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpPlain, 64);
+
+    /* In place */
+    memcpy(out, mSpPlain, sizeof(out));
+    AES_ECB_encrypt_enc_ctx(&encCtx, out, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpEcb, 64);
+    AES_ECB_decrypt_dec_ctx(&decCtx, out, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpPlain, 64);
+
+    /* Block by block, through the key-per-call helpers */
+    for (i = 0; i < 4; i++)
+    {
+        AES_ECB_encrypt(&mSpPlain[16 * i], mSpKey, out, 16);
+        HOST_CHECK_MEM(out, &mSpEcb[16 * i], 16);
+        AES_ECB_decrypt(&mSpEcb[16 * i], mSpKey, out, 16);
+        HOST_CHECK_MEM(out, &mSpPlain[16 * i], 16);
+    }
+}
+
+static void TestCbc(void)
+{
+    aes_ctx_t ctx;
+    uint8_t out[64];
+
+    AES_init_ctx_iv(&ctx, mSpKey, mSpCbcIv);
+    AES_CBC_encrypt_ctx(&ctx, mSpPlain, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpCbc, 64);
+
+    AES_ctx_set_iv(&ctx, mSpCbcIv);
+    AES_CBC_decrypt_ctx(&ctx, mSpCbc, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpPlain, 64);
+
+    /* A message in two calls continues from the updated IV */
+    AES_ctx_set_iv(&ctx, mSpCbcIv);
+    AES_CBC_encrypt_ctx(&ctx, mSpPlain, out, 16);
+    AES_CBC_encrypt_ctx(&ctx, &mSpPlain[16], &out[16], 48);
+    HOST_CHECK_MEM(out, mSpCbc, 64);
+
+    AES_ctx_set_iv(&ctx, mSpCbcIv);
+    AES_CBC_decrypt_ctx(&ctx, mSpCbc, out, 32);
+    AES_CBC_decrypt_ctx(&ctx, &mSpCbc[32], &out[32], 32);
+    HOST_CHECK_MEM(out, mSpPlain, 64);
+
+    /* Legacy helpers */
+    AES_CBC_encrypt_buffer(out, (uint8_t*)mSpPlain, sizeof(out), mSpKey, mSpCbcIv);
+    HOST_CHECK_MEM(out, mSpCbc, 64);
+    AES_CBC_decrypt_buffer(out, (uint8_t*)mSpCbc, sizeof(out), mSpKey, mSpCbcIv);
+    HOST_CHECK_MEM(out, mSpPlain, 64);
+}
+
+static void TestCtr(void)
+{
+    aes_ctx_t ctx;
+    uint8_t out[64];
+
+    AES_init_ctx_iv(&ctx, mSpKey, mSpCtrIv);
+    AES_CTR_xcrypt_ctx(&ctx, mSpPlain, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpCtr, 64);
+
+    AES_ctx_set_iv(&ctx, mSpCtrIv);
+    AES_CTR_xcrypt_ctx(&ctx, mSpCtr, out, sizeof(out));
+    HOST_CHECK_MEM(out, mSpPlain, 64);
+
+    /* Whole blocks first, then a partial last block */
+    AES_ctx_set_iv(&ctx, mSpCtrIv);
+    AES_CTR_xcrypt_ctx(&ctx, mSpPlain, out, 32);
+    AES_CTR_xcrypt_ctx(&ctx, &mSpPlain[32], &out[32], 21);
+    HOST_CHECK_MEM(out, mSpCtr, 53);
+}
+
+int main(void)
+{
+    TestFips197();
+    TestEcb();
+    TestCbc();
+    TestCtr();
+
+    return HostTest_Report("aes AES_TABLES=" STR(AES_TABLES));
+}
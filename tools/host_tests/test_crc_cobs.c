@@ -0,0 +1,299 @@
+/*! *********************************************************************************
+* \file
+*
+* Host tests of framework/common/crc16.c and framework/common/cobs.c. The
+* Makefile builds this file once per CRC16_ENGINE (0, 1 and 2), so that
+* crc16_update() is checked with every engine selected.
+*
+*   - every engine gives the CRC-16/CCITT-FALSE and XMODEM check values of
+*     "123456789", and the same CRC as the bitwise engine over random buffers,
+*     any alignment, whole or in chunks;
+*   - cobs_encode() matches the reference vectors, including 254 and 255 byte
+*     non-zero runs, and random buffers round trip through cobs_decode(), also
+*     when encoded in place;
+*   - cobs_decode() rejects corrupted frames and frames that do not fit.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include "host_test.h"
+#include "crc16.h"
+#include "cobs.h"
+
+#define STR_(x)     #x
+#define STR(x)      STR_(x)
+
+#define mMaxLen_c   1100
+
+typedef uint16_t (*crcEngine_t)(uint16_t crc, const uint8_t *pData, uint32_t len);
+
+static const crcEngine_t mEngines[] =
+{
+    crc16_updateBitwise,
+    crc16_updateTable,
+    crc16_updateSlice4,
+    crc16_update
+};
+
+static uint32_t mSeed = 0x2545F491;
+
+/************************************************************************************
+* CRC
+************************************************************************************/
+
+static void TestCrcCheckValues(void)
+{
+    const uint8_t *pCheck = (const uint8_t *)"123456789";
+    uint8_t i;
+
+    for (i = 0; i < sizeof(mEngines) / sizeof(mEngines[0]); i++)
+    {
+        HOST_CHECK(mEngines[i](CRC16_INIT_CCITT_FALSE, pCheck, 9) == 0x29B1);
+        HOST_CHECK(mEngines[i](CRC16_INIT_XMODEM, pCheck, 9) == 0x31C3);
+        HOST_CHECK(mEngines[i](CRC16_INIT_CCITT_FALSE, pCheck, 0) == CRC16_INIT_CCITT_FALSE);
+    }
+
+    HOST_CHECK(crc16_ccitt(pCheck, 9) == 0x29B1);
+}
+
+static void TestCrcRandom(void)
+{
+    static uint8_t buffer[mMaxLen_c + 4];
+    uint32_t round;
+    uint32_t len;
+    uint32_t offset;
+    uint32_t split;
+    uint32_t i;
+    uint16_t reference;
+    uint16_t crc;
+    uint8_t e;
+
+    for (round = 0; round < 2000; round++)
+    {
+        len = HostTest_Rand(&mSeed) % mMaxLen_c;
+        offset = HostTest_Rand(&mSeed) & 3;
+
+        for (i = 0; i < len; i++)
+        {
+            buffer[offset + i] = (uint8_t)HostTest_Rand(&mSeed);
+        }
+
+        reference = crc16_updateBitwise(CRC16_INIT_CCITT_FALSE, &buffer[offset], len);
+
+        for (e = 1; e < sizeof(mEngines) / sizeof(mEngines[0]); e++)
+        {
+            /* Whole buffer */
+            HOST_CHECK(mEngines[e](CRC16_INIT_CCITT_FALSE, &buffer[offset], len) == reference);
+
+            /* Two chunks, the second one at any alignment */
+            split = len ? (HostTest_Rand(&mSeed) % (len + 1)) : 0;
+            crc = mEngines[e](CRC16_INIT_CCITT_FALSE, &buffer[offset], split);
+            crc = mEngines[e](crc, &buffer[offset + split], len - split);
+            HOST_CHECK(crc == reference);
+        }
+    }
+}
+
+/************************************************************************************
+* COBS
+************************************************************************************/
+
+/* Encodes pIn and checks the encoded frame against pExpected */
+static void CheckCobsVector(const uint8_t *pIn, uint32_t len, const uint8_t *pExpected, uint32_t expectedLen)
+{
+    static uint8_t encoded[COBS_ENCODED_MAX_SIZE(mMaxLen_c)];
+    static uint8_t decoded[mMaxLen_c];
+    uint32_t n;
+
+    n = cobs_encode(pIn, len, encoded);
+    HOST_CHECK(n == expectedLen);
+    HOST_CHECK_MEM(encoded, pExpected, expectedLen);
+
+    HOST_CHECK(cobs_decode(encoded, n, decoded, sizeof(decoded)) == len);
+    HOST_CHECK_MEM(decoded, pIn, len);
+}
+
+static void TestCobsVectors(void)
+{
+    static uint8_t in[512];
+    static uint8_t expected[520];
+    uint32_t i;
+
+    {
+        const uint8_t v1[] = { 0x00 };
+        const uint8_t e1[] = { 0x01, 0x01 };
+        const uint8_t v2[] = { 0x00, 0x00 };
+        const uint8_t e2[] = { 0x01, 0x01, 0x01 };
+        const uint8_t v3[] = { 0x11, 0x22, 0x00, 0x33 };
+        const uint8_t e3[] = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+        const uint8_t v4[] = { 0x11, 0x22, 0x33, 0x44 };
+        const uint8_t e4[] = { 0x05, 0x11, 0x22, 0x33, 0x44 };
+        const uint8_t v5[] = { 0x11, 0x00, 0x00, 0x00 };
+        const uint8_t e5[] = { 0x02, 0x11, 0x01, 0x01, 0x01 };
+        const uint8_t e6[] = { 0x01 };
+
+        CheckCobsVector(v1, sizeof(v1), e1, sizeof(e1));
+        CheckCobsVector(v2, sizeof(v2), e2, sizeof(e2));
+        CheckCobsVector(v3, sizeof(v3), e3, sizeof(e3));
+        CheckCobsVector(v4, sizeof(v4), e4, sizeof(e4));
+        CheckCobsVector(v5, sizeof(v5), e5, sizeof(e5));
+        CheckCobsVector(v1, 0, e6, sizeof(e6));
+    }
+
+    /* 01..FE: one full block, no empty block after it */
+    for (i = 0; i < 254; i++)
+    {
+        in[i] = (uint8_t)(i + 1);
+        expected[i + 1] = (uint8_t)(i + 1);
+    }
+    expected[0] = 0xFF;
+    CheckCobsVector(in, 254, expected, 255);
+
+    /* 00 01..FE */
+    in[0] = 0x00;
+    for (i = 0; i < 254; i++)
+    {
+        in[i + 1] = (uint8_t)(i + 1);
+        expected[i + 2] = (uint8_t)(i + 1);
+    }
+    expected[0] = 0x01;
+    expected[1] = 0xFF;
+    CheckCobsVector(in, 255, expected, 256);
+
+    /* 01..FF: 255 non-zero bytes, the last one in a second block */
+    for (i = 0; i < 255; i++)
+    {
+        in[i] = (uint8_t)(i + 1);
+    }
+    expected[0] = 0xFF;
+    for (i = 0; i < 254; i++)
+    {
+        expected[i + 1] = (uint8_t)(i + 1);
+    }
+    expected[255] = 0x02;
+    expected[256] = 0xFF;
+    CheckCobsVector(in, 255, expected, 257);
+
+    /* 02..FF 00 */
+    for (i = 0; i < 254; i++)
+    {
+        in[i] = (uint8_t)(i + 2);
+        expected[i + 1] = (uint8_t)(i + 2);
+    }
+    in[254] = 0x00;
+    expected[0] = 0xFF;
+    expected[255] = 0x01;
+    expected[256] = 0x01;
+    CheckCobsVector(in, 255, expected, 257);
+
+    /* 03..FF 00 01 */
+    for (i = 0; i < 253; i++)
+    {
+        in[i] = (uint8_t)(i + 3);
+        expected[i + 1] = (uint8_t)(i + 3);
+    }
+    in[253] = 0x00;
+    in[254] = 0x01;
+    expected[0] = 0xFE;
+    expected[254] = 0x02;
+    expected[255] = 0x01;
+    CheckCobsVector(in, 255, expected, 256);
+
+    /* 508 non-zero bytes: exactly two full blocks */
+    for (i = 0; i < 508; i++)
+    {
+        in[i] = (uint8_t)((i % 255) + 1);
+    }
+    expected[0] = 0xFF;
+    for (i = 0; i < 254; i++)
+    {
+        expected[i + 1] = in[i];
+        expected[i + 256] = in[i + 254];
+    }
+    expected[255] = 0xFF;
+    CheckCobsVector(in, 508, expected, 510);
+}
+
+static void TestCobsRandom(void)
+{
+    static uint8_t in[mMaxLen_c];
+    static uint8_t encoded[COBS_ENCODED_MAX_SIZE(mMaxLen_c)];
+    static uint8_t inPlace[COBS_ENCODED_MAX_SIZE(mMaxLen_c)];
+    static uint8_t decoded[mMaxLen_c];
+    uint32_t round;
+    uint32_t len;
+    uint32_t zeroRate;
+    uint32_t i;
+    uint32_t n;
+    uint32_t zeros;
+
+    for (round = 0; round < 5000; round++)
+    {
+        len = HostTest_Rand(&mSeed) % mMaxLen_c;
+
+        /* From no zeros at all (long runs) to mostly zeros */
+        zeroRate = HostTest_Rand(&mSeed) % 5;
+
+        for (i = 0; i < len; i++)
+        {
+            if (zeroRate && ((HostTest_Rand(&mSeed) % (zeroRate * 64)) < zeroRate * zeroRate))
+            {
+                in[i] = 0;
+            }
+            else
+            {
+                in[i] = (uint8_t)((HostTest_Rand(&mSeed) % 255) + 1);
+            }
+        }
+
+        n = cobs_encode(in, len, encoded);
+        HOST_CHECK(n <= COBS_ENCODED_MAX_SIZE(len));
+
+        for (i = 0, zeros = 0; i < n; i++)
+        {
+            zeros += (encoded[i] == 0);
+        }
+        HOST_CHECK(zeros == 0);
+
+        HOST_CHECK(cobs_decode(encoded, n, decoded, sizeof(decoded)) == len);
+        HOST_CHECK_MEM(decoded, in, len);
+
+        /* Decoding over the encoded frame */
+        memcpy(inPlace, encoded, n);
+        HOST_CHECK(cobs_decode(inPlace, n, inPlace, sizeof(inPlace)) == len);
+        HOST_CHECK_MEM(inPlace, in, len);
+
+        /* Encoding in place */
+        memcpy(&inPlace[COBS_IN_PLACE_OFFSET(len)], in, len);
+        HOST_CHECK(cobs_encode(&inPlace[COBS_IN_PLACE_OFFSET(len)], len, inPlace) == n);
+        HOST_CHECK_MEM(inPlace, encoded, n);
+    }
+}
+
+static void TestCobsInvalid(void)
+{
+    const uint8_t zeroCode[] = { 0x03, 0x11, 0x00, 0x22 };
+    const uint8_t zeroData[] = { 0x03, 0x11, 0x00 };
+    const uint8_t pastEnd[] = { 0x05, 0x11, 0x22 };
+    const uint8_t valid[] = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+    uint8_t out[8];
+
+    HOST_CHECK(cobs_decode(zeroCode, sizeof(zeroCode), out, sizeof(out)) == 0);
+    HOST_CHECK(cobs_decode(zeroData, sizeof(zeroData), out, sizeof(out)) == 0);
+    HOST_CHECK(cobs_decode(pastEnd, sizeof(pastEnd), out, sizeof(out)) == 0);
+
+    /* 4 bytes decoded: fits in 4, not in 3 */
+    HOST_CHECK(cobs_decode(valid, sizeof(valid), out, 4) == 4);
+    HOST_CHECK(cobs_decode(valid, sizeof(valid), out, 3) == 0);
+}
+
+int main(void)
+{
+    TestCrcCheckValues();
+    TestCrcRandom();
+    TestCobsVectors();
+    TestCobsRandom();
+    TestCobsInvalid();
+
+    return HostTest_Report("crc_cobs CRC16_ENGINE=" STR(CRC16_ENGINE));
+}
@@ -0,0 +1,610 @@
+/*! *********************************************************************************
+* \file
+*
+* Host stress test of framework/MemManager with allocations and frees from
+* interrupts. The Makefile builds this file with gMemLockFreePools_d 0 and 1.
+*
+* The main thread is the task. Two signals are the interrupts: SIGUSR1 is the
+* low priority one and SIGUSR2 the high priority one, which preempts the low
+* priority handler but not the other way round. Each one is raised by a one
+* shot timer that its handler rearms with a random delay, so they land anywhere
+* in the task, including inside MEM_BufferAllocWithId(), MEM_BufferFree() and
+* MEM_BufferRetain(), and the high priority one lands in the low priority one.
+* OSA_InterruptDisable() blocks both signals, as PRIMASK does on the target.
+*
+* Every context allocates, fills, checks and frees its own buffers, hands
+* buffers it allocated to the task, and the task hands buffers to the
+* interrupts with an extra reference (MEM_BufferRetain), so that the last
+* reference may be dropped from either side. The test checks that:
+*   - a block is never handed to two owners and its data is never overwritten;
+*   - every free succeeds and, at the end, every block is back in its pool,
+*     and every pool can be allocated up to its number of blocks again;
+*   - the pool statistics match the allocations counted by the test;
+*   - with gMemLockFreePools_d, the Memory Manager never disables interrupts.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "host_test.h"
+#include "MemManager.h"
+#include "Panic.h"
+#include "fsl_os_abstraction.h"
+
+#define STR_(x)             #x
+#define STR(x)              STR_(x)
+
+#define mIsrLow_c           SIGUSR1
+#define mIsrHigh_c          SIGUSR2
+
+#define mHeldMax_c          8
+#define mMailboxSize_c      8       /* power of 2 */
+#define mMaxRequest_c       540     /* above the largest block, so some requests fail */
+
+/* The task runs at least mMinLoops_c iterations and until the interrupts have
+   preempted it inside the Memory Manager, and each other, often enough */
+#define mMinLoops_c         2000000
+#define mMinPreempted_c     5000
+#define mMinNested_c        500
+#define mTimeLimit_c        60      /* s */
+
+/* Random delay of the interrupt timers, in ns */
+#define mIsrDelayMin_c      2000
+#define mIsrDelayRange_c    30000
+
+typedef enum
+{
+    mTask_c = 1,
+    mIsrLowCtx_c,
+    mIsrHighCtx_c
+} memContextId_t;
+
+typedef struct heldBuffer_tag
+{
+    uint8_t    *pData;
+    uint16_t    size;
+} heldBuffer_t;
+
+/* Single producer, single consumer queue of buffers between two contexts */
+typedef struct mailbox_tag
+{
+    heldBuffer_t    buffers[mMailboxSize_c];
+    uint32_t        head;
+    uint32_t        tail;
+} mailbox_t;
+
+typedef struct memContext_tag
+{
+    memContextId_t  id;
+    uint32_t        seed;
+    heldBuffer_t    held[mHeldMax_c];
+    uint8_t         count;
+    mailbox_t       toTask;     /* Produced by an interrupt, consumed by the task */
+    mailbox_t       fromTask;   /* Produced by the task, consumed by an interrupt */
+    uint32_t        allocs;     /* Successful allocations */
+    uint32_t        calls;      /* Memory Manager calls */
+    timer_t         timer;      /* Raises the interrupt */
+} memContext_t;
+
+extern uint32_t memHeap[];
+extern uint16_t gFreeMessagesCount;
+
+static memContext_t mTask = { mTask_c, 0x6D2B79F5 };
+static memContext_t mIsrLow = { mIsrLowCtx_c, 0x1B873593 };
+static memContext_t mIsrHigh = { mIsrHighCtx_c, 0xCC9E2D51 };
+
+/* Context owning each block, indexed by the word offset of its data in the heap */
+static uint8_t mOwner[0x10000];
+
+static volatile sig_atomic_t mStop;
+
+/* Interrupt masking */
+static sigset_t mIsrSignals;
+static sigset_t mSavedMask;
+static uint32_t mDisableNesting;
+static volatile uint32_t mDisableCalls;
+
+/* Preemption counters */
+static volatile sig_atomic_t mTaskInMem;
+static volatile sig_atomic_t mIsrLowActive;
+static volatile uint32_t mPreempted;
+static volatile uint32_t mNested;
+
+/* Failures seen in a handler, reported by the task */
+static volatile uint32_t mIsrErrors;
+
+/************************************************************************************
+* Target stand-ins
+************************************************************************************/
+
+void OSA_InterruptDisable(void)
+{
+    sigset_t saved;
+
+    /* The interrupts are masked before the nesting counter is touched */
+    sigprocmask(SIG_BLOCK, &mIsrSignals, &saved);
+    if (mDisableNesting++ == 0)
+    {
+        mSavedMask = saved;
+    }
+    mDisableCalls++;
+}
+
+void OSA_InterruptEnable(void)
+{
+    if (--mDisableNesting == 0)
+    {
+        sigprocmask(SIG_SETMASK, &mSavedMask, NULL);
+    }
+}
+
+void panic(panicId_t id, uint32_t location, uint32_t extra1, uint32_t extra2)
+{
+    printf("panic(0x%x, 0x%x, 0x%x, 0x%x)\n", id, location, extra1, extra2);
+    abort();
+}
+
+/************************************************************************************
+* Buffers
+************************************************************************************/
+
+/* Counts a failure from any context; printf is not used in the handlers */
+static void Fail(memContext_t *pCtx)
+{
+    if (pCtx->id == mTask_c)
+    {
+        HOST_CHECK(0);
+    }
+    else
+    {
+        __atomic_add_fetch(&mIsrErrors, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static uint32_t BlockIndex(const uint8_t *pData)
+{
+    return (uint32_t)((const uint32_t *)pData - memHeap);
+}
+
+static void Fill(heldBuffer_t *pBuffer, uint8_t pattern)
+{
+    memset(pBuffer->pData, pattern, pBuffer->size);
+}
+
+static bool_t Check(const heldBuffer_t *pBuffer, uint8_t pattern)
+{
+    uint16_t i;
+
+    for (i = 0; i < pBuffer->size; i++)
+    {
+        if (pBuffer->pData[i] != pattern)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void EnterMem(memContext_t *pCtx)
+{
+    pCtx->calls++;
+    if (pCtx->id == mTask_c)
+    {
+        mTaskInMem = 1;
+    }
+}
+
+static void ExitMem(memContext_t *pCtx)
+{
+    if (pCtx->id == mTask_c)
+    {
+        mTaskInMem = 0;
+    }
+}
+
+/* Allocates a buffer and takes the ownership of its block */
+static void CtxAlloc(memContext_t *pCtx)
+{
+    heldBuffer_t buffer;
+    uint8_t poolId = (uint8_t)(HostTest_Rand(&pCtx->seed) & 1);
+    uint8_t noOwner = 0;
+
+    buffer.size = (uint16_t)(1 + HostTest_Rand(&pCtx->seed) % mMaxRequest_c);
+
+    EnterMem(pCtx);
+    buffer.pData = MEM_BufferAllocWithId(buffer.size, poolId, NULL);
+    ExitMem(pCtx);
+
+    if (buffer.pData == NULL)
+    {
+        return;
+    }
+
+    pCtx->allocs++;
+
+    if ((BlockIndex(buffer.pData) >= sizeof(mOwner)) ||
+        (MEM_BufferGetSize(buffer.pData) < buffer.size) ||
+        !__atomic_compare_exchange_n(&mOwner[BlockIndex(buffer.pData)], &noOwner, (uint8_t)pCtx->id,
+                                     FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+        /* Out of the heap, too small, or owned by another context */
+        Fail(pCtx);
+        return;
+    }
+
+    Fill(&buffer, (uint8_t)pCtx->id);
+    pCtx->held[pCtx->count++] = buffer;
+}
+
+/* Gives up the ownership of a held buffer and removes it from the held ones */
+static heldBuffer_t CtxRelease(memContext_t *pCtx, uint8_t idx)
+{
+    heldBuffer_t buffer = pCtx->held[idx];
+
+    if (!Check(&buffer, (uint8_t)pCtx->id) ||
+        (__atomic_exchange_n(&mOwner[BlockIndex(buffer.pData)], 0, __ATOMIC_SEQ_CST) != pCtx->id))
+    {
+        Fail(pCtx);
+    }
+
+    pCtx->held[idx] = pCtx->held[--pCtx->count];
+
+    return buffer;
+}
+
+static void CtxFreeBuffer(memContext_t *pCtx, void *pData)
+{
+    memStatus_t status;
+
+    EnterMem(pCtx);
+    status = MEM_BufferFree(pData);
+    ExitMem(pCtx);
+
+    if (status != MEM_SUCCESS_c)
+    {
+        Fail(pCtx);
+    }
+}
+
+static void CtxFree(memContext_t *pCtx, uint8_t idx)
+{
+    heldBuffer_t buffer = CtxRelease(pCtx, idx);
+
+    CtxFreeBuffer(pCtx, buffer.pData);
+}
+
+static bool_t MailboxPut(mailbox_t *pBox, heldBuffer_t buffer)
+{
+    uint32_t head = __atomic_load_n(&pBox->head, __ATOMIC_RELAXED);
+
+    if ((head - __atomic_load_n(&pBox->tail, __ATOMIC_ACQUIRE)) == mMailboxSize_c)
+    {
+        return FALSE;
+    }
+
+    pBox->buffers[head & (mMailboxSize_c - 1)] = buffer;
+    __atomic_store_n(&pBox->head, head + 1, __ATOMIC_RELEASE);
+
+    return TRUE;
+}
+
+static bool_t MailboxGet(mailbox_t *pBox, heldBuffer_t *pBuffer)
+{
+    uint32_t tail = __atomic_load_n(&pBox->tail, __ATOMIC_RELAXED);
+
+    if (tail == __atomic_load_n(&pBox->head, __ATOMIC_ACQUIRE))
+    {
+        return FALSE;
+    }
+
+    *pBuffer = pBox->buffers[tail & (mMailboxSize_c - 1)];
+    __atomic_store_n(&pBox->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return TRUE;
+}
+
+/* Frees the buffers received from the other side of a mailbox. Their data is
+   read only and filled with the pattern of the sender. */
+static void CtxDrain(memContext_t *pCtx, mailbox_t *pBox, uint8_t pattern)
+{
+    heldBuffer_t buffer;
+
+    while (MailboxGet(pBox, &buffer))
+    {
+        if (!Check(&buffer, pattern))
+        {
+            Fail(pCtx);
+        }
+        CtxFreeBuffer(pCtx, buffer.pData);
+    }
+}
+
+/************************************************************************************
+* Contexts
+************************************************************************************/
+
+/* One random operation of an interrupt handler */
+static void IsrStep(memContext_t *pCtx)
+{
+    uint32_t op = HostTest_Rand(&pCtx->seed) % 8;
+
+    if ((op < 3) && (pCtx->count < mHeldMax_c))
+    {
+        CtxAlloc(pCtx);
+    }
+    else if ((op < 5) && pCtx->count)
+    {
+        CtxFree(pCtx, (uint8_t)(HostTest_Rand(&pCtx->seed) % pCtx->count));
+    }
+    else if ((op < 6) && pCtx->count)
+    {
+        /* Received data, handed to the task */
+        uint8_t idx = (uint8_t)(HostTest_Rand(&pCtx->seed) % pCtx->count);
+        heldBuffer_t buffer = pCtx->held[idx];
+
+        if (MailboxPut(&pCtx->toTask, buffer))
+        {
+            (void)CtxRelease(pCtx, idx);
+        }
+    }
+    else
+    {
+        /* Transmission complete: drop the references of the task */
+        CtxDrain(pCtx, &pCtx->fromTask, mTask_c);
+    }
+}
+
+/* Raises the interrupt of a context again after a random delay */
+static void IsrRearm(memContext_t *pCtx)
+{
+    struct itimerspec delay;
+
+    if (!mStop)
+    {
+        memset(&delay, 0, sizeof(delay));
+        delay.it_value.tv_nsec = mIsrDelayMin_c + (long)(HostTest_Rand(&pCtx->seed) % mIsrDelayRange_c);
+        timer_settime(pCtx->timer, 0, &delay, NULL);
+    }
+}
+
+static void IsrLowHandler(int sig)
+{
+    uint32_t steps = 1 + HostTest_Rand(&mIsrLow.seed) % 3;
+
+    (void)sig;
+    mIsrLowActive = 1;
+    if (mTaskInMem)
+    {
+        mPreempted++;
+    }
+
+    while (steps--)
+    {
+        IsrStep(&mIsrLow);
+    }
+
+    mIsrLowActive = 0;
+    IsrRearm(&mIsrLow);
+}
+
+static void IsrHighHandler(int sig)
+{
+    (void)sig;
+    if (mIsrLowActive)
+    {
+        mNested++;
+    }
+    else if (mTaskInMem)
+    {
+        mPreempted++;
+    }
+
+    IsrStep(&mIsrHigh);
+    IsrRearm(&mIsrHigh);
+}
+
+/* One random operation of the task */
+static void TaskStep(void)
+{
+    uint32_t op = HostTest_Rand(&mTask.seed) % 10;
+    memContext_t *pIsr = (op & 1) ? &mIsrLow : &mIsrHigh;
+
+    if ((op < 4) && (mTask.count < mHeldMax_c))
+    {
+        CtxAlloc(&mTask);
+    }
+    else if ((op < 6) && mTask.count)
+    {
+        CtxFree(&mTask, (uint8_t)(HostTest_Rand(&mTask.seed) % mTask.count));
+    }
+    else if ((op < 8) && mTask.count)
+    {
+        /* Transmit a buffer through an interrupt and keep no reference */
+        uint8_t idx = (uint8_t)(HostTest_Rand(&mTask.seed) % mTask.count);
+        heldBuffer_t buffer = mTask.held[idx];
+        memStatus_t status;
+
+        EnterMem(&mTask);
+        status = MEM_BufferRetain(buffer.pData);
+        ExitMem(&mTask);
+        HOST_CHECK(status == MEM_SUCCESS_c);
+
+        if (MailboxPut(&pIsr->fromTask, buffer))
+        {
+            /* The interrupt may drop its reference before the task */
+            (void)CtxRelease(&mTask, idx);
+            CtxFreeBuffer(&mTask, buffer.pData);
+        }
+        else
+        {
+            CtxFreeBuffer(&mTask, buffer.pData);
+        }
+    }
+    else
+    {
+        CtxDrain(&mTask, &pIsr->toTask, (uint8_t)pIsr->id);
+    }
+}
+
+/* Installs the handler of an interrupt and creates the timer raising it */
+static void IsrInit(memContext_t *pCtx, int sig, void (*handler)(int), const sigset_t *pMask)
+{
+    struct sigaction action;
+    struct sigevent event;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handler;
+    action.sa_mask = *pMask;
+    action.sa_flags = SA_RESTART;
+    sigaction(sig, &action, NULL);
+
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = sig;
+    timer_create(CLOCK_MONOTONIC, &event, &pCtx->timer);
+    IsrRearm(pCtx);
+}
+
+/* Frees everything held by a context */
+static void CtxFreeAll(memContext_t *pCtx)
+{
+    while (pCtx->count)
+    {
+        CtxFree(pCtx, 0);
+    }
+}
+
+/************************************************************************************
+* Final checks
+************************************************************************************/
+
+/* Allocates every block of a pool ID, each one once, and frees them */
+static void CheckPoolsRefill(uint8_t poolId)
+{
+    static void *blocks[256];
+    uint32_t expected = 0;
+    uint32_t count = 0;
+    uint8_t pool;
+
+    for (pool = 0; pool < MEM_GetPoolCount(); pool++)
+    {
+        if (MEM_GetPool(pool)->poolId == poolId)
+        {
+            expected += MEM_GetPool(pool)->numBlocks;
+        }
+    }
+
+    while ((count < 256) && ((blocks[count] = MEM_BufferAllocWithId(1, poolId, NULL)) != NULL))
+    {
+        HOST_CHECK(mOwner[BlockIndex(blocks[count])] == 0);
+        mOwner[BlockIndex(blocks[count])] = mTask_c;
+        count++;
+    }
+
+    HOST_CHECK(count == expected);
+
+    while (count)
+    {
+        count--;
+        mOwner[BlockIndex(blocks[count])] = 0;
+        HOST_CHECK(MEM_BufferFree(blocks[count]) == MEM_SUCCESS_c);
+    }
+}
+
+static void CheckFinalState(uint32_t totalBlocks)
+{
+    poolStat_t stat;
+    uint32_t allocations = 0;
+    uint8_t pool;
+
+    HOST_CHECK(gFreeMessagesCount == totalBlocks);
+    HOST_CHECK(MEM_GetAvailableBlocks(0) == totalBlocks);
+
+    for (pool = 0; pool < MEM_GetPoolCount(); pool++)
+    {
+        HOST_CHECK(MEM_GetPool(pool)->allocatedBlocks == 0);
+        HOST_CHECK(MEM_GetPoolStatistics(pool, &stat));
+        HOST_CHECK(stat.allocatedBlocks == 0);
+        HOST_CHECK(stat.allocatedBlocksPeak <= stat.numBlocks);
+        HOST_CHECK(stat.freeFailures == 0);
+        allocations += stat.allocations;
+    }
+
+    HOST_CHECK(allocations == (mTask.allocs + mIsrLow.allocs + mIsrHigh.allocs));
+
+    CheckPoolsRefill(0);
+    CheckPoolsRefill(1);
+
+    HOST_CHECK(gFreeMessagesCount == totalBlocks);
+}
+
+int main(void)
+{
+    sigset_t lowMask;
+    sigset_t highMask;
+    uint32_t totalBlocks;
+    uint32_t loops = 0;
+    uint32_t disableCalls;
+    time_t start = time(NULL);
+
+    HOST_CHECK(MEM_Init() == MEM_SUCCESS_c);
+    totalBlocks = MEM_GetAvailableBlocks(0);
+
+    sigemptyset(&mIsrSignals);
+    sigaddset(&mIsrSignals, mIsrLow_c);
+    sigaddset(&mIsrSignals, mIsrHigh_c);
+
+    /* The high priority handler blocks both, the low priority one only itself */
+    sigemptyset(&lowMask);
+    sigaddset(&lowMask, mIsrLow_c);
+    highMask = mIsrSignals;
+    mDisableCalls = 0;
+    IsrInit(&mIsrLow, mIsrLow_c, IsrLowHandler, &lowMask);
+    IsrInit(&mIsrHigh, mIsrHigh_c, IsrHighHandler, &highMask);
+
+    while ((loops < mMinLoops_c) || (mPreempted < mMinPreempted_c) || (mNested < mMinNested_c))
+    {
+        TaskStep();
+        loops++;
+
+        if (((loops & 0xFFFF) == 0) && ((time(NULL) - start) > mTimeLimit_c))
+        {
+            break;
+        }
+    }
+
+    /* The interrupts stop rearming and stay masked from here on */
+    mStop = 1;
+    sigprocmask(SIG_BLOCK, &mIsrSignals, NULL);
+    disableCalls = mDisableCalls;
+
+    HOST_CHECK(mPreempted >= mMinPreempted_c);
+    HOST_CHECK(mNested >= mMinNested_c);
+#if gMemLockFreePools_d
+    HOST_CHECK(disableCalls == 0);
+#else
+    HOST_CHECK(disableCalls != 0);
+#endif
+
+    /* Return everything from the task */
+    CtxDrain(&mTask, &mIsrLow.toTask, mIsrLowCtx_c);
+    CtxDrain(&mTask, &mIsrHigh.toTask, mIsrHighCtx_c);
+    CtxDrain(&mTask, &mIsrLow.fromTask, mTask_c);
+    CtxDrain(&mTask, &mIsrHigh.fromTask, mTask_c);
+    CtxFreeAll(&mIsrLow);
+    CtxFreeAll(&mIsrHigh);
+    CtxFreeAll(&mTask);
+    HOST_CHECK(mIsrErrors == 0);
+
+    CheckFinalState(totalBlocks);
+
+    printf("mem_isr: %u task loops, %u/%u/%u calls (task/low/high), %u preempted in MEM, %u nested, "
+           "%u interrupt disables\n", loops, mTask.calls, mIsrLow.calls, mIsrHigh.calls,
+           mPreempted, mNested, disableCalls);
+
+    return HostTest_Report("mem_isr lock-free=" STR(gMemLockFreePools_d));
+}
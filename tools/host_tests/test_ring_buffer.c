@@ -0,0 +1,444 @@
+/*! *********************************************************************************
+* \file
+*
+* Host tests of the ring buffer (source/Logicalis_HAL/ring_buffer.c).
+*
+*   - writes and reads that wrap around the end of the array;
+*   - a write that does not fit discards the oldest bytes, and idxRead lands
+*     right after idxWrite;
+*   - idxLock limits the reads, follows idxRead one position ahead when the
+*     discard passes it, and DiscardLock() rolls the writes back;
+*   - ringbuf_WriteStr() appends the terminator and accounts for it in the
+*     discard, also for strings longer than the buffer;
+*   - negative lengths write and read nothing;
+*   - random operations on buffers of 1 to 17000 bytes give the same indices,
+*     array contents and return values as one ringbuf_WriteByte() or
+*     ringbuf_ReadByte() per byte, including writes and reads above
+*     RINGBUF_MAX_SIZE.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "ring_buffer.h"
+
+#define mMaxBufSize_c       17000
+#define mMaxIoSize_c        (mMaxBufSize_c + 600)  /* above RINGBUF_MAX_SIZE too */
+
+static uint32_t mSeed = 0x3C6EF372;
+
+/************************************************************************************
+* Reference: one byte at a time
+************************************************************************************/
+
+static void RefWrite(ringbuf_t *pRingBuf, const uint8_t *pInput, int32_t bytesToWrite)
+{
+    int32_t i;
+
+    for (i = 0; (i < bytesToWrite) && (i < (int32_t)RINGBUF_MAX_SIZE); i++)
+    {
+        ringbuf_WriteByte(pRingBuf, pInput[i]);
+    }
+}
+
+static void RefWriteStr(ringbuf_t *pRingBuf, const char *str)
+{
+    int32_t i;
+
+    for (i = 0; str[i] && (i < (int32_t)RINGBUF_MAX_SIZE); i++)
+    {
+        ringbuf_WriteByte(pRingBuf, (uint8_t)str[i]);
+    }
+    ringbuf_WriteByte(pRingBuf, '\0');
+}
+
+static int32_t RefRead(ringbuf_t *pRingBuf, uint8_t *pOutput, int32_t bytesToRead)
+{
+    int32_t i;
+
+    if ((bytesToRead <= 0) || (bytesToRead > ringbuf_TotReadable(pRingBuf)))
+    {
+        return 0;
+    }
+
+    for (i = 0; (i < bytesToRead) && (i < (int32_t)RINGBUF_MAX_SIZE); i++)
+    {
+        HOST_CHECK(ringbuf_ReadByte(pRingBuf, &pOutput[i]));
+    }
+
+    return i;
+}
+
+/************************************************************************************
+* Helpers
+************************************************************************************/
+
+static void Fill(uint8_t *pData, int32_t len, uint8_t first)
+{
+    int32_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        pData[i] = (uint8_t)(first + i);
+    }
+}
+
+static void CheckIndices(ringbuf_t *pRingBuf, int32_t idxRead, int32_t idxWrite, int32_t idxLock)
+{
+    HOST_CHECK(pRingBuf->idxRead == idxRead);
+    HOST_CHECK(pRingBuf->idxWrite == idxWrite);
+    HOST_CHECK(pRingBuf->idxLock == idxLock);
+}
+
+static void CheckSame(ringbuf_t *pA, ringbuf_t *pB)
+{
+    HOST_CHECK(pA->idxRead == pB->idxRead);
+    HOST_CHECK(pA->idxWrite == pB->idxWrite);
+    HOST_CHECK(pA->idxLock == pB->idxLock);
+    HOST_CHECK_MEM(pA->pBuf, pB->pBuf, pA->size);
+}
+
+/************************************************************************************
+* Directed cases
+************************************************************************************/
+
+static void TestWrap(void)
+{
+    uint8_t array[8];
+    uint8_t in[8];
+    uint8_t out[8];
+    ringbuf_t rb;
+
+    HOST_CHECK(ringbuf_init(&rb, array, sizeof(array)));
+    HOST_CHECK(ringbuf_Capacity(&rb) == 7);
+
+    Fill(in, 5, 0x10);
+    ringbuf_Write(&rb, in, 5);
+    HOST_CHECK(ringbuf_Read(&rb, out, 5) == 5);
+    HOST_CHECK_MEM(out, in, 5);
+    CheckIndices(&rb, 5, 5, -1);
+
+    /* 3 bytes to the end of the array, 3 from its start */
+    Fill(in, 6, 0x20);
+    ringbuf_Write(&rb, in, 6);
+    CheckIndices(&rb, 5, 3, -1);
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 6);
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 6);
+
+    /* More than is readable: nothing is read */
+    HOST_CHECK(ringbuf_Read(&rb, out, 7) == 0);
+    HOST_CHECK(ringbuf_Read(&rb, out, 6) == 6);
+    HOST_CHECK_MEM(out, in, 6);
+    CheckIndices(&rb, 3, 3, -1);
+    HOST_CHECK(ringbuf_IsEmpty(&rb));
+
+    /* A write ending exactly at the end of the array */
+    ringbuf_Clear(&rb);
+    ringbuf_Write(&rb, in, 3);
+    (void)ringbuf_Read(&rb, out, 3);
+    ringbuf_Write(&rb, in, 5);
+    CheckIndices(&rb, 3, 0, -1);
+    HOST_CHECK(ringbuf_Read(&rb, out, 5) == 5);
+    HOST_CHECK_MEM(out, in, 5);
+}
+
+static void TestOverflow(void)
+{
+    uint8_t array[8];
+    uint8_t in[40];
+    uint8_t out[8];
+    ringbuf_t rb;
+
+    (void)ringbuf_init(&rb, array, sizeof(array));
+
+    /* 3 + 10 bytes: the 6 oldest are discarded */
+    Fill(in, 3, 0x30);
+    ringbuf_Write(&rb, in, 3);
+    Fill(in, 10, 0x40);
+    ringbuf_Write(&rb, in, 10);
+    CheckIndices(&rb, 6, 5, -1);
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 7);
+    HOST_CHECK(ringbuf_Read(&rb, out, 7) == 7);
+    HOST_CHECK_MEM(out, &in[3], 7);
+
+    /* Exactly full: nothing discarded */
+    ringbuf_Clear(&rb);
+    ringbuf_Write(&rb, in, 7);
+    CheckIndices(&rb, 0, 7, -1);
+
+    /* One more byte discards one */
+    ringbuf_Write(&rb, in, 1);
+    CheckIndices(&rb, 1, 0, -1);
+
+    /* Several times the size of the buffer */
+    Fill(in, sizeof(in), 0x50);
+    ringbuf_Write(&rb, in, sizeof(in));
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 7);
+    HOST_CHECK(rb.idxRead == ((rb.idxWrite + 1) % 8));
+    HOST_CHECK(ringbuf_Read(&rb, out, 7) == 7);
+    HOST_CHECK_MEM(out, &in[sizeof(in) - 7], 7);
+}
+
+static void TestLock(void)
+{
+    uint8_t array[8];
+    uint8_t in[16];
+    uint8_t out[8];
+    ringbuf_t rb;
+
+    (void)ringbuf_init(&rb, array, sizeof(array));
+    Fill(in, sizeof(in), 0x60);
+
+    /* Locked bytes are not readable */
+    ringbuf_Write(&rb, in, 4);
+    ringbuf_Lock(&rb);
+    ringbuf_Write(&rb, &in[4], 2);
+    CheckIndices(&rb, 0, 6, 4);
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 6);
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 4);
+    HOST_CHECK(ringbuf_Read(&rb, out, 5) == 0);
+    HOST_CHECK(ringbuf_Read(&rb, out, 4) == 4);
+    HOST_CHECK_MEM(out, in, 4);
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 0);
+    HOST_CHECK(!ringbuf_ReadByte(&rb, out));
+
+    /* Rollback */
+    ringbuf_DiscardLock(&rb);
+    CheckIndices(&rb, 4, 4, -1);
+    HOST_CHECK(ringbuf_IsEmpty(&rb));
+
+    /* Commit */
+    ringbuf_Lock(&rb);
+    ringbuf_Write(&rb, in, 3);
+    ringbuf_Unlock(&rb);
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 3);
+
+    /* A discard that stops before idxLock leaves it alone */
+    ringbuf_Clear(&rb);
+    ringbuf_Write(&rb, in, 2);
+    ringbuf_Lock(&rb);
+    ringbuf_Write(&rb, &in[2], 6);
+    CheckIndices(&rb, 1, 0, 2);
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 1);
+
+    /* idxRead reaches idxLock: idxLock follows it, one position ahead */
+    ringbuf_Write(&rb, &in[8], 1);
+    CheckIndices(&rb, 2, 1, 3);
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 1);
+
+    /* A discard that passes idxLock by several bytes in one write */
+    ringbuf_Clear(&rb);
+    ringbuf_Write(&rb, in, 3);
+    ringbuf_Lock(&rb);
+    ringbuf_Write(&rb, &in[3], 9);
+    CheckIndices(&rb, 5, 4, 6);
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 1);
+    HOST_CHECK(ringbuf_Read(&rb, out, 1) == 1);
+    HOST_CHECK(out[0] == in[5]);
+}
+
+static void TestWriteStr(void)
+{
+    const char *pLong = "0123456789abcdefghijklmnopqrstuvwxyzABCD";
+    uint8_t array[16];
+    uint8_t out[16];
+    ringbuf_t rb;
+
+    (void)ringbuf_init(&rb, array, sizeof(array));
+
+    ringbuf_WriteStr(&rb, "hello");
+    CheckIndices(&rb, 0, 6, -1);
+    HOST_CHECK(ringbuf_Read(&rb, out, 6) == 6);
+    HOST_CHECK_MEM(out, "hello", 6);
+
+    /* Empty string: only the terminator */
+    ringbuf_WriteStr(&rb, "");
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 1);
+    HOST_CHECK(ringbuf_ReadByte(&rb, out) && (out[0] == '\0'));
+
+    /* Wraps: 10 bytes from index 7 */
+    ringbuf_WriteStr(&rb, "wrapping!");
+    CheckIndices(&rb, 7, 1, -1);
+    HOST_CHECK(ringbuf_Read(&rb, out, 10) == 10);
+    HOST_CHECK_MEM(out, "wrapping!", 10);
+
+    /* The string fills the buffer, the terminator discards one byte */
+    ringbuf_Clear(&rb);
+    ringbuf_WriteByte(&rb, 'x');
+    ringbuf_WriteStr(&rb, "0123456789abcd");
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 15);
+    CheckIndices(&rb, 1, 0, -1);
+    HOST_CHECK(ringbuf_Read(&rb, out, 15) == 15);
+    HOST_CHECK_MEM(out, "0123456789abcd", 15);
+
+    /* Longer than the buffer: the terminator and the last 14 characters */
+    ringbuf_Clear(&rb);
+    ringbuf_WriteStr(&rb, (char *)pLong);
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 15);
+    HOST_CHECK(rb.idxRead == ((rb.idxWrite + 1) % 16));
+    HOST_CHECK(ringbuf_Read(&rb, out, 15) == 15);
+    HOST_CHECK_MEM(out, pLong + strlen(pLong) - 14, 15);
+
+    /* The string stops the discard right before idxLock, the terminator passes it */
+    ringbuf_Clear(&rb);
+    ringbuf_WriteStr(&rb, "abc");
+    ringbuf_Lock(&rb);
+    ringbuf_WriteStr(&rb, "0123456789abcd");
+    CheckIndices(&rb, 4, 3, 5);
+    HOST_CHECK(ringbuf_TotWriten(&rb) == 15);
+    HOST_CHECK(rb.idxLock == ((rb.idxRead + 1) % 16));
+    HOST_CHECK(ringbuf_TotReadable(&rb) == 1);
+}
+
+static void TestNegativeLength(void)
+{
+    uint8_t array[8];
+    uint8_t out[8];
+    ringbuf_t rb;
+
+    (void)ringbuf_init(&rb, array, sizeof(array));
+    ringbuf_Write(&rb, (uint8_t *)"abc", 3);
+
+    ringbuf_Write(&rb, (uint8_t *)"abc", -5);
+    ringbuf_Write(&rb, (uint8_t *)"abc", 0);
+    CheckIndices(&rb, 0, 3, -1);
+
+    HOST_CHECK(ringbuf_Read(&rb, out, -1) == 0);
+    HOST_CHECK(ringbuf_Read(&rb, out, 0) == 0);
+    CheckIndices(&rb, 0, 3, -1);
+}
+
+/************************************************************************************
+* Random operations against the reference
+************************************************************************************/
+
+static int32_t RandomLength(int32_t size)
+{
+    switch (HostTest_Rand(&mSeed) % 6)
+    {
+    case 0:
+        return (int32_t)(HostTest_Rand(&mSeed) % 4);
+    case 1:
+        return (int32_t)(HostTest_Rand(&mSeed) % (size + 2));
+    case 2:
+        /* Around the size of the buffer */
+        return size - 2 + (int32_t)(HostTest_Rand(&mSeed) % 5);
+    case 3:
+        return (int32_t)(HostTest_Rand(&mSeed) % mMaxIoSize_c);
+    default:
+        return (int32_t)(HostTest_Rand(&mSeed) % 64);
+    }
+}
+
+static void TestRandom(void)
+{
+    static uint8_t arrayA[mMaxBufSize_c];
+    static uint8_t arrayB[mMaxBufSize_c];
+    static uint8_t in[mMaxIoSize_c + 1];
+    static uint8_t outA[mMaxIoSize_c];
+    static uint8_t outB[mMaxIoSize_c];
+    const int32_t sizes[] = { 1, 2, 3, 7, 8, 64, 255, 1000, RINGBUF_MAX_SIZE, mMaxBufSize_c };
+    ringbuf_t rbA;
+    ringbuf_t rbB;
+    uint32_t round;
+    uint32_t op;
+    int32_t size;
+    int32_t len;
+    int32_t readA;
+    int32_t i;
+
+    for (round = 0; round < 300000; round++)
+    {
+        if ((round % 3000) == 0)
+        {
+            size = ((round / 3000) & 1) ? sizes[(round / 6000) % (sizeof(sizes) / sizeof(sizes[0]))]
+                                        : 1 + (int32_t)(HostTest_Rand(&mSeed) % mMaxBufSize_c);
+            memset(arrayA, 0, sizeof(arrayA));
+            memset(arrayB, 0, sizeof(arrayB));
+            (void)ringbuf_init(&rbA, arrayA, size);
+            (void)ringbuf_init(&rbB, arrayB, size);
+        }
+
+        len = RandomLength(size);
+        op = HostTest_Rand(&mSeed) % 16;
+
+        if (op < 5)
+        {
+            for (i = 0; i < len; i++)
+            {
+                in[i] = (uint8_t)HostTest_Rand(&mSeed);
+            }
+            ringbuf_Write(&rbA, in, len);
+            RefWrite(&rbB, in, len);
+        }
+        else if (op < 7)
+        {
+            for (i = 0; i < len; i++)
+            {
+                in[i] = (uint8_t)(1 + HostTest_Rand(&mSeed) % 255);
+            }
+            in[len] = '\0';
+            ringbuf_WriteStr(&rbA, (char *)in);
+            RefWriteStr(&rbB, (char *)in);
+        }
+        else if (op < 11)
+        {
+            /* Often exactly what is readable */
+            if (op == 10)
+            {
+                len = ringbuf_TotReadable(&rbA);
+            }
+            readA = ringbuf_Read(&rbA, outA, len);
+            HOST_CHECK(readA == RefRead(&rbB, outB, len));
+            HOST_CHECK_MEM(outA, outB, readA);
+        }
+        else if (op == 11)
+        {
+            ringbuf_Lock(&rbA);
+            ringbuf_Lock(&rbB);
+        }
+        else if (op == 12)
+        {
+            ringbuf_Unlock(&rbA);
+            ringbuf_Unlock(&rbB);
+        }
+        else if (op == 13)
+        {
+            ringbuf_DiscardLock(&rbA);
+            ringbuf_DiscardLock(&rbB);
+        }
+        else if (op == 14)
+        {
+            len = (int32_t)(HostTest_Rand(&mSeed) % 8);
+            HOST_CHECK(ringbuf_Delete(&rbA, len) == ringbuf_Delete(&rbB, len));
+        }
+        else
+        {
+            for (i = 0; i < (len & 7); i++)
+            {
+                uint8_t data = (uint8_t)HostTest_Rand(&mSeed);
+
+                ringbuf_WriteByte(&rbA, data);
+                ringbuf_WriteByte(&rbB, data);
+            }
+        }
+
+        CheckSame(&rbA, &rbB);
+        HOST_CHECK(ringbuf_TotWriten(&rbA) <= ringbuf_Capacity(&rbA));
+        HOST_CHECK(ringbuf_TotReadable(&rbA) <= ringbuf_TotWriten(&rbA));
+    }
+}
+
+int main(void)
+{
+    TestWrap();
+    TestOverflow();
+    TestLock();
+    TestWriteStr();
+    TestNegativeLength();
+    TestRandom();
+
+    return HostTest_Report("ring_buffer");
+}
@@ -0,0 +1,780 @@
+/*! *********************************************************************************
+* \file
+*
+* Loopback test of the shell RPC mode: framework/Shell/Source/shell.c and
+* shell_rpc.c on one side of a simulated serial port, the host library
+* tools/rpc_client/shell_rpc_client.c on the other.
+*
+*   - text before the switch to frames is dropped by the host decoder;
+*   - every command ID of source/ble_shell_rpc_cmds.h (the mRpcCmds table of
+*     ble_shell.c, with every optional ID enabled) round trips through COBS and
+*     the CRC: the handler gets the command, the sub-command and the arguments
+*     of the request, its output comes back in OUTPUT frames, then the
+*     RESPONSE frame, with the seq and id of the request;
+*   - the reserved IDs, ASYNC commands with BREAK and DONE, unknown IDs, too
+*     many arguments, requests split over many reads;
+*   - the shell answers bad CRC, truncated, empty and oversized frames with
+*     ERROR frames, ignores consecutive delimiters, and keeps serving requests;
+*   - the host decoder reports bad CRC, truncated, bad length, bad encoding and
+*     bad type frames, and ignores consecutive delimiters.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "shell.h"
+#include "SerialManager.h"
+#include "MemManager.h"
+#include "TimersManager.h"
+#include "fsl_os_abstraction.h"
+#include "cobs.h"
+#include "crc16.h"
+#include "shell_rpc_client.h"
+
+#define mMaxFrames_c        64
+#define mMaxText_c          2048
+#define mMaxRequest_c       (SHELL_RPC_HEADER_SIZE + SHELL_CB_SIZE + SHELL_RPC_CRC_SIZE)
+
+typedef struct frame_tag
+{
+    rpcClientFrame_t    f;
+    uint8_t             data[RPC_CLIENT_MAX_DATA];
+} frame_t;
+
+/* Command IDs of the firmware */
+static const shell_rpc_cmd_t mRpcCmds[] =
+{
+#include "ble_shell_rpc_cmds.h"
+};
+
+/* Simulated serial port */
+static pSerialCallBack_t mpfShellRx;
+static void *mpShellRxParam;
+static uint8_t mRx[4096];
+static uint32_t mRxHead;
+static uint32_t mRxTail;
+
+/* Host side */
+static rpcClientDecoder_t mDecoder;
+static frame_t maFrames[mMaxFrames_c];
+static uint32_t mFrameCount;
+static uint32_t maDecodeErrors[rpcClientBadType_c + 1];
+static char mText[mMaxText_c];
+static uint32_t mTextLen;
+
+/* Commands */
+static char mOutput[mMaxText_c];
+static uint32_t mBreaks;
+
+/************************************************************************************
+* Target stand-ins
+************************************************************************************/
+
+void SerialManager_Init(void)
+{
+}
+
+serialStatus_t Serial_InitInterface(uint8_t *pInterfaceId, serialInterfaceType_t interfaceType, uint8_t instance)
+{
+    (void)interfaceType;
+    (void)instance;
+    *pInterfaceId = 0;
+
+    return gSerial_Success_c;
+}
+
+serialStatus_t Serial_SetBaudRate(uint8_t InterfaceId, uint32_t baudRate)
+{
+    (void)InterfaceId;
+    (void)baudRate;
+
+    return gSerial_Success_c;
+}
+
+serialStatus_t Serial_SetRxCallBack(uint8_t InterfaceId, pSerialCallBack_t cb, void *pRxParam)
+{
+    (void)InterfaceId;
+    mpfShellRx = cb;
+    mpShellRxParam = pRxParam;
+
+    return gSerial_Success_c;
+}
+
+serialStatus_t Serial_Read(uint8_t InterfaceId, uint8_t *pData, uint16_t dataSize, uint16_t *bytesRead)
+{
+    (void)InterfaceId;
+    *bytesRead = 0;
+
+    while( dataSize-- && (mRxTail != mRxHead) )
+    {
+        *pData++ = mRx[mRxTail++];
+        (*bytesRead)++;
+    }
+
+    return gSerial_Success_c;
+}
+
+serialStatus_t Serial_SyncWrite(uint8_t InterfaceId, uint8_t *pBuf, uint16_t bufLen)
+{
+    (void)InterfaceId;
+
+    if( mTextLen + bufLen <= sizeof(mText) )
+    {
+        memcpy(&mText[mTextLen], pBuf, bufLen);
+        mTextLen += bufLen;
+    }
+    rpc_client_decode(&mDecoder, pBuf, bufLen);
+
+    return gSerial_Success_c;
+}
+
+serialStatus_t Serial_AsyncWrite(uint8_t InterfaceId, uint8_t *pBuf, uint16_t bufLen,
+                                 pSerialCallBack_t cb, void *pTxParam)
+{
+    Serial_SyncWrite(InterfaceId, pBuf, bufLen);
+    if( cb )
+    {
+        cb(pTxParam);
+    }
+
+    return gSerial_Success_c;
+}
+
+serialStatus_t Serial_PrintHex(uint8_t InterfaceId, uint8_t *hex, uint8_t len, uint8_t flags)
+{
+    (void)InterfaceId;
+    (void)hex;
+    (void)len;
+    (void)flags;
+
+    return gSerial_Success_c;
+}
+
+serialStatus_t Serial_PrintDec(uint8_t InterfaceId, uint32_t nr)
+{
+    (void)InterfaceId;
+    (void)nr;
+
+    return gSerial_Success_c;
+}
+
+void* MEM_BufferAllocWithId(uint32_t numBytes, uint8_t poolId, void *pCaller)
+{
+    (void)poolId;
+    (void)pCaller;
+
+    return malloc(numBytes);
+}
+
+memStatus_t MEM_BufferFree(void* buffer)
+{
+    free(buffer);
+
+    return MEM_SUCCESS_c;
+}
+
+memStatus_t MEM_BufferRetain(void* buffer)
+{
+    (void)buffer;
+
+    return MEM_FREE_ERROR_c;
+}
+
+void MEM_BufferReleaseCallback(void* buffer)
+{
+    (void)buffer;
+}
+
+osaMutexId_t OSA_MutexCreate(void)
+{
+    return (osaMutexId_t)1;
+}
+
+osaStatus_t OSA_MutexLock(osaMutexId_t mutexId, uint32_t millisec)
+{
+    (void)mutexId;
+    (void)millisec;
+
+    return osaStatus_Success;
+}
+
+osaStatus_t OSA_MutexUnlock(osaMutexId_t mutexId)
+{
+    (void)mutexId;
+
+    return osaStatus_Success;
+}
+
+tmrTimerID_t TMR_AllocateTimer(void)
+{
+    return 0;
+}
+
+/* The output is flushed at the end of every shell_main() */
+tmrErrCode_t TMR_StartSingleShotTimer(tmrTimerID_t timerID, tmrTimeInMilliseconds_t timeInMilliseconds,
+                                      pfTmrCallBack_t callback, void *param)
+{
+    (void)timerID;
+    (void)timeInMilliseconds;
+    (void)callback;
+    (void)param;
+
+    return gTmrSuccess_c;
+}
+
+/************************************************************************************
+* Commands
+************************************************************************************/
+
+/* Writes its arguments, each followed by '|'. "thrput start" is ASYNC */
+static int8_t EchoCommand(uint8_t argc, char * argv[])
+{
+    uint8_t i;
+
+    if( argc == 0 )
+    {
+        mBreaks++;
+        return CMD_RET_SUCCESS;
+    }
+
+    for( i = 0; i < argc; i++ )
+    {
+        shell_write(argv[i]);
+        shell_write("|");
+    }
+
+    if( (argc > 1) && !strcmp(argv[0], "thrput") && !strcmp(argv[1], "start") )
+    {
+        return CMD_RET_ASYNC;
+    }
+
+    return CMD_RET_SUCCESS;
+}
+
+static cmd_tbl_t maCmds[] =
+{
+    { .name = "gap",    .maxargs = SHELL_MAX_ARGS, .repeatable = 0, .cmd = EchoCommand },
+    { .name = "gatt",   .maxargs = SHELL_MAX_ARGS, .repeatable = 0, .cmd = EchoCommand },
+    { .name = "gattdb", .maxargs = SHELL_MAX_ARGS, .repeatable = 0, .cmd = EchoCommand },
+    { .name = "thrput", .maxargs = SHELL_MAX_ARGS, .repeatable = 0, .cmd = EchoCommand },
+};
+
+/************************************************************************************
+* Loopback
+************************************************************************************/
+
+static void OnFrame(void *pParam, rpcClientStatus_t status, const rpcClientFrame_t *pFrame)
+{
+    (void)pParam;
+
+    if( status != rpcClientOk_c )
+    {
+        HOST_CHECK(pFrame == NULL);
+        maDecodeErrors[status]++;
+        return;
+    }
+
+    HOST_CHECK(mFrameCount < mMaxFrames_c);
+    if( mFrameCount < mMaxFrames_c )
+    {
+        maFrames[mFrameCount].f = *pFrame;
+        memcpy(maFrames[mFrameCount].data, pFrame->pData, pFrame->length);
+        maFrames[mFrameCount].f.pData = maFrames[mFrameCount].data;
+        mFrameCount++;
+    }
+}
+
+static void ClearFrames(void)
+{
+    mFrameCount = 0;
+    mTextLen = 0;
+    memset(maDecodeErrors, 0, sizeof(maDecodeErrors));
+}
+
+/* Bytes from the host, read by the shell in chunks of at most chunk bytes */
+static void SendChunked(const void *pData, uint32_t length, uint32_t chunk)
+{
+    const uint8_t *p = pData;
+    uint32_t n;
+
+    ClearFrames();
+
+    while( length )
+    {
+        n = (length < chunk) ? length : chunk;
+        HOST_CHECK(mRxHead + n <= sizeof(mRx));
+        memcpy(&mRx[mRxHead], p, n);
+        mRxHead += n;
+        p += n;
+        length -= n;
+
+        mpfShellRx(mpShellRxParam);
+        HOST_CHECK(mRxTail == mRxHead);
+    }
+
+    mRxHead = 0;
+    mRxTail = 0;
+}
+
+static void Send(const void *pData, uint32_t length)
+{
+    SendChunked(pData, length, length ? length : 1);
+}
+
+/* COBS encodes a raw frame, which does not need to be valid */
+static void SendRaw(const uint8_t *pFrame, uint32_t length)
+{
+    uint8_t encoded[COBS_ENCODED_MAX_SIZE(mMaxRequest_c * 2) + 1];
+    uint32_t size = cobs_encode(pFrame, length, encoded);
+
+    encoded[size++] = COBS_DELIMITER;
+    Send(encoded, size);
+}
+
+/* Builds a raw request frame, returns its size */
+static uint32_t BuildRaw(uint8_t *pFrame, uint8_t seq, uint8_t id, const void *pData, uint16_t length)
+{
+    uint16_t crc;
+
+    pFrame[0] = SHELL_RPC_REQUEST;
+    pFrame[1] = seq;
+    pFrame[2] = id;
+    pFrame[3] = (uint8_t)length;
+    pFrame[4] = (uint8_t)(length >> 8);
+    memcpy(&pFrame[SHELL_RPC_HEADER_SIZE], pData, length);
+    crc = crc16_ccitt(pFrame, SHELL_RPC_HEADER_SIZE + length);
+    pFrame[SHELL_RPC_HEADER_SIZE + length] = (uint8_t)crc;
+    pFrame[SHELL_RPC_HEADER_SIZE + length + 1] = (uint8_t)(crc >> 8);
+
+    return SHELL_RPC_HEADER_SIZE + length + SHELL_RPC_CRC_SIZE;
+}
+
+/* Recomputes the CRC of a raw frame of length bytes */
+static void UpdateCrc(uint8_t *pFrame, uint32_t length)
+{
+    uint16_t crc = crc16_ccitt(pFrame, length - SHELL_RPC_CRC_SIZE);
+
+    pFrame[length - 2] = (uint8_t)crc;
+    pFrame[length - 1] = (uint8_t)(crc >> 8);
+}
+
+static uint32_t DecodeErrors(void)
+{
+    uint32_t n = 0;
+    uint32_t i;
+
+    for( i = 0; i < NumberOfElements(maDecodeErrors); i++ )
+    {
+        n += maDecodeErrors[i];
+    }
+
+    return n;
+}
+
+/* Checks the answer to a request: OUTPUT frames holding output, then the
+   RESPONSE frame with status and responseData */
+static void CheckAnswer(uint8_t seq, uint8_t id, const char *output, int8_t status,
+                        const void *pResponseData, uint16_t responseLen)
+{
+    uint32_t outputLen = 0;
+    uint32_t i;
+
+    HOST_CHECK(DecodeErrors() == 0);
+    HOST_CHECK(mFrameCount >= 1);
+    if( mFrameCount < 1 )
+    {
+        return;
+    }
+
+    for( i = 0; i + 1 < mFrameCount; i++ )
+    {
+        HOST_CHECK(maFrames[i].f.type == RPC_CLIENT_OUTPUT);
+        HOST_CHECK(maFrames[i].f.seq == seq);
+        HOST_CHECK(maFrames[i].f.id == id);
+        HOST_CHECK(!maFrames[i].f.hasStatus);
+        HOST_CHECK(maFrames[i].f.length <= SHELL_RPC_MAX_DATA);
+        HOST_CHECK(outputLen + maFrames[i].f.length <= sizeof(mOutput));
+        if( outputLen + maFrames[i].f.length <= sizeof(mOutput) )
+        {
+            memcpy(&mOutput[outputLen], maFrames[i].data, maFrames[i].f.length);
+            outputLen += maFrames[i].f.length;
+        }
+    }
+
+    HOST_CHECK(outputLen == strlen(output));
+    HOST_CHECK_MEM(mOutput, output, outputLen);
+
+    HOST_CHECK(maFrames[i].f.type == RPC_CLIENT_RESPONSE);
+    HOST_CHECK(maFrames[i].f.seq == seq);
+    HOST_CHECK(maFrames[i].f.id == id);
+    HOST_CHECK(maFrames[i].f.hasStatus);
+    HOST_CHECK(maFrames[i].f.status == status);
+    HOST_CHECK(maFrames[i].f.length == responseLen);
+    if( responseLen )
+    {
+        HOST_CHECK_MEM(maFrames[i].data, pResponseData, responseLen);
+    }
+}
+
+/* Checks that the shell rejected a frame */
+static void CheckError(uint8_t seq, uint8_t id)
+{
+    HOST_CHECK(DecodeErrors() == 0);
+    HOST_CHECK(mFrameCount == 1);
+    HOST_CHECK(maFrames[0].f.type == RPC_CLIENT_ERROR);
+    HOST_CHECK(maFrames[0].f.seq == seq);
+    HOST_CHECK(maFrames[0].f.id == id);
+    HOST_CHECK(maFrames[0].f.hasStatus);
+    HOST_CHECK(maFrames[0].f.status == RPC_CLIENT_STATUS_BAD_FRAME);
+}
+
+static void Ping(uint8_t seq)
+{
+    static const uint8_t data[] = { 0x00, 0x01, 0x00, 0x00, 0xFF, 'p', 'i', 'n', 'g', 0x00 };
+    uint8_t encoded[RPC_CLIENT_REQUEST_MAX_SIZE(sizeof(data))];
+
+    Send(encoded, rpc_client_encode_request(seq, RPC_CLIENT_ID_PING, data, sizeof(data), encoded));
+    CheckAnswer(seq, RPC_CLIENT_ID_PING, "", CMD_RET_SUCCESS, data, sizeof(data));
+}
+
+/************************************************************************************
+* Tests
+************************************************************************************/
+
+static void TestConstants(void)
+{
+    HOST_CHECK(RPC_CLIENT_REQUEST == SHELL_RPC_REQUEST);
+    HOST_CHECK(RPC_CLIENT_RESPONSE == SHELL_RPC_RESPONSE);
+    HOST_CHECK(RPC_CLIENT_OUTPUT == SHELL_RPC_OUTPUT);
+    HOST_CHECK(RPC_CLIENT_EVENT == SHELL_RPC_EVENT);
+    HOST_CHECK(RPC_CLIENT_DONE == SHELL_RPC_DONE);
+    HOST_CHECK(RPC_CLIENT_ERROR == SHELL_RPC_ERROR);
+    HOST_CHECK(RPC_CLIENT_ID_TEXT == SHELL_RPC_ID_TEXT);
+    HOST_CHECK(RPC_CLIENT_ID_PING == SHELL_RPC_ID_PING);
+    HOST_CHECK(RPC_CLIENT_ID_COMMAND_LINE == SHELL_RPC_ID_COMMAND_LINE);
+    HOST_CHECK(RPC_CLIENT_ID_BREAK == SHELL_RPC_ID_BREAK);
+    HOST_CHECK(RPC_CLIENT_STATUS_UNKNOWN_ID == SHELL_RPC_STATUS_UNKNOWN_ID);
+    HOST_CHECK(RPC_CLIENT_STATUS_BAD_ARGS == SHELL_RPC_STATUS_BAD_ARGS);
+    HOST_CHECK(RPC_CLIENT_STATUS_BAD_FRAME == SHELL_RPC_STATUS_BAD_FRAME);
+    HOST_CHECK(RPC_CLIENT_HEADER_SIZE == SHELL_RPC_HEADER_SIZE);
+    HOST_CHECK(RPC_CLIENT_CRC_SIZE == SHELL_RPC_CRC_SIZE);
+    HOST_CHECK(RPC_CLIENT_MAX_DATA >= SHELL_RPC_MAX_DATA);
+}
+
+static void TestEnter(void)
+{
+    /* Text mode: the prompt and the output are dropped by the host decoder */
+    Send("gap address\r", 12);
+    HOST_CHECK(mTextLen > 0);
+    HOST_CHECK(mFrameCount == 0);
+    HOST_CHECK(DecodeErrors() == 0);
+    HOST_CHECK(!shell_rpc_active());
+
+    Send(RPC_CLIENT_ENTER_SEQUENCE, 2);
+    HOST_CHECK(shell_rpc_active());
+    HOST_CHECK(mFrameCount == 0);
+    HOST_CHECK(DecodeErrors() == 0);
+    HOST_CHECK(mDecoder.synced);
+}
+
+/* Every ID of the firmware table reaches its command and sub-command */
+static void TestEveryId(void)
+{
+    static const char * const args[] = { "a b", "", "c" };
+    uint8_t encoded[RPC_CLIENT_REQUEST_MAX_SIZE(SHELL_CB_SIZE)];
+    char expected[128];
+    uint32_t length;
+    uint32_t i;
+
+    for( i = 0; i < NumberOfElements(mRpcCmds); i++ )
+    {
+        /* Sorted, for the binary search, and clear of the reserved IDs */
+        HOST_CHECK(mRpcCmds[i].id > RPC_CLIENT_ID_BREAK);
+        HOST_CHECK((i == 0) || (mRpcCmds[i].id > mRpcCmds[i - 1].id));
+
+        length = rpc_client_encode_args((uint8_t)(0x80 + i), mRpcCmds[i].id, NumberOfElements(args), args,
+                                        encoded, sizeof(encoded));
+        HOST_CHECK(length > 0);
+        Send(encoded, length);
+
+        snprintf(expected, sizeof(expected), "%s|%s|a b||c|", mRpcCmds[i].name, mRpcCmds[i].subcmd);
+        if( !strcmp(mRpcCmds[i].name, "thrput") && !strcmp(mRpcCmds[i].subcmd, "start") )
+        {
+            CheckAnswer((uint8_t)(0x80 + i), mRpcCmds[i].id, expected, CMD_RET_ASYNC, NULL, 0);
+
+            /* The command finishes later */
+            ClearFrames();
+            shell_cmd_finished();
+            HOST_CHECK(mFrameCount == 1);
+            HOST_CHECK(maFrames[0].f.type == RPC_CLIENT_DONE);
+            HOST_CHECK(maFrames[0].f.seq == (uint8_t)(0x80 + i));
+            HOST_CHECK(maFrames[0].f.id == mRpcCmds[i].id);
+            HOST_CHECK(maFrames[0].f.status == CMD_RET_SUCCESS);
+        }
+        else
+        {
+            CheckAnswer((uint8_t)(0x80 + i), mRpcCmds[i].id, expected, CMD_RET_SUCCESS, NULL, 0);
+        }
+    }
+
+    /* All the optional IDs are in the table */
+    HOST_CHECK(NumberOfElements(mRpcCmds) == 36);
+
+    /* No arguments */
+    length = rpc_client_encode_args(1, mRpcCmds[0].id, 0, NULL, encoded, sizeof(encoded));
+    Send(encoded, length);
+    CheckAnswer(1, mRpcCmds[0].id, "gap|address|", CMD_RET_SUCCESS, NULL, 0);
+
+    /* A request that does not fit */
+    HOST_CHECK(rpc_client_encode_args(1, mRpcCmds[0].id, NumberOfElements(args), args, encoded, 8) == 0);
+}
+
+static void TestReserved(void)
+{
+    static const char line[] = "gatt read \"1 2\" 3";
+    static const char * const tooMany[] =
+        { "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12" };
+    uint8_t encoded[RPC_CLIENT_REQUEST_MAX_SIZE(SHELL_CB_SIZE)];
+    uint32_t length;
+
+    Ping(7);
+
+    length = rpc_client_encode_request(8, RPC_CLIENT_ID_COMMAND_LINE, (const uint8_t *)line, sizeof(line) - 1, encoded);
+    Send(encoded, length);
+    CheckAnswer(8, RPC_CLIENT_ID_COMMAND_LINE, "gatt|read|1 2|3|", CMD_RET_SUCCESS, NULL, 0);
+
+    /* Not registered */
+    length = rpc_client_encode_args(9, 0x3F, 0, NULL, encoded, sizeof(encoded));
+    Send(encoded, length);
+    CheckAnswer(9, 0x3F, "", RPC_CLIENT_STATUS_UNKNOWN_ID, NULL, 0);
+
+    length = rpc_client_encode_args(10, mRpcCmds[0].id, NumberOfElements(tooMany), tooMany, encoded, sizeof(encoded));
+    Send(encoded, length);
+    CheckAnswer(10, mRpcCmds[0].id, "", RPC_CLIENT_STATUS_BAD_ARGS, NULL, 0);
+
+    /* An ASYNC command stopped by BREAK */
+    length = rpc_client_encode_args(11, 0x60, 0, NULL, encoded, sizeof(encoded));
+    Send(encoded, length);
+    CheckAnswer(11, 0x60, "thrput|start|", CMD_RET_ASYNC, NULL, 0);
+
+    length = rpc_client_encode_request(12, RPC_CLIENT_ID_BREAK, NULL, 0, encoded);
+    Send(encoded, length);
+    CheckAnswer(12, RPC_CLIENT_ID_BREAK, "", CMD_RET_SUCCESS, NULL, 0);
+    HOST_CHECK(mBreaks == 1);
+
+    /* No DONE frame after BREAK */
+    ClearFrames();
+    shell_cmd_finished();
+    HOST_CHECK(mFrameCount == 0);
+
+    /* One byte per read, then two requests in one read */
+    length = rpc_client_encode_args(13, 0x41, 0, NULL, encoded, sizeof(encoded));
+    SendChunked(encoded, length, 1);
+    CheckAnswer(13, 0x41, "gatt|read|", CMD_RET_SUCCESS, NULL, 0);
+
+    length = rpc_client_encode_args(14, 0x41, 0, NULL, encoded, sizeof(encoded));
+    length += rpc_client_encode_args(15, 0x42, 0, NULL, &encoded[length], sizeof(encoded) - length);
+    Send(encoded, length);
+    HOST_CHECK(mFrameCount == 4);
+    HOST_CHECK((maFrames[1].f.type == RPC_CLIENT_RESPONSE) && (maFrames[1].f.seq == 14));
+    HOST_CHECK((maFrames[3].f.type == RPC_CLIENT_RESPONSE) && (maFrames[3].f.seq == 15));
+}
+
+/* Bad frames sent to the shell */
+static void TestBadRequests(void)
+{
+    static const char data[] = "a\0b";
+    uint8_t raw[mMaxRequest_c * 2];
+    uint8_t big[mMaxRequest_c + 4];
+    uint32_t length;
+
+    /* Bad CRC */
+    length = BuildRaw(raw, 20, 0x10, data, sizeof(data));
+    raw[length - 1] ^= 0x40;
+    SendRaw(raw, length);
+    CheckError(20, 0x10);
+    Ping(21);
+
+    /* Bad data */
+    length = BuildRaw(raw, 22, 0x10, data, sizeof(data));
+    raw[SHELL_RPC_HEADER_SIZE] ^= 0x01;
+    SendRaw(raw, length);
+    CheckError(22, 0x10);
+
+    /* Not a request */
+    length = BuildRaw(raw, 23, 0x10, data, sizeof(data));
+    raw[0] = SHELL_RPC_RESPONSE;
+    UpdateCrc(raw, length);
+    SendRaw(raw, length);
+    CheckError(23, 0x10);
+
+    /* Truncated: the last data byte is missing, then only a part of the header */
+    length = BuildRaw(raw, 24, 0x10, data, sizeof(data));
+    memmove(&raw[length - 3], &raw[length - 2], 2);
+    SendRaw(raw, length - 1);
+    CheckError(24, 0x10);
+
+    SendRaw(raw, SHELL_RPC_HEADER_SIZE + 1);
+    CheckError(0, 0);
+
+    /* Empty frames: consecutive delimiters are ignored, an empty COBS frame is
+       rejected */
+    Send("\0\0\0", 3);
+    HOST_CHECK(mFrameCount == 0);
+    HOST_CHECK(DecodeErrors() == 0);
+
+    Send("\x01\0", 2);
+    CheckError(0, 0);
+
+    /* Not valid COBS: the code byte runs past the end of the frame */
+    Send("\x09" "abc\0", 5);
+    CheckError(0, 0);
+
+    /* Larger than any request */
+    memset(big, 'x', sizeof(big));
+    length = BuildRaw(raw, 25, 0x10, big, sizeof(big));
+    SendRaw(raw, length);
+    CheckError(0, 0);
+
+    /* Still in sync */
+    Ping(26);
+}
+
+/* Bad frames received by the host */
+static void TestBadFrames(void)
+{
+    uint8_t raw[64];
+    uint8_t encoded[COBS_ENCODED_MAX_SIZE(64) + 2];
+    uint32_t length;
+    uint32_t size;
+
+    /* A RESPONSE frame of the board */
+    raw[0] = RPC_CLIENT_RESPONSE;
+    raw[1] = 30;
+    raw[2] = 0x10;
+    raw[3] = 3;
+    raw[4] = 0;
+    raw[5] = (uint8_t)CMD_RET_SUCCESS;
+    raw[6] = 'o';
+    raw[7] = 'k';
+    length = 10;
+    UpdateCrc(raw, length);
+
+    ClearFrames();
+    size = cobs_encode(raw, length, encoded);
+    encoded[size++] = COBS_DELIMITER;
+    rpc_client_decode(&mDecoder, encoded, size);
+    HOST_CHECK(mFrameCount == 1);
+    HOST_CHECK(DecodeErrors() == 0);
+    HOST_CHECK(maFrames[0].f.hasStatus && (maFrames[0].f.status == CMD_RET_SUCCESS));
+    HOST_CHECK((maFrames[0].f.length == 2) && !memcmp(maFrames[0].data, "ok", 2));
+
+    /* Bad CRC */
+    ClearFrames();
+    raw[6] ^= 0x20;
+    size = cobs_encode(raw, length, encoded);
+    encoded[size++] = COBS_DELIMITER;
+    rpc_client_decode(&mDecoder, encoded, size);
+    raw[6] ^= 0x20;
+    HOST_CHECK(maDecodeErrors[rpcClientBadCrc_c] == 1);
+    HOST_CHECK(mFrameCount == 0);
+
+    /* Truncated */
+    ClearFrames();
+    size = cobs_encode(raw, 4, encoded);
+    encoded[size++] = COBS_DELIMITER;
+    rpc_client_decode(&mDecoder, encoded, size);
+    HOST_CHECK(maDecodeErrors[rpcClientTruncated_c] == 1);
+
+    /* Cut after the data: the length does not match */
+    ClearFrames();
+    size = cobs_encode(raw, length - 1, encoded);
+    encoded[size++] = COBS_DELIMITER;
+    rpc_client_decode(&mDecoder, encoded, size);
+    HOST_CHECK(maDecodeErrors[rpcClientBadLength_c] == 1);
+
+    /* Empty frames */
+    ClearFrames();
+    rpc_client_decode(&mDecoder, (const uint8_t *)"\0\0\0", 3);
+    HOST_CHECK((DecodeErrors() == 0) && (mFrameCount == 0));
+    rpc_client_decode(&mDecoder, (const uint8_t *)"\x01\0", 2);
+    HOST_CHECK(maDecodeErrors[rpcClientBadEncoding_c] == 1);
+
+    /* Not valid COBS */
+    ClearFrames();
+    rpc_client_decode(&mDecoder, (const uint8_t *)"\x09" "abc\0", 5);
+    HOST_CHECK(maDecodeErrors[rpcClientBadEncoding_c] == 1);
+
+    /* Larger than any frame */
+    ClearFrames();
+    memset(mOutput, 'x', sizeof(mOutput));
+    rpc_client_decode(&mDecoder, (const uint8_t *)mOutput, sizeof(mOutput));
+    rpc_client_decode(&mDecoder, (const uint8_t *)"\0", 1);
+    HOST_CHECK(maDecodeErrors[rpcClientBadEncoding_c] == 1);
+
+    /* Unknown type, and a RESPONSE without status */
+    ClearFrames();
+    raw[0] = 0x7F;
+    UpdateCrc(raw, length);
+    size = cobs_encode(raw, length, encoded);
+    encoded[size++] = COBS_DELIMITER;
+    rpc_client_decode(&mDecoder, encoded, size);
+
+    raw[0] = RPC_CLIENT_RESPONSE;
+    raw[3] = 0;
+    length = SHELL_RPC_HEADER_SIZE + SHELL_RPC_CRC_SIZE;
+    UpdateCrc(raw, length);
+    size = cobs_encode(raw, length, encoded);
+    encoded[size++] = COBS_DELIMITER;
+    rpc_client_decode(&mDecoder, encoded, size);
+    HOST_CHECK(maDecodeErrors[rpcClientBadType_c] == 2);
+    HOST_CHECK(mFrameCount == 0);
+}
+
+/* Output outside of a request, then back to text mode */
+static void TestEventsAndText(void)
+{
+    uint8_t encoded[RPC_CLIENT_REQUEST_MAX_SIZE(0)];
+    char event[3 * SHELL_RPC_MAX_DATA];
+    uint32_t i;
+
+    ClearFrames();
+    memset(event, 'e', sizeof(event) - 1);
+    event[sizeof(event) - 1] = '\0';
+    shell_write(event);
+    shell_flush();
+    HOST_CHECK(DecodeErrors() == 0);
+    HOST_CHECK(mFrameCount == 3);
+    for( i = 0; i < mFrameCount; i++ )
+    {
+        HOST_CHECK(maFrames[i].f.type == RPC_CLIENT_EVENT);
+    }
+
+    Send(encoded, rpc_client_encode_request(40, RPC_CLIENT_ID_TEXT, NULL, 0, encoded));
+    CheckAnswer(40, RPC_CLIENT_ID_TEXT, "", CMD_RET_SUCCESS, NULL, 0);
+    HOST_CHECK(!shell_rpc_active());
+
+    Send("gap address\r", 12);
+    HOST_CHECK(mFrameCount == 0);
+    HOST_CHECK((mTextLen >= 12) && !memcmp(mText, "gap address", 11));
+}
+
+int main(void)
+{
+    rpc_client_decoder_init(&mDecoder, OnFrame, NULL);
+    shell_init("> ");
+    shell_register_function_array(maCmds, NumberOfElements(maCmds));
+    shell_rpc_register(mRpcCmds, NumberOfElements(mRpcCmds));
+
+    TestConstants();
+    TestEnter();
+    TestEveryId();
+    TestReserved();
+    TestBadRequests();
+    TestBadFrames();
+    TestEventsAndText();
+
+    return HostTest_Report("shell rpc");
+}
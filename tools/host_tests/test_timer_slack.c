@@ -0,0 +1,259 @@
+/*! *********************************************************************************
+* \file
+*
+* Host tests of the timer slack (gTMR_EnableTimerSlack_d), built with the table
+* scan and with the heap scheduler.
+*   - Directed cases: a slack timer alone wakes up at the end of its slack; one
+*     that expires before a timer without slack fires with it; an interval
+*     timer with slack follows an interval timer without slack and never
+*     causes a wakeup of its own. The compare interrupts and
+*     TMR_GetSavedWakeups() are counted exactly.
+*   - A random mix of interval and single shot timers, half of them with a
+*     slack, run twice on the same operations: with the slack ignored and
+*     with it. Every callback runs no earlier than its expiry and no later
+*     than the end of its slack plus the 4 ms minimum reload of the compare;
+*     timers without slack keep the bound of the run without slack. Every
+*     callback that runs before the end of its slack is a merged expiry, and
+*     their number matches TMR_GetSavedWakeups(). The run with slack takes
+*     fewer compare interrupts than the run without.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include "host_test.h"
+#include "timer_sim.h"
+
+#define STR_(x)             #x
+#define STR(x)              STR_(x)
+
+#define mTimers_c           gTmrTotalTimers_c
+#define mStartTime_c        ((mTimerSimCounterMask_c + 1) - 20ull * mTimerSimFreqHz_c)
+
+#define mMixOps_c           20000
+#define mMixOpSpacing_c     (mTimerSimFreqHz_c / 10)     /* ticks */
+#define mMixMaxSlackMs_c    200
+
+typedef struct modelTimer_tag
+{
+    bool_t      active;
+    uint8_t     type;
+    uint64_t    expireTicks;    /* Absolute, on the time of the simulation */
+    uint64_t    intervalTicks;
+    uint64_t    slackTicks;
+    uint64_t    lastFireTicks;
+    uint32_t    expirations;
+} modelTimer_t;
+
+static tmrTimerID_t maIds[mTimers_c];
+static modelTimer_t maModel[mTimers_c];
+static uint64_t mTicksFor4ms;
+static uint64_t mMerged;
+
+static void Callback(void *param);
+
+/************************************************************************************
+* Model
+************************************************************************************/
+
+static void Start(uint32_t i, uint8_t type, uint32_t ms, uint32_t slackMs)
+{
+    HOST_CHECK(TMR_StartTimerWithSlack(maIds[i], type, ms, slackMs, Callback, (void *)(uintptr_t)i) == gTmrSuccess_c);
+    TimerSim_RunTask();
+
+    maModel[i].active = TRUE;
+    maModel[i].type = type;
+    maModel[i].intervalTicks = TmrTicksFromMilliseconds(ms);
+    maModel[i].slackTicks = TmrTicksFromMilliseconds(slackMs);
+    maModel[i].expireTicks = mTimerSimNow + maModel[i].intervalTicks;
+}
+
+static void Stop(uint32_t i)
+{
+    (void)TMR_StopTimer(maIds[i]);
+    TimerSim_RunTask();
+    maModel[i].active = FALSE;
+}
+
+static void StopAll(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < mTimers_c; i++)
+    {
+        Stop(i);
+        maModel[i].expirations = 0;
+    }
+    mMerged = 0;
+}
+
+static void Callback(void *param)
+{
+    uint32_t i = (uint32_t)(uintptr_t)param;
+    uint64_t deadline = maModel[i].expireTicks + maModel[i].slackTicks;
+
+    HOST_CHECK(maModel[i].active);
+    HOST_CHECK(mTimerSimNow >= maModel[i].expireTicks);
+    HOST_CHECK(mTimerSimNow <= deadline + mTicksFor4ms + 1);
+
+    if (mTimerSimNow < deadline)
+    {
+        mMerged++;
+    }
+
+    maModel[i].lastFireTicks = mTimerSimNow;
+    maModel[i].expirations++;
+
+    if (maModel[i].type & gTmrIntervalTimer_c)
+    {
+        maModel[i].expireTicks = mTimerSimNow + maModel[i].intervalTicks;
+    }
+    else
+    {
+        maModel[i].active = FALSE;
+    }
+}
+
+/************************************************************************************
+* Directed cases
+************************************************************************************/
+
+static void TestSlackAlone(void)
+{
+    uint64_t wakeups = mTimerSimWakeups;
+    uint32_t saved = TMR_GetSavedWakeups();
+    uint64_t deadline;
+
+    Start(0, gTmrSingleShotTimer_c, 90, 20);
+    deadline = maModel[0].expireTicks + maModel[0].slackTicks;
+
+    TimerSim_AdvanceTo(mTimerSimNow + TmrTicksFromMilliseconds(200));
+
+    /* Woken up once, at the end of the slack */
+    HOST_CHECK(maModel[0].expirations == 1);
+    HOST_CHECK(maModel[0].lastFireTicks == deadline);
+    HOST_CHECK(mTimerSimWakeups - wakeups == 1);
+    HOST_CHECK(TMR_GetSavedWakeups() == saved);
+    StopAll();
+}
+
+static void TestSlackMerged(void)
+{
+    uint64_t wakeups = mTimerSimWakeups;
+    uint32_t saved = TMR_GetSavedWakeups();
+
+    Start(0, gTmrSingleShotTimer_c, 90, 20);
+    Start(1, gTmrSingleShotTimer_c, 100, 0);
+
+    TimerSim_AdvanceTo(mTimerSimNow + TmrTicksFromMilliseconds(200));
+
+    /* The slack timer is served by the wakeup of the other one */
+    HOST_CHECK(maModel[0].expirations == 1);
+    HOST_CHECK(maModel[1].expirations == 1);
+    HOST_CHECK(maModel[0].lastFireTicks == maModel[1].lastFireTicks);
+    HOST_CHECK(mTimerSimWakeups - wakeups == 1);
+    HOST_CHECK(TMR_GetSavedWakeups() - saved == 1);
+    HOST_CHECK(mMerged == 1);
+    StopAll();
+}
+
+static void TestSlackInterval(void)
+{
+    uint64_t wakeups = mTimerSimWakeups;
+    uint32_t saved = TMR_GetSavedWakeups();
+
+    /* Each period of the slack timer ends within the slack before the next
+       expiry of the other timer */
+    Start(0, gTmrIntervalTimer_c, 95, 10);
+    Start(1, gTmrIntervalTimer_c, 100, 0);
+
+    TimerSim_AdvanceTo(mTimerSimNow + 10 * mTimerSimFreqHz_c);
+
+    HOST_CHECK(maModel[1].expirations == 100);
+    HOST_CHECK(maModel[0].expirations == maModel[1].expirations);
+    HOST_CHECK(maModel[0].lastFireTicks == maModel[1].lastFireTicks);
+    HOST_CHECK(mTimerSimWakeups - wakeups == maModel[1].expirations);
+    HOST_CHECK(TMR_GetSavedWakeups() - saved == maModel[0].expirations);
+    HOST_CHECK(mMerged == maModel[0].expirations);
+    StopAll();
+}
+
+/************************************************************************************
+* Random mix
+************************************************************************************/
+
+/* Runs the same operations for any useSlack; returns the compare interrupts */
+static uint64_t RunMix(bool_t useSlack)
+{
+    uint64_t wakeups = mTimerSimWakeups;
+    uint32_t saved = TMR_GetSavedWakeups();
+    uint32_t seed = 0x5EED51AC;
+    uint32_t slackMs;
+    uint32_t ms;
+    uint32_t i;
+    uint32_t n;
+
+    for (i = 0; i < mTimers_c; i++)
+    {
+        ms = 20 + HostTest_Rand(&seed) % 1000;
+        slackMs = (i & 1) ? (1 + HostTest_Rand(&seed) % mMixMaxSlackMs_c) : 0;
+        Start(i, (i & 2) ? gTmrLowPowerIntervalMillisTimer_c : gTmrIntervalTimer_c, ms, useSlack ? slackMs : 0);
+    }
+
+    for (n = 0; n < mMixOps_c; n++)
+    {
+        TimerSim_AdvanceTo(mTimerSimNow + HostTest_Rand(&seed) % (2 * mMixOpSpacing_c));
+
+        i = HostTest_Rand(&seed) % mTimers_c;
+        ms = 1 + HostTest_Rand(&seed) % 2000;
+        slackMs = (i & 1) ? (HostTest_Rand(&seed) % mMixMaxSlackMs_c) : 0;
+
+        if ((HostTest_Rand(&seed) % 4) == 0)
+        {
+            Start(i, gTmrIntervalTimer_c, ms, useSlack ? slackMs : 0);
+        }
+        else
+        {
+            Start(i, gTmrSingleShotTimer_c, ms, useSlack ? slackMs : 0);
+        }
+    }
+
+    HOST_CHECK(TMR_GetSavedWakeups() - saved == mMerged);
+    if (!useSlack)
+    {
+        HOST_CHECK(mMerged == 0);
+    }
+
+    printf("timer slack %u: %llu wakeups, %llu merged expirations\n", useSlack,
+           (unsigned long long)(mTimerSimWakeups - wakeups), (unsigned long long)mMerged);
+
+    StopAll();
+
+    return mTimerSimWakeups - wakeups;
+}
+
+int main(void)
+{
+    uint64_t wakeupsNoSlack;
+    uint64_t wakeupsSlack;
+    uint32_t i;
+
+    mTimerSimNow = mStartTime_c;
+    TMR_Init();
+    mTicksFor4ms = TmrTicksFromMilliseconds(4);
+
+    for (i = 0; i < mTimers_c; i++)
+    {
+        maIds[i] = TMR_AllocateTimer();
+        HOST_CHECK(maIds[i] != gTmrInvalidTimerID_c);
+    }
+
+    TestSlackAlone();
+    TestSlackMerged();
+    TestSlackInterval();
+
+    wakeupsNoSlack = RunMix(FALSE);
+    wakeupsSlack = RunMix(TRUE);
+    HOST_CHECK(wakeupsSlack < wakeupsNoSlack);
+
+    return HostTest_Report("timer slack heap=" STR(gTMR_EnableHeapScheduler_d));
+}
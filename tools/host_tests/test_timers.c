@@ -0,0 +1,344 @@
+/*! *********************************************************************************
+* \file
+*
+* Host tests of the TimersManager schedulers. The Makefile builds this file with
+* the table scan (gTMR_EnableHeapScheduler_d 0) and with the heap
+* (gTMR_EnableHeapScheduler_d 1), both with 255 timers, the most the heap
+* supports, and checks that the two give the same schedule.
+*
+* The stack timer counter is 32 bits wide and starts 20 s before it wraps.
+*   - Random starts, stops and restarts from the callbacks, of single shot,
+*     interval, second and low power timers, for about 40 minutes of
+*     simulated time, then again with callbacks that stop other timers. Every
+*     callback runs no earlier than its expiry and no later than the 4 ms
+*     minimum reload of the compare after it; TMR_GetRemainingTime() and
+*     TMR_GetFirstExpireTime() agree with the expiries to 1 ms.
+*   - Timers of 1 to 50 hours, over about 80 turns of the counter, with the
+*     same checks.
+*   - The expiries (tick and timer) of the first and last phases are folded
+*     into a digest, written to <test binary>.trace; the Makefile compares the
+*     digests of both builds.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#include "host_test.h"
+#include "timer_sim.h"
+
+#define STR_(x)             #x
+#define STR(x)              STR_(x)
+
+#define mTimers_c           gTmrTotalTimers_c
+#define mStartTime_c        ((mTimerSimCounterMask_c + 1) - 20ull * mTimerSimFreqHz_c)
+
+/* Random phase */
+#define mShortOps_c         100000
+#define mShortOpSpacing_c   800         /* ticks */
+
+/* Long timers phase */
+#define mLongOps_c          600
+#define mLongOpSpacingMs_c  (10u * 3600u * 1000u)
+#define mLongMaxMs_c        (50u * 3600u * 1000u)
+#define mMinCounterWraps_c  50
+
+typedef struct modelTimer_tag
+{
+    bool_t      active;
+    uint8_t     type;
+    uint64_t    expireTicks;    /* Absolute, on the time of the simulation */
+    uint64_t    intervalTicks;
+    uint64_t    firedTicks;     /* Time of the last expiry */
+} modelTimer_t;
+
+static tmrTimerID_t maIds[mTimers_c];
+static modelTimer_t maModel[mTimers_c];
+static uint32_t mSeed = 0x1F123BB5;
+static uint64_t mTicksFor4ms;
+
+/* Digest of every expiry, independent of the order inside one tick */
+static uint64_t mDigestSum;
+static uint64_t mDigestXor;
+static uint64_t mDigestCount;
+static uint64_t mExpirations;
+static uint64_t mMaxLateTicks;
+
+/* The table scan computes the next compare before the callbacks run, so a timer
+   stopped by a callback of the same pass can still wake it once, and the 4 ms
+   minimum reload then shifts the later expiries by a few ticks. The digest
+   only covers the phases without such stops. */
+static bool_t mStopFromCallbacks;
+static bool_t mDigestEnabled;
+
+static void Callback(void *param);
+
+/************************************************************************************
+* Model
+************************************************************************************/
+
+static uint64_t Mix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+
+    return x;
+}
+
+static void Start(uint32_t i, uint8_t type, uint32_t ms)
+{
+    HOST_CHECK(TMR_StartTimer(maIds[i], type, ms, Callback, (void *)(uintptr_t)i) == gTmrSuccess_c);
+
+    maModel[i].active = TRUE;
+    maModel[i].type = type;
+    maModel[i].intervalTicks = TmrTicksFromMilliseconds(ms);
+    maModel[i].expireTicks = mTimerSimNow + maModel[i].intervalTicks;
+}
+
+static void Stop(uint32_t i)
+{
+    (void)TMR_StopTimer(maIds[i]);
+    maModel[i].active = FALSE;
+}
+
+/* Remaining time in milliseconds, as TMR_GetRemainingTime() rounds it */
+static uint32_t ModelRemainingMs(uint32_t i)
+{
+    if (maModel[i].expireTicks < mTimerSimNow)
+    {
+        return 1;
+    }
+
+    return (uint32_t)(((maModel[i].expireTicks - mTimerSimNow) * 1000 + mTimerSimFreqHz_c - 1) / mTimerSimFreqHz_c);
+}
+
+static bool_t CloseMs(uint32_t a, uint32_t b)
+{
+    return (a <= b + 1) && (b <= a + 1);
+}
+
+static void CheckQueries(void)
+{
+    uint32_t firstAll = 0xFFFFFFFF;
+    uint32_t firstLowPower = 0xFFFFFFFF;
+    uint32_t remaining;
+    uint32_t i;
+
+    for (i = 0; i < mTimers_c; i++)
+    {
+        HOST_CHECK(TMR_IsTimerActive(maIds[i]) == maModel[i].active);
+
+        if (maModel[i].active)
+        {
+            remaining = ModelRemainingMs(i);
+            HOST_CHECK(CloseMs(TMR_GetRemainingTime(maIds[i]), remaining));
+
+            if (remaining < firstAll)
+            {
+                firstAll = remaining;
+            }
+            if ((maModel[i].type & gTmrLowPowerTimer_c) && (remaining < firstLowPower))
+            {
+                firstLowPower = remaining;
+            }
+        }
+    }
+
+    remaining = TMR_GetFirstExpireTime(gTmrAllTypes_c);
+    HOST_CHECK((firstAll == 0xFFFFFFFF) ? (remaining == 0xFFFFFFFF) : CloseMs(remaining, firstAll));
+
+    remaining = TMR_GetFirstExpireTime(gTmrLowPowerTimer_c);
+    HOST_CHECK((firstLowPower == 0xFFFFFFFF) ? (remaining == 0xFFFFFFFF) : CloseMs(remaining, firstLowPower));
+}
+
+/* The callbacks of one tick run in a different order in the two builds, so
+   their random choices come from the tick and the timer, not from mSeed */
+static void Callback(void *param)
+{
+    uint32_t i = (uint32_t)(uintptr_t)param;
+    uint64_t choice = Mix64(((mTimerSimNow << 8) | i) ^ 0x5A5A5A5A5A5A5A5Aull);
+    uint32_t other;
+
+    HOST_CHECK(maModel[i].active);
+    HOST_CHECK(mTimerSimNow >= maModel[i].expireTicks);
+    HOST_CHECK(mTimerSimNow <= maModel[i].expireTicks + mTicksFor4ms + 1);
+
+    if (mTimerSimNow - maModel[i].expireTicks > mMaxLateTicks)
+    {
+        mMaxLateTicks = mTimerSimNow - maModel[i].expireTicks;
+    }
+
+    if (mDigestEnabled)
+    {
+        mDigestSum += Mix64((mTimerSimNow << 8) | i);
+        mDigestXor ^= Mix64((mTimerSimNow << 8) | i) * 3;
+        mDigestCount++;
+    }
+    mExpirations++;
+    maModel[i].firedTicks = mTimerSimNow;
+
+    if (maModel[i].type & gTmrIntervalTimer_c)
+    {
+        maModel[i].expireTicks = mTimerSimNow + maModel[i].intervalTicks;
+    }
+    else
+    {
+        maModel[i].active = FALSE;
+
+        /* Restart from the callback */
+        if ((choice % 6) == 0)
+        {
+            Start(i, gTmrSingleShotTimer_c, 1 + (choice >> 8) % 300);
+        }
+    }
+
+    /* Stop another timer from the callback, one that neither expired nor is due
+       in this tick */
+    if (mStopFromCallbacks && (((choice >> 20) % 16) == 0))
+    {
+        other = (choice >> 24) % mTimers_c;
+        if ((maModel[other].expireTicks > mTimerSimNow) && (maModel[other].firedTicks != mTimerSimNow))
+        {
+            Stop(other);
+        }
+    }
+}
+
+/************************************************************************************
+* Phases
+************************************************************************************/
+
+static void TestShortTimers(bool_t stopFromCallbacks)
+{
+    const uint8_t types[] = { gTmrSingleShotTimer_c, gTmrIntervalTimer_c,
+                              gTmrLowPowerSingleShotMillisTimer_c, gTmrLowPowerIntervalMillisTimer_c };
+    uint32_t op;
+    uint32_t i;
+    uint32_t n;
+
+    mStopFromCallbacks = stopFromCallbacks;
+    mDigestEnabled = !stopFromCallbacks;
+
+    for (n = 0; n < mShortOps_c; n++)
+    {
+        TimerSim_AdvanceTo(mTimerSimNow + HostTest_Rand(&mSeed) % (2 * mShortOpSpacing_c));
+
+        i = HostTest_Rand(&mSeed) % mTimers_c;
+        op = HostTest_Rand(&mSeed) % 16;
+
+        if (op < 4)
+        {
+            Start(i, types[op], 1 + HostTest_Rand(&mSeed) % ((op & 1) ? 1000 : 3000));
+        }
+        else if (op == 4)
+        {
+            Start(i, gTmrSecondTimer_c, 1000 * (1 + HostTest_Rand(&mSeed) % 5));
+        }
+        else if (op == 5)
+        {
+            /* Shorter than the 4 ms minimum reload */
+            Start(i, gTmrSingleShotTimer_c, 1 + HostTest_Rand(&mSeed) % 4);
+        }
+        else if (op < 10)
+        {
+            Stop(i);
+        }
+        else if (op == 10)
+        {
+            CheckQueries();
+        }
+
+        TimerSim_RunTask();
+    }
+}
+
+static void TestLongTimers(void)
+{
+    uint64_t startTicks = mTimerSimNow;
+    uint32_t i;
+    uint32_t n;
+
+    for (i = 0; i < mTimers_c; i++)
+    {
+        Stop(i);
+    }
+
+    mStopFromCallbacks = FALSE;
+    mDigestEnabled = TRUE;
+
+    for (n = 0; n < mLongOps_c; n++)
+    {
+        TimerSim_AdvanceTo(mTimerSimNow + TmrTicksFromMilliseconds(HostTest_Rand(&mSeed) % mLongOpSpacingMs_c));
+
+        i = HostTest_Rand(&mSeed) % 24;
+
+        switch (HostTest_Rand(&mSeed) % 4)
+        {
+        case 0:
+            Start(i, gTmrSingleShotTimer_c, 3600000 + HostTest_Rand(&mSeed) % mLongMaxMs_c);
+            break;
+        case 1:
+            Start(i, gTmrLowPowerIntervalMillisTimer_c, 3600000 + HostTest_Rand(&mSeed) % mLongMaxMs_c);
+            break;
+        case 2:
+            Stop(i);
+            break;
+        default:
+            CheckQueries();
+            break;
+        }
+
+        TimerSim_RunTask();
+    }
+
+    HOST_CHECK(((mTimerSimNow - startTicks) >> 32) >= mMinCounterWraps_c);
+}
+
+static void WriteDigest(const char *pPath)
+{
+    char name[256];
+    FILE *pFile;
+
+    snprintf(name, sizeof(name), "%s.trace", pPath);
+    pFile = fopen(name, "w");
+    HOST_CHECK(pFile != NULL);
+
+    if (pFile)
+    {
+        fprintf(pFile, "%llu %016llx %016llx\n", (unsigned long long)mDigestCount,
+                (unsigned long long)mDigestSum, (unsigned long long)mDigestXor);
+        fclose(pFile);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t i;
+
+    (void)argc;
+
+    mTimerSimNow = mStartTime_c;
+    TMR_Init();
+    mTicksFor4ms = TmrTicksFromMilliseconds(4);
+
+    for (i = 0; i < mTimers_c; i++)
+    {
+        maIds[i] = TMR_AllocateTimer();
+        HOST_CHECK(maIds[i] == i);
+    }
+    HOST_CHECK(TMR_AllocateTimer() == gTmrInvalidTimerID_c);
+
+    TestShortTimers(FALSE);
+    TestShortTimers(TRUE);
+    TestLongTimers();
+
+    WriteDigest(argv[0]);
+
+    printf("timers: %llu expirations, %llu wakeups, %.1f h simulated, %llu counter wraps, "
+           "latest %llu ticks late\n", (unsigned long long)mExpirations,
+           (unsigned long long)mTimerSimWakeups, (double)(mTimerSimNow - mStartTime_c) / mTimerSimFreqHz_c / 3600,
+           (unsigned long long)(mTimerSimNow >> 32), (unsigned long long)mMaxLateTicks);
+
+    return HostTest_Report("timers heap=" STR(gTMR_EnableHeapScheduler_d));
+}
@@ -0,0 +1,176 @@
+/*! *********************************************************************************
+* \file
+*
+* Host model of the stack timer hardware and of the timer thread, for the tests
+* that link framework/TimersManager. Included by exactly one file of a test.
+*
+* The stack timer is a free running 32-bit counter at 32768 Hz (the RTC free
+* running counter) with one compare interrupt. Time only moves forward through
+* TimerSim_AdvanceTo(), which raises the compare interrupt every time the
+* counter reaches the compare value on the way, and runs TMR_Task() after the
+* interrupt and after every call that sets the timer event, as the scheduler
+* would.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _TIMER_SIM_H_
+#define _TIMER_SIM_H_
+
+#include <stdlib.h>
+
+#include "EmbeddedTypes.h"
+#include "fsl_device_registers.h"
+#include "fsl_os_abstraction.h"
+#include "Panic.h"
+#include "TimersManager.h"
+#include "TMR_Adapter.h"
+
+#define mTimerSimFreqHz_c       32768
+#define mTimerSimCounterMask_c  0xFFFFFFFFull
+
+void TMR_Task(osaTaskParam_t param);
+
+/* Time in ticks since an origin chosen by the test. The counter reads its lower
+   32 bits. */
+static uint64_t mTimerSimNow;
+static uint32_t mTimerSimCompare;
+static bool_t mTimerSimEnabled;
+static void (*mpfTimerSimIsr)(void);
+static bool_t mTimerSimTaskPending;
+static uint32_t mTimerSimIntNesting;
+
+/* Compare interrupts raised so far */
+static uint64_t mTimerSimWakeups;
+
+/************************************************************************************
+* Target stand-ins
+************************************************************************************/
+
+SYSCON_Type gHostSyscon;
+osaEventId_t gFwkCommonEventId;
+const uint8_t gUseRtos_c = 0;
+
+void FwkInit(void)
+{
+}
+
+void StackTimer_Init(void (*cb)(void))
+{
+    mpfTimerSimIsr = cb;
+}
+
+void StackTimer_Enable(void)
+{
+    mTimerSimEnabled = TRUE;
+}
+
+void StackTimer_Disable(void)
+{
+    mTimerSimEnabled = FALSE;
+}
+
+void StackTimer_ClearIntFlag(void)
+{
+}
+
+uint32_t StackTimer_GetInputFrequency(void)
+{
+    return mTimerSimFreqHz_c;
+}
+
+uint32_t StackTimer_GetCounterValue(void)
+{
+    return (uint32_t)(mTimerSimNow & mTimerSimCounterMask_c);
+}
+
+void StackTimer_SetOffsetTicks(uint32_t offset)
+{
+    mTimerSimCompare = offset;
+}
+
+void OSA_InterruptDisable(void)
+{
+    mTimerSimIntNesting++;
+}
+
+void OSA_InterruptEnable(void)
+{
+    if (mTimerSimIntNesting == 0)
+    {
+        printf("OSA_InterruptEnable() without OSA_InterruptDisable()\n");
+        abort();
+    }
+    mTimerSimIntNesting--;
+}
+
+osaStatus_t OSA_EventSet(osaEventId_t eventId, osaEventFlags_t flagsToSet)
+{
+    (void)eventId;
+    (void)flagsToSet;
+    mTimerSimTaskPending = TRUE;
+
+    return osaStatus_Success;
+}
+
+void panic(panicId_t id, uint32_t location, uint32_t extra1, uint32_t extra2)
+{
+    printf("panic(0x%x, 0x%x, 0x%x, 0x%x)\n", id, location, extra1, extra2);
+    abort();
+}
+
+/************************************************************************************
+* Simulation
+************************************************************************************/
+
+/* Runs the timer thread while its event is set */
+static void TimerSim_RunTask(void)
+{
+    while (mTimerSimTaskPending)
+    {
+        mTimerSimTaskPending = FALSE;
+        TMR_Task(NULL);
+
+        if (mTimerSimIntNesting != 0)
+        {
+            printf("TMR_Task() returned with the interrupts disabled\n");
+            abort();
+        }
+    }
+}
+
+/* Ticks from now to the next compare interrupt, 0 if none is armed */
+static uint64_t TimerSim_TicksToMatch(void)
+{
+    uint64_t ticks;
+
+    if (!mTimerSimEnabled)
+    {
+        return 0;
+    }
+
+    ticks = ((uint64_t)mTimerSimCompare - mTimerSimNow) & mTimerSimCounterMask_c;
+
+    /* A match at the current count happens after a full turn of the counter */
+    return ticks ? ticks : (mTimerSimCounterMask_c + 1);
+}
+
+/* Moves the time forward, through every compare interrupt on the way */
+static void TimerSim_AdvanceTo(uint64_t time)
+{
+    uint64_t ticks;
+
+    TimerSim_RunTask();
+
+    while (((ticks = TimerSim_TicksToMatch()) != 0) && ((mTimerSimNow + ticks) <= time))
+    {
+        mTimerSimNow += ticks;
+        mTimerSimWakeups++;
+        mpfTimerSimIsr();
+        TimerSim_RunTask();
+    }
+
+    mTimerSimNow = time;
+}
+
+#endif /* _TIMER_SIM_H_ */
@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+Replays a Memory Manager allocation trace and proposes a pool layout.
+
+The trace is the output of the "mem trace" shell command (MEM_TRACE), saved
+from the serial terminal. One or more exports may be concatenated; lines that
+are not part of the trace (prompt, echo) are ignored:
+
+    M,<listHeader_t size>,<lost events>
+    P,<pool index>,<pool ID>,<block size>,<number of blocks>,<allocated blocks>
+    T,<ms>,<A|F|X>,<requested size>,<pool index>,<block ID>,<caller>
+
+Every allocation is replayed against a candidate layout the way MEM_BufferAlloc
+serves it: the first pool with the same ID and a large enough block, then the
+following pools when it is empty. The RAM of a layout is the heap it needs,
+(block size + listHeader_t) * number of blocks, as in heapSize_c.
+
+Fragment waste is reported as in the MEM_STATISTICS / MEM_TRACKING pool
+statistics: each allocated block wastes block size - requested size, and
+poolFragmentWaste is the waste of the blocks currently allocated from a pool,
+with its peak, minimum and maximum over the replay.
+
+Blocks allocated before the trace started have no requested size. They are
+replayed as requests of the full block size of their pool. Allocations that
+failed on the device have no lifetime; they are replayed as requests held for
+the median lifetime of the traced allocations of the same pool ID, and are
+attributed to pool ID 0 (see --fail-pool-id).
+
+Usage:
+    mem_pool_optimizer.py trace.txt [--target 0.01] [--pools 5]
+"""
+
+import argparse
+import bisect
+import sys
+
+
+class Trace(object):
+    def __init__(self):
+        self.header_size = 16
+        self.lost = 0
+        self.pools = {}      # pool index -> (pool ID, block size, blocks, allocated)
+        self.events = []     # (op, size, pool index, block ID, caller)
+
+    def parse(self, lines):
+        for line in lines:
+            fields = line.strip().split(',')
+            try:
+                if fields[0] == 'M' and len(fields) == 3:
+                    self.header_size = int(fields[1])
+                    self.lost += int(fields[2])
+                elif fields[0] == 'P' and len(fields) == 6:
+                    idx, pool_id, block_size, blocks, allocated = [int(f) for f in fields[1:]]
+                    self.pools[idx] = (pool_id, block_size, blocks, allocated)
+                elif fields[0] == 'T' and len(fields) == 7 and fields[2] in ('A', 'F', 'X'):
+                    self.events.append((fields[2], int(fields[3]), int(fields[4]),
+                                        int(fields[5]), int(fields[6], 16)))
+            except ValueError:
+                continue
+
+
+class Request(object):
+    """One block request, alive from event index start to end (exclusive)."""
+
+    def __init__(self, pool_id, size, start, end, failed=False, caller=0):
+        self.pool_id = pool_id
+        self.size = size
+        self.start = start
+        self.end = end
+        self.failed = failed
+        self.caller = caller
+
+
+def build_requests(trace, fail_pool_id):
+    """Pairs the allocations and frees of the trace into requests."""
+    n = len(trace.events)
+    open_allocs = {}
+    requests = []
+    failed = []
+    traced = {}
+    unmatched_frees = {}
+
+    for i, (op, size, pool, block, caller) in enumerate(trace.events):
+        if op == 'A':
+            pool_id = trace.pools[pool][0] if pool in trace.pools else 0
+            req = Request(pool_id, size, i, n, caller=caller)
+            open_allocs[(pool, block)] = req
+            requests.append(req)
+            traced[pool] = traced.get(pool, 0) + 1
+        elif op == 'F':
+            req = open_allocs.pop((pool, block), None)
+            traced[pool] = traced.get(pool, 0) - 1
+            if req is not None:
+                req.end = i
+            elif pool in trace.pools:
+                # Allocated before the trace: full block size, held since the start
+                pool_id, block_size = trace.pools[pool][0:2]
+                requests.append(Request(pool_id, block_size, 0, i))
+                unmatched_frees[pool] = unmatched_frees.get(pool, 0) + 1
+        else:
+            failed.append(Request(fail_pool_id, size, i, n, failed=True, caller=caller))
+
+    # Blocks held during the whole trace (e.g. MEM_BufferAllocForever at boot)
+    for pool, (pool_id, block_size, blocks, allocated) in trace.pools.items():
+        resident = allocated - traced.get(pool, 0) - unmatched_frees.get(pool, 0)
+        for _ in range(max(resident, 0)):
+            requests.append(Request(pool_id, block_size, 0, n))
+
+    # Failed allocations hold a block for the median lifetime of their pool ID
+    for req in failed:
+        lifetimes = sorted(r.end - r.start for r in requests
+                           if r.pool_id == req.pool_id and r.end < n)
+        if lifetimes:
+            req.end = min(req.start + max(lifetimes[len(lifetimes) // 2], 1), n)
+        requests.append(req)
+
+    return requests
+
+
+class Replay(object):
+    """Replays requests against a layout [(block size, blocks)] of one pool ID."""
+
+    def __init__(self, layout, requests):
+        self.layout = sorted(layout)
+        self.allocs = 0
+        self.failures = 0
+        self.peak = [0] * len(self.layout)
+        self.waste = [0] * len(self.layout)
+        self.waste_peak = [0] * len(self.layout)
+        self.waste_min = [None] * len(self.layout)
+        self.waste_max = [0] * len(self.layout)
+        self.run(requests)
+
+    def run(self, requests):
+        sizes = [s for s, _ in self.layout]
+        free = [b for _, b in self.layout]
+        timeline = []
+        for req in requests:
+            timeline.append((req.start, 1, req))
+            timeline.append((req.end, 0, req))
+        # Frees before allocations at the same event index
+        timeline.sort(key=lambda e: (e[0], e[1]))
+        served = {}
+
+        for _, is_alloc, req in timeline:
+            if not is_alloc:
+                served_pool = served.pop(id(req), None)
+                if served_pool is not None:
+                    free[served_pool] += 1
+                    self.waste[served_pool] -= sizes[served_pool] - req.size
+                continue
+
+            self.allocs += 1
+            idx = bisect.bisect_left(sizes, req.size)
+            while idx < len(sizes) and free[idx] == 0:
+                idx += 1
+            if idx == len(sizes):
+                self.failures += 1
+                continue
+
+            free[idx] -= 1
+            served[id(req)] = idx
+            in_use = self.layout[idx][1] - free[idx]
+            self.peak[idx] = max(self.peak[idx], in_use)
+            waste = sizes[idx] - req.size
+            self.waste[idx] += waste
+            self.waste_peak[idx] = max(self.waste_peak[idx], self.waste[idx])
+            if self.waste_min[idx] is None or waste < self.waste_min[idx]:
+                self.waste_min[idx] = waste
+            self.waste_max[idx] = max(self.waste_max[idx], waste)
+
+    def failure_rate(self):
+        return float(self.failures) / self.allocs if self.allocs else 0.0
+
+
+def layout_ram(layout, header_size):
+    return sum((size + header_size) * blocks for size, blocks in layout)
+
+
+def peak_concurrency(requests):
+    """Largest number of requests alive at the same time."""
+    timeline = sorted([(r.start, 1) for r in requests] + [(r.end, -1) for r in requests],
+                      key=lambda e: (e[0], e[1]))
+    alive = peak = 0
+    for _, delta in timeline:
+        alive += delta
+        peak = max(peak, alive)
+    return peak
+
+
+def propose(requests, header_size, max_pools, target):
+    """
+    Chooses up to max_pools block sizes among the requested sizes (rounded to 4
+    bytes) so that each size class, sized to its own peak demand, needs the least
+    RAM; then removes blocks while the replayed failure rate stays within target.
+    """
+    if not requests:
+        return []
+
+    candidates = sorted(set((r.size + 3) & ~3 for r in requests if r.size > 0))
+    by_size = sorted(requests, key=lambda r: r.size)
+    keys = [r.size for r in by_size]
+
+    def class_cost(lo, hi):
+        # Requests with candidates[lo - 1] < size <= candidates[hi]
+        first = bisect.bisect_right(keys, candidates[lo - 1]) if lo > 0 else 0
+        last = bisect.bisect_right(keys, candidates[hi])
+        blocks = peak_concurrency(by_size[first:last])
+        return (candidates[hi] + header_size) * blocks, blocks
+
+    n = len(candidates)
+    cost = {}
+    for lo in range(n):
+        for hi in range(lo, n):
+            cost[(lo, hi)] = class_cost(lo, hi)
+
+    # best[k][hi]: cheapest layout of k pools covering sizes up to candidates[hi]
+    inf = float('inf')
+    best = [[(inf, None)] * n for _ in range(max_pools + 1)]
+    for hi in range(n):
+        best[1][hi] = (cost[(0, hi)][0], None)
+    for k in range(2, max_pools + 1):
+        for hi in range(n):
+            for split in range(hi):
+                c = best[k - 1][split][0] + cost[(split + 1, hi)][0]
+                if c < best[k][hi][0]:
+                    best[k][hi] = (c, split)
+
+    k = min(range(1, max_pools + 1), key=lambda i: best[i][n - 1][0])
+    layout = []
+    hi = n - 1
+    while k >= 1:
+        split = best[k][hi][1]
+        lo = split + 1 if split is not None else 0
+        layout.append([candidates[hi], cost[(lo, hi)][1]])
+        if split is None:
+            break
+        hi = split
+        k -= 1
+    layout.reverse()
+
+    # Remove blocks, the largest saving first, while the target is met
+    while True:
+        best_trim = None
+        for i, (size, blocks) in enumerate(layout):
+            if blocks == 0:
+                continue
+            trial = [list(p) for p in layout]
+            trial[i][1] -= 1
+            if Replay(trial, requests).failure_rate() <= target:
+                if best_trim is None or size > layout[best_trim][0]:
+                    best_trim = i
+        if best_trim is None:
+            break
+        layout[best_trim][1] -= 1
+
+    return [(size, blocks) for size, blocks in layout if blocks > 0]
+
+
+def report(title, layout, requests, header_size):
+    replay = Replay(layout, requests)
+    print('%s: %d bytes, %d/%d allocations failed (%.2f%%)' %
+          (title, layout_ram(layout, header_size), replay.failures, replay.allocs,
+           100.0 * replay.failure_rate()))
+    print('    blockSize numBlocks peak poolFragmentWaste(peak) MinWaste MaxWaste')
+    for i, (size, blocks) in enumerate(replay.layout):
+        print('    %9d %9d %4d %24d %8s %8d' %
+              (size, blocks, replay.peak[i], replay.waste_peak[i],
+               '-' if replay.waste_min[i] is None else replay.waste_min[i],
+               replay.waste_max[i]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0].strip())
+    parser.add_argument('trace', nargs='?', type=argparse.FileType('r'), default=sys.stdin,
+                        help='saved "mem trace" output (default: stdin)')
+    parser.add_argument('--target', type=float, default=0.0,
+                        help='accepted allocation failure rate, 0 to 1 (default: 0)')
+    parser.add_argument('--pools', type=int, default=0,
+                        help='maximum number of pools per pool ID (default: as traced)')
+    parser.add_argument('--fail-pool-id', type=int, default=0,
+                        help='pool ID of the allocations that failed (default: 0)')
+    args = parser.parse_args()
+
+    trace = Trace()
+    trace.parse(args.trace)
+
+    if not trace.pools or not trace.events:
+        sys.exit('no trace found in input')
+    if trace.lost:
+        print('warning: %d events were lost; export the trace more often or '
+              'increase MEM_TRACE_SIZE\n' % trace.lost)
+
+    requests = build_requests(trace, args.fail_pool_id)
+
+    for pool_id in sorted(set(p[0] for p in trace.pools.values())):
+        current = [(p[1], p[2]) for p in trace.pools.values() if p[0] == pool_id]
+        subset = [r for r in requests if r.pool_id == pool_id]
+        max_pools = args.pools or len(current)
+
+        print('Pool ID %d, %d requests' % (pool_id, len(subset)))
+        if not subset:
+            print('')
+            continue
+        report('  Current', current, subset, trace.header_size)
+        proposed = propose(subset, trace.header_size, max_pools, args.target)
+        report('  Proposed', proposed, subset, trace.header_size)
+
+        print('\n    ' + ' \\\n    '.join(
+            '_block_size_ %3d  _number_of_blocks_ %4d %s_eol_' %
+            (size, blocks, '_pool_id_(%d) ' % pool_id if pool_id else '')
+            for size, blocks in proposed))
+        print('')
+
+
+if __name__ == '__main__':
+    main()
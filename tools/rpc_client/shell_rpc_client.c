@@ -0,0 +1,288 @@
+/*! *********************************************************************************
+* \file
+*
+* Host side of the shell RPC mode. The frame format is described in
+* shell_rpc_client.h.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include <string.h>
+#include "shell_rpc_client.h"
+#include "crc16.h"
+
+/************************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+************************************************************************************/
+static uint8_t * rpc_client_frame_data( uint8_t *pOut, uint32_t length );
+static uint32_t rpc_client_encode_frame( uint8_t seq, uint8_t id, uint32_t length, uint8_t *pOut );
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  Builds and encodes a request frame
+*
+* \param[in]  seq     sequence number, sent back in the frames of the answer
+* \param[in]  id      command ID
+* \param[in]  pData   pointer to the data
+* \param[in]  length  number of data bytes
+* \param[out] pOut    the encoded frame, RPC_CLIENT_REQUEST_MAX_SIZE(length) bytes
+*
+* \return  the number of bytes to send, delimiter included
+*
+********************************************************************************** */
+uint32_t rpc_client_encode_request(uint8_t seq, uint8_t id, const uint8_t *pData,
+                                   uint16_t length, uint8_t *pOut)
+{
+    if( length )
+    {
+        memmove(rpc_client_frame_data(pOut, length), pData, length);
+    }
+
+    return rpc_client_encode_frame(seq, id, length, pOut);
+}
+
+/*! *********************************************************************************
+* \brief  Builds and encodes the request of a registered command ID
+*
+* \param[in]  seq      sequence number
+* \param[in]  id       command ID
+* \param[in]  argc     number of arguments, after the sub-command
+* \param[in]  argv     the arguments
+* \param[out] pOut     the encoded frame
+* \param[in]  outSize  size of pOut
+*
+* \return  the number of bytes to send, 0 if the frame does not fit in pOut
+*
+********************************************************************************** */
+uint32_t rpc_client_encode_args(uint8_t seq, uint8_t id, uint8_t argc, const char * const argv[],
+                                uint8_t *pOut, uint32_t outSize)
+{
+    uint32_t length = 0;
+    uint32_t argLen;
+    uint8_t  *pData;
+    uint8_t  i;
+
+    for( i = 0; i < argc; i++ )
+    {
+        length += strlen(argv[i]) + 1;
+    }
+
+    if( (length > 0xFFFF) || (RPC_CLIENT_REQUEST_MAX_SIZE(length) > outSize) )
+    {
+        return 0;
+    }
+
+    pData = rpc_client_frame_data(pOut, length);
+    for( i = 0; i < argc; i++ )
+    {
+        argLen = strlen(argv[i]) + 1;
+        memcpy(pData, argv[i], argLen);
+        pData += argLen;
+    }
+
+    return rpc_client_encode_frame(seq, id, length, pOut);
+}
+
+/*! *********************************************************************************
+* \brief  Starts the decoding of the stream of the board
+*
+* \param[in]  pDecoder    the decoder
+* \param[in]  pfCallback  called for every frame
+* \param[in]  pParam      first parameter of the callback
+*
+********************************************************************************** */
+void rpc_client_decoder_init(rpcClientDecoder_t *pDecoder, pfRpcClientFrame_t pfCallback, void *pParam)
+{
+    pDecoder->pfCallback = pfCallback;
+    pDecoder->pParam = pParam;
+    pDecoder->synced = false;
+    pDecoder->overflow = false;
+    pDecoder->rxLen = 0;
+}
+
+/*! *********************************************************************************
+* \brief  Decodes received bytes
+*
+* \param[in]  pDecoder  the decoder
+* \param[in]  pInput    pointer to the bytes
+* \param[in]  length    number of bytes
+*
+* \remarks Consecutive delimiters are ignored. A frame that cannot be decoded is
+*          reported to the callback, and the decoding goes on with the next one.
+*
+********************************************************************************** */
+void rpc_client_decode(rpcClientDecoder_t *pDecoder, const uint8_t *pInput, uint32_t length)
+{
+    rpcClientFrame_t  frame;
+    rpcClientStatus_t status;
+    uint32_t          decoded;
+    uint8_t           byte;
+
+    while( length-- )
+    {
+        byte = *pInput++;
+
+        if( byte != COBS_DELIMITER )
+        {
+            if( pDecoder->rxLen < sizeof(pDecoder->rxBuf) )
+            {
+                pDecoder->rxBuf[pDecoder->rxLen++] = byte;
+            }
+            else
+            {
+                pDecoder->overflow = true;
+            }
+            continue;
+        }
+
+        if( pDecoder->synced && pDecoder->rxLen )
+        {
+            decoded = 0;
+            if( !pDecoder->overflow )
+            {
+                decoded = cobs_decode(pDecoder->rxBuf, pDecoder->rxLen, pDecoder->frame, sizeof(pDecoder->frame));
+            }
+
+            status = decoded ? rpc_client_parse_frame(pDecoder->frame, decoded, &frame) : rpcClientBadEncoding_c;
+            pDecoder->pfCallback(pDecoder->pParam, status, (status == rpcClientOk_c) ? &frame : NULL);
+        }
+
+        pDecoder->synced = true;
+        pDecoder->overflow = false;
+        pDecoder->rxLen = 0;
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Checks a decoded frame
+*
+* \param[in]  pFrame  the decoded frame
+* \param[in]  length  its size
+* \param[out] pOut    the fields of the frame, when it is valid
+*
+* \return  rpcClientOk_c if the frame is valid
+*
+********************************************************************************** */
+rpcClientStatus_t rpc_client_parse_frame(const uint8_t *pFrame, uint32_t length, rpcClientFrame_t *pOut)
+{
+    uint16_t dataLen;
+    uint16_t crc;
+
+    if( length < RPC_CLIENT_HEADER_SIZE + RPC_CLIENT_CRC_SIZE )
+    {
+        return rpcClientTruncated_c;
+    }
+
+    dataLen = (uint16_t)pFrame[3] | ((uint16_t)pFrame[4] << 8);
+    if( dataLen != length - RPC_CLIENT_HEADER_SIZE - RPC_CLIENT_CRC_SIZE )
+    {
+        return rpcClientBadLength_c;
+    }
+
+    crc = (uint16_t)pFrame[length - 2] | ((uint16_t)pFrame[length - 1] << 8);
+    if( crc != crc16_ccitt(pFrame, length - RPC_CLIENT_CRC_SIZE) )
+    {
+        return rpcClientBadCrc_c;
+    }
+
+    pOut->type = pFrame[0];
+    pOut->seq = pFrame[1];
+    pOut->id = pFrame[2];
+    pOut->pData = &pFrame[RPC_CLIENT_HEADER_SIZE];
+    pOut->length = dataLen;
+    pOut->hasStatus = false;
+    pOut->status = 0;
+
+    switch( pOut->type )
+    {
+    case RPC_CLIENT_RESPONSE:
+    case RPC_CLIENT_DONE:
+    case RPC_CLIENT_ERROR:
+        if( !dataLen )
+        {
+            return rpcClientBadType_c;
+        }
+        pOut->hasStatus = true;
+        pOut->status = (int8_t)pOut->pData[0];
+        pOut->pData++;
+        pOut->length--;
+        break;
+
+    case RPC_CLIENT_REQUEST:
+    case RPC_CLIENT_OUTPUT:
+    case RPC_CLIENT_EVENT:
+        break;
+
+    default:
+        return rpcClientBadType_c;
+    }
+
+    return rpcClientOk_c;
+}
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  Where the data of a frame is placed in the output buffer. The frame
+*         is built at the end of the buffer and encoded in place
+*
+* \param[in]  pOut    the output buffer
+* \param[in]  length  number of data bytes
+*
+* \return  pointer to the data of the frame
+*
+********************************************************************************** */
+static uint8_t * rpc_client_frame_data(uint8_t *pOut, uint32_t length)
+{
+    return &pOut[COBS_IN_PLACE_OFFSET(RPC_CLIENT_HEADER_SIZE + length + RPC_CLIENT_CRC_SIZE) + RPC_CLIENT_HEADER_SIZE];
+}
+
+/*! *********************************************************************************
+* \brief  Completes the request frame around its data, and encodes it
+*
+* \param[in]     seq     sequence number
+* \param[in]     id      command ID
+* \param[in]     length  number of data bytes, already in place
+* \param[in,out] pOut    the output buffer
+*
+* \return  the number of bytes to send, delimiter included
+*
+********************************************************************************** */
+static uint32_t rpc_client_encode_frame(uint8_t seq, uint8_t id, uint32_t length, uint8_t *pOut)
+{
+    uint32_t size = RPC_CLIENT_HEADER_SIZE + length + RPC_CLIENT_CRC_SIZE;
+    uint8_t  *pFrame = &pOut[COBS_IN_PLACE_OFFSET(size)];
+    uint32_t encoded;
+    uint16_t crc;
+
+    pFrame[0] = RPC_CLIENT_REQUEST;
+    pFrame[1] = seq;
+    pFrame[2] = id;
+    pFrame[3] = (uint8_t)length;
+    pFrame[4] = (uint8_t)(length >> 8);
+
+    crc = crc16_ccitt(pFrame, RPC_CLIENT_HEADER_SIZE + length);
+    pFrame[RPC_CLIENT_HEADER_SIZE + length] = (uint8_t)crc;
+    pFrame[RPC_CLIENT_HEADER_SIZE + length + 1] = (uint8_t)(crc >> 8);
+
+    encoded = cobs_encode(pFrame, size, pOut);
+    pOut[encoded++] = COBS_DELIMITER;
+
+    return encoded;
+}
@@ -0,0 +1,146 @@
+/*! *********************************************************************************
+* \file
+*
+* Host side of the shell RPC mode (framework/Shell/Source/shell_rpc.c), for the
+* programs that drive the board over its serial port. It builds the request
+* frames and splits the byte stream of the board into frames:
+*
+*   COBS( type | seq | id | len (2) | data (len) | crc (2) ) 0x00
+*
+* len and crc are little endian, crc is the CRC-16/CCITT-FALSE of the fields
+* before it. Link with framework/common/cobs.c and framework/common/crc16.c.
+* The constants below are the SHELL_RPC_xxx ones of shell.h, which the host
+* programs cannot include.
+*
+* SPDX-License-Identifier: BSD-3-Clause
+********************************************************************************** */
+
+#ifndef _SHELL_RPC_CLIENT_H_
+#define _SHELL_RPC_CLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cobs.h"
+
+/************************************************************************************
+*************************************************************************************
+* Public macros
+*************************************************************************************
+************************************************************************************/
+/* Sent in text mode, switches the interface to frames */
+#define RPC_CLIENT_ENTER_SEQUENCE   "\x1B" "R"
+
+/* Frame types */
+#define RPC_CLIENT_REQUEST          (0x01)
+#define RPC_CLIENT_RESPONSE         (0x02)
+#define RPC_CLIENT_OUTPUT           (0x03)
+#define RPC_CLIENT_EVENT            (0x04)
+#define RPC_CLIENT_DONE             (0x05)
+#define RPC_CLIENT_ERROR            (0x06)
+
+/* Reserved command IDs */
+#define RPC_CLIENT_ID_TEXT          (0x00)
+#define RPC_CLIENT_ID_PING          (0x01)
+#define RPC_CLIENT_ID_COMMAND_LINE  (0x02)
+#define RPC_CLIENT_ID_BREAK         (0x03)
+
+/* Statuses, besides the command_ret_t ones */
+#define RPC_CLIENT_STATUS_SUCCESS     (0)
+#define RPC_CLIENT_STATUS_UNKNOWN_ID  (-2)
+#define RPC_CLIENT_STATUS_BAD_ARGS    (-3)
+#define RPC_CLIENT_STATUS_BAD_FRAME   (-4)
+
+#define RPC_CLIENT_HEADER_SIZE      (5)
+#define RPC_CLIENT_CRC_SIZE         (2)
+
+/* Largest data accepted in a frame of the board, at least SHELL_RPC_MAX_DATA */
+#ifndef RPC_CLIENT_MAX_DATA
+#define RPC_CLIENT_MAX_DATA         (1024)
+#endif
+
+/* Size of the buffer that holds an encoded request of len data bytes, with
+   its delimiter */
+#define RPC_CLIENT_REQUEST_MAX_SIZE(len) \
+    (COBS_ENCODED_MAX_SIZE(RPC_CLIENT_HEADER_SIZE + (len) + RPC_CLIENT_CRC_SIZE) + 1u)
+
+#define RPC_CLIENT_MAX_FRAME        (RPC_CLIENT_HEADER_SIZE + RPC_CLIENT_MAX_DATA + RPC_CLIENT_CRC_SIZE)
+
+/************************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+************************************************************************************/
+/* Result of the decoding of a frame of the board */
+typedef enum rpcClientStatus_tag
+{
+    rpcClientOk_c,
+    rpcClientBadEncoding_c,     /* not a COBS frame, or larger than RPC_CLIENT_MAX_FRAME */
+    rpcClientTruncated_c,       /* shorter than a header and a CRC */
+    rpcClientBadLength_c,       /* len does not match the frame size */
+    rpcClientBadCrc_c,
+    rpcClientBadType_c          /* unknown type, or no status in a frame that has one */
+} rpcClientStatus_t;
+
+/* A frame of the board. The data are valid during the callback only */
+typedef struct rpcClientFrame_tag
+{
+    uint8_t         type;
+    uint8_t         seq;
+    uint8_t         id;
+    bool            hasStatus;  /* RESPONSE, DONE and ERROR frames */
+    int8_t          status;     /* command_ret_t or RPC_CLIENT_STATUS_xxx */
+    const uint8_t   *pData;     /* after the status */
+    uint16_t        length;
+} rpcClientFrame_t;
+
+/* Called for every frame of the board. pFrame is NULL unless status is
+   rpcClientOk_c */
+typedef void (*pfRpcClientFrame_t)(void *pParam, rpcClientStatus_t status, const rpcClientFrame_t *pFrame);
+
+/* Decoder state, one per serial port */
+typedef struct rpcClientDecoder_tag
+{
+    pfRpcClientFrame_t  pfCallback;
+    void                *pParam;
+    bool                synced;     /* a delimiter was received */
+    bool                overflow;
+    uint32_t            rxLen;
+    uint8_t             rxBuf[COBS_ENCODED_MAX_SIZE(RPC_CLIENT_MAX_FRAME)];
+    uint8_t             frame[RPC_CLIENT_MAX_FRAME];
+} rpcClientDecoder_t;
+
+/************************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+************************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Builds a request. pOut must hold RPC_CLIENT_REQUEST_MAX_SIZE(length) bytes.
+   Returns the number of bytes to send, delimiter included */
+uint32_t rpc_client_encode_request(uint8_t seq, uint8_t id, const uint8_t *pData,
+                                   uint16_t length, uint8_t *pOut);
+
+/* Builds the request of a registered command ID: the arguments are sent each
+   terminated by '\0', so they may hold spaces. Returns the number of bytes to
+   send, or 0 if they do not fit in outSize */
+uint32_t rpc_client_encode_args(uint8_t seq, uint8_t id, uint8_t argc, const char * const argv[],
+                                uint8_t *pOut, uint32_t outSize);
+
+/* Starts the decoding of the stream of the board. Bytes up to the first
+   delimiter are text written before the switch to frames, and are dropped */
+void rpc_client_decoder_init(rpcClientDecoder_t *pDecoder, pfRpcClientFrame_t pfCallback, void *pParam);
+
+/* Decodes received bytes, calling the callback of the decoder for every frame */
+void rpc_client_decode(rpcClientDecoder_t *pDecoder, const uint8_t *pInput, uint32_t length);
+
+/* Checks a decoded frame, and fills pFrame when it is valid */
+rpcClientStatus_t rpc_client_parse_frame(const uint8_t *pFrame, uint32_t length, rpcClientFrame_t *pOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_RPC_CLIENT_H_ */